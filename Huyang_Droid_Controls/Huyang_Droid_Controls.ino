@@ -28,6 +28,9 @@ WebServer *webserver = new WebServer(WebServerPort);
 // Arduino_GFX *leftEye = new Arduino_GC9A01(leftBus, LEFT_EYE_RST_PIN, -1, true); // -1 for no backlight pin, true for rotation
 // Arduino_DataBus *rightBus = new Arduino_ESP8266SPI(RIGHT_EYE_DC_PIN, RIGHT_EYE_CS_PIN, -1, -1, -1);
 // Arduino_GFX *rightEye = new Arduino_GC9A01(rightBus, RIGHT_EYE_RST_PIN, -1, true);
+// On ESP32 give each eye its own DMA bus on its own SPI host, so both eyes are streamed at the same time:
+// Arduino_DataBus *leftBus = new Arduino_ESP32SPIDMA(LEFT_EYE_DC_PIN, LEFT_EYE_CS_PIN, LEFT_EYE_SCK_PIN, LEFT_EYE_MOSI_PIN, GFX_NOT_DEFINED, HSPI);
+// Arduino_DataBus *rightBus = new Arduino_ESP32SPIDMA(RIGHT_EYE_DC_PIN, RIGHT_EYE_CS_PIN, RIGHT_EYE_SCK_PIN, RIGHT_EYE_MOSI_PIN, GFX_NOT_DEFINED, VSPI);
 
 // For now, keeping them as nullptr to allow compilation, but functionality will be missing.
 Arduino_GFX *leftEye = nullptr;
@@ -36,11 +39,18 @@ Arduino_GFX *rightEye = nullptr;
 // PWM Servo Driver (PCA9685) instance
 Adafruit_PWMServoDriver *pwm = new Adafruit_PWMServoDriver(0x40); // Default I2C address for PCA9685
 
+// The subsystems only see the driver interfaces of src/submodules/Hal
+PixelDisplay *leftEyeDisplay = leftEye ? new GfxDisplay(leftEye) : nullptr;
+PixelDisplay *rightEyeDisplay = rightEye ? new GfxDisplay(rightEye) : nullptr;
+PwmOutput *pwmOutput = new Pca9685Output(pwm, 0x40);
+LedStrip *chestLights = new NeoPixelStrip(NEO_PIXEL_COUNT, NEO_PIXEL_PIN, pixelFormat);
+ServoFrame *servoFrame = new ServoFrame(pwmOutput); // Servo values of one loop() pass, written in I2C bursts
+
 // Huyang Robot Subsystem Instances
-// HuyangFace only expects two Arduino_GFX pointers.
-HuyangFace *huyangFace = new HuyangFace(leftEye, rightEye);
-HuyangBody *huyangBody = new HuyangBody(pwm);
-HuyangNeck *huyangNeck = new HuyangNeck(pwm);
+// HuyangFace only expects two eye displays.
+HuyangFace *huyangFace = new HuyangFace(leftEyeDisplay, rightEyeDisplay);
+HuyangBody *huyangBody = new HuyangBody(pwmOutput, servoFrame, chestLights);
+HuyangNeck *huyangNeck = new HuyangNeck(pwmOutput, servoFrame);
 HuyangAudio *huyangAudio = new HuyangAudio(); // Assuming HuyangAudio exists and is extern
 
 // --- GLOBAL FEATURE ENABLE FLAGS (DEFINED HERE) ---
@@ -58,6 +68,56 @@ bool enableTorsoLights = true;     // the ws2812b led inside of the torso
 // Global currentMillis variable (from system.h, now defined here)
 unsigned long currentMillis = 0;
 
+// Cooperative scheduler running the subsystems at their own rates (see setup())
+Scheduler *scheduler = new Scheduler();
+
+// Duration statistics of loop() and the subsystem loops, served as /api/metrics
+LoopMetrics *loopMetrics = new LoopMetrics();
+
+// Task periods and deadlines in microseconds
+#define TASK_SERVO_PERIOD 10000      // 100 Hz
+#define TASK_SERVO_DEADLINE 5000
+#define TASK_FACE_PERIOD 33333       // 30 Hz
+#define TASK_LIGHTS_PERIOD 16667     // 60 Hz
+#define TASK_WIFI_PERIOD 500000      // 2 Hz
+#define TASK_STATS_PERIOD 10000000   // Serial dump of the task and loop statistics every 10 s
+
+#if defined(ESP32)
+// ESP32: servos and face leave the Arduino loop and run as FreeRTOS tasks.
+// Motion gets the highest priority on core 1 (the loop task keeps lights, Wi-Fi and stats there),
+// the face is composed on core 0 next to the eye transfer tasks and the network.
+#define TASK_MOTION_CORE 1
+#define TASK_MOTION_PRIORITY 5
+#define TASK_FACE_CORE 0
+#define TASK_FACE_PRIORITY 1         // Below the eye transfer tasks, which only wait for the SPI bus
+#endif
+
+
+// --- SCHEDULER TASKS ---
+
+// Wi-Fi Manager: keep the connection alive and print the IP address
+void wifiTask()
+{
+    uint32_t start = LoopMetrics::now();
+    wifi->loop();
+    webserver->loop(); // WebSocket housekeeping
+    loopMetrics->record(METRICS_WIFI, start);
+}
+
+// faceTask(), servoTask() and lightsTask() are in src/submodules/Tasks, shared with host/replay
+
+// Lets the servo task run between two display bands while the face pushes a frame
+void yieldToUrgentTasks()
+{
+    scheduler->yield();
+}
+
+// Runtime, lateness and overruns of all tasks, and the loop section timings on the serial monitor
+void statsTask()
+{
+    scheduler->printStats(Serial);
+    loopMetrics->print(Serial);
+}
 
 // --- MAIN ARDUINO SETUP FUNCTION ---
 void setup()
@@ -94,81 +154,33 @@ void setup()
     if (huyangBody) huyangBody->setup();
     if (huyangNeck) huyangNeck->setup();
     if (huyangAudio) huyangAudio->setup(); // Setup audio if enabled
+    servoFrame->flush(); // Write the initial servo positions
+
+    // Register the subsystems with the scheduler. The servo task has the shortest deadline,
+    // so it runs first whenever it is due together with the face.
+#if defined(ESP32)
+    scheduler->addRealtimeTask("servos", servoTask, TASK_SERVO_PERIOD, TASK_SERVO_DEADLINE, TASK_MOTION_CORE, TASK_MOTION_PRIORITY);
+    scheduler->addRealtimeTask("face", faceTask, TASK_FACE_PERIOD, 0, TASK_FACE_CORE, TASK_FACE_PRIORITY);
+#else
+    scheduler->addTask("servos", servoTask, TASK_SERVO_PERIOD, TASK_SERVO_DEADLINE);
+    scheduler->addTask("face", faceTask, TASK_FACE_PERIOD);
+    EyePipeline::bandCallback = yieldToUrgentTasks; // Single core: let the servos run between display bands
+#endif
+    scheduler->addTask("lights", lightsTask, TASK_LIGHTS_PERIOD);
+    scheduler->addTask("wifi", wifiTask, TASK_WIFI_PERIOD);
+    scheduler->addTask("stats", statsTask, TASK_STATS_PERIOD);
 }
 
 // --- MAIN ARDUINO LOOP FUNCTION ---
 void loop()
 {
-    // Update global currentMillis for all time-based operations
-    currentMillis = millis();
-
-    // --- Wi-Fi Manager Loop ---
-    wifi->loop(); // Keep Wi-Fi connection alive and print IP address
-
-    // --- Control Face (Eyes) ---
-    // The HuyangFace class handles its own loop and state transitions based on faceLeftEyeState/faceRightEyeState
-    // and automaticAnimations.
-    if (enableEyes)
-    {
-        // If automatic animations are off, manually set eye states from global variables
-        if (automaticAnimations == false)
-        {
-            if (allEyes != 0) { // If an "all eyes" command is active
-                huyangFace->setEyesTo(huyangFace->getStateFrom(allEyes));
-                allEyes = 0; // Reset after setting to prevent continuous re-setting
-            } else { // Otherwise, apply individual eye states
-                huyangFace->setLeftEyeTo(huyangFace->getStateFrom(faceLeftEyeState));
-                huyangFace->setRightEyeTo(huyangFace->getStateFrom(faceRightEyeState));
-            }
-        }
-        huyangFace->loop(); // Run the eye animation loop
-    }
-
-    // --- Control Monocle ---
-    if (enableMonacle && automaticAnimations == false)
-    {
-        // The monocle position is directly set via monoclePosition global variable
-        // and handled by HuyangNeck (assuming setMonoclePosition exists and is public)
-        huyangNeck->setMonoclePosition(monoclePosition + calMonoclePosition); // Apply calibration
-    }
-
-    // --- Control Neck ---
-    // The HuyangNeck class handles its own loop and state transitions.
-    // If automatic animations are off, manual control values are passed.
-    huyangNeck->automatic = automaticAnimations; // Pass automatic flag to neck
-    if (automaticAnimations == false) // If manual control
-    {
-        // Apply calibration to the manual control values
-        double calibratedNeckRotate = neckRotate + calNeckRotation;
-        double calibratedNeckTiltForward = neckTiltForward + calNeckTiltForward;
-        double calibratedNeckTiltSideways = neckTiltSideways + calNeckTiltSideways;
-
-        huyangNeck->rotateHead(calibratedNeckRotate);
-        huyangNeck->tiltNeckForward(calibratedNeckTiltForward);
-        huyangNeck->tiltNeckSideways(calibratedNeckTiltSideways);
-    }
-    huyangNeck->loop(); // Run the neck control loop
-
-    // --- Control Body ---
-    // The HuyangBody class handles its own loop and state transitions.
-    // If automatic animations are off, manual control values are passed.
-    huyangBody->automatic = automaticAnimations;
-
-    if (automaticAnimations == false) // If manual control
-    {
-        // Apply calibration to the manual control values
-        int16_t calibratedBodyRotate = bodyRotate + calBodyRotation;
-        int16_t calibratedBodyTiltForward = bodyTiltForward + calBodyTiltForward;
-        int16_t calibratedBodyTiltSideways = bodyTiltSideways + calBodyTiltSideways;
-
-        huyangBody->rotateBody(calibratedBodyRotate);
-        huyangBody->tiltBodyForward(calibratedBodyTiltForward);
-        huyangBody->tiltBodySideways(calibratedBodyTiltSideways);
-    }
-    // Update chest light mode based on global variable
-    huyangBody->currentLightMode = (LightMode)chestLightMode;
-
-    huyangBody->loop(); // Run the body control loop
+    loopMetrics->lap(METRICS_LOOP); // Time between two passes, the core's Wi-Fi work included
+
+    // Every pass runs the most urgent due task and returns to the core (Wi-Fi stack) in between
+    scheduler->run();
+
+    // Log messages of the tasks, only as much as the serial transmit buffer takes without waiting
+    Log::drain(Serial, Serial.availableForWrite());
 
     // huyangAudio->loop(); // Audio loop (currently commented out in original, uncomment if needed)
 }
@@ -29,6 +29,11 @@
         // Webserver Port default is 80. If you want a different Port, change it
         #define WebServerPort 80
 
+        // Messages on the Serial Monitor: LOG_LEVEL_NONE, LOG_LEVEL_ERROR, LOG_LEVEL_WARN, LOG_LEVEL_INFO or LOG_LEVEL_DEBUG
+        // Messages below the level are left out of the firmware. LOG_LEVEL_DEBUG shows every servo and eye command,
+        // which slows the robot down.
+        #define LOG_LEVEL LOG_LEVEL_INFO
+
         // System Option
         // Here you can enable/disable some sub-sections of the software to match your build
         // To disable an option, change: true; to false;
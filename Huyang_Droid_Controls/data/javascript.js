@@ -74,6 +74,74 @@ async function sendData(endpoint, data) {
     }
 }
 
+// --- Latest-wins HTTP sending for live controls ---
+// Without the WebSocket every joystick move would be its own request. Only one request per control
+// is in flight at a time, moves made meanwhile replace each other and only the last one is sent.
+var pendingControlData = {}; // control -> data waiting for the request in flight
+var controlInFlight = {};    // control -> true while a request is running
+
+async function sendLatest(control, endpoint, data) {
+    if (controlInFlight[control]) {
+        pendingControlData[control] = data;
+        return;
+    }
+    controlInFlight[control] = true;
+    await sendData(endpoint, data);
+    controlInFlight[control] = false;
+
+    const pending = pendingControlData[control];
+    if (pending) {
+        delete pendingControlData[control];
+        sendLatest(control, endpoint, pending);
+    }
+}
+
+// --- WebSocket control channel ---
+// Joystick and monocle moves are streamed over one held connection instead of one HTTP request each.
+// Binary frame, little endian: uint16 sequence, uint8 first axis, uint8 axis count, int16 value per axis.
+// Axis ids match MotionAxis in MotionCommands.h.
+const AXIS_NECK_ROTATE = 0;
+const AXIS_BODY_ROTATE = 3;
+const AXIS_MONOCLE = 6;
+
+var controlSocket = null;
+var controlSequence = 0;
+
+function openControlSocket() {
+    if (!('WebSocket' in window) || controlSocket) return;
+    const socket = new WebSocket(`ws://${window.location.host}/ws`);
+    socket.binaryType = 'arraybuffer';
+    socket.onopen = function() {
+        console.log("openControlSocket: Connected.");
+        controlSocket = socket;
+    };
+    socket.onclose = function() {
+        console.log("openControlSocket: Closed, falling back to HTTP and retrying.");
+        controlSocket = null;
+        setTimeout(openControlSocket, 2000);
+    };
+    socket.onerror = function() {
+        socket.close();
+    };
+}
+
+// Sends values for consecutive axes starting at firstAxis.
+// Returns false if the socket is not connected, the caller then uses /api/action.
+function sendAxes(firstAxis, values) {
+    if (!controlSocket || controlSocket.readyState !== WebSocket.OPEN) return false;
+
+    const frame = new DataView(new ArrayBuffer(4 + values.length * 2));
+    controlSequence = (controlSequence % 0xFFFF) + 1; // 1..65535, the robot drops frames older than the last one
+    frame.setUint16(0, controlSequence, true);
+    frame.setUint8(2, firstAxis);
+    frame.setUint8(3, values.length);
+    values.forEach(function(value, i) {
+        frame.setInt16(4 + i * 2, Math.round(value), true);
+    });
+    controlSocket.send(frame.buffer);
+    return true;
+}
+
 // --- Fetch initial data from server and update UI ---
 async function getServerData() {
     console.log("getServerData: Fetching initial server data.");
@@ -195,8 +263,10 @@ function sendNeckUpdate() {
     neck_tiltForward = JoyNeckY; // Assuming Y controls forward/backward tilt
     // If you have a separate control for sideways tilt, update neck_tiltSideways here too.
 
+    if (sendAxes(AXIS_NECK_ROTATE, [neck_rotate, neck_tiltForward, neck_tiltSideways])) return;
+
     // Corrected endpoint from /api/post.json to /api/action
-    sendData('/api/action', {
+    sendLatest('neck', '/api/action', {
         type: 'neck',
         rotate: neck_rotate,
         tiltForward: neck_tiltForward,
@@ -211,8 +281,10 @@ function sendBodyUpdate() {
     body_tiltForward = JoyBodyY; // Assuming Y controls body forward/backward tilt
     // If you have a separate control for sideways tilt, update body_tiltSideways here too.
 
+    if (sendAxes(AXIS_BODY_ROTATE, [body_rotate, body_tiltForward, body_tiltSideways])) return;
+
     // Corrected endpoint from /api/post.json to /api/action
-    sendData('/api/action', {
+    sendLatest('body', '/api/action', {
         type: 'body',
         rotate: body_rotate,
         tiltForward: body_tiltForward,
@@ -225,8 +297,9 @@ function sendMonocleUpdate() {
     if (monocleSlider) {
         monoclePosition = parseInt(monocleSlider.value);
         console.log("sendMonocleUpdate: Monocle position:", monoclePosition);
+        if (sendAxes(AXIS_MONOCLE, [monoclePosition])) return;
         // Corrected endpoint from /api/post.json to /api/action
-        sendData('/api/action', { type: 'monocle', position: monoclePosition });
+        sendLatest('monocle', '/api/action', { type: 'monocle', position: monoclePosition });
     }
 }
 
@@ -563,6 +636,10 @@ function initJoystick() {
 function systemInit() {
     getServerData(); // Fetch initial data from server
     initJoystick(); // Initialize joysticks
+    // Pages with live controls stream them over the WebSocket
+    if (JoyNeck || JoyBody) {
+        openControlSocket();
+    }
     // Other initializations can go here
 }
 
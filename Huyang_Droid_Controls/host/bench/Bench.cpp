@@ -0,0 +1,306 @@
+#include "Bench.h"
+#include <Arduino.h>
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// --- Allocation counting ---
+
+static uint64_t _allocations = 0;
+
+void *operator new(size_t size)
+{
+    _allocations++;
+    void *memory = malloc(size ? size : 1);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    _allocations++;
+    return malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void *memory) noexcept { free(memory); }
+void operator delete[](void *memory) noexcept { free(memory); }
+void operator delete(void *memory, size_t) noexcept { free(memory); }
+void operator delete[](void *memory, size_t) noexcept { free(memory); }
+
+uint64_t benchAllocations()
+{
+    return _allocations;
+}
+
+// --- Simulated time ---
+
+SimulatedClock benchClock;
+
+// --- BenchState ---
+
+static uint64_t nowNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void BenchState::start()
+{
+    _running = true;
+    _startSerialBytes = Serial.bytesWritten;
+    _startAllocations = _allocations;
+    _startNanoseconds = nowNanoseconds();
+}
+
+void BenchState::stop()
+{
+    uint64_t end = nowNanoseconds();
+    if (!_running) return;
+    _running = false;
+    nanoseconds = end - _startNanoseconds;
+    allocations = _allocations - _startAllocations;
+    serialBytes = Serial.bytesWritten - _startSerialBytes;
+}
+
+void BenchState::fail(const char *reason)
+{
+    stop();
+    if (!failure) failure = reason;
+}
+
+// --- Registry ---
+
+std::vector<Benchmark> &BenchRegistry::all()
+{
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+BenchRegistry::BenchRegistry(const char *name, BenchFunction function, uint32_t iterations)
+{
+    all().push_back({name, function, iterations});
+}
+
+// --- Runner ---
+
+static BenchResult run(const Benchmark &benchmark, bool &deterministic, const char *&failure)
+{
+    BenchResult result = {};
+    strncpy(result.name, benchmark.name, sizeof(result.name) - 1);
+    result.iterations = benchmark.iterations;
+    deterministic = true;
+    failure = nullptr;
+
+    uint64_t times[Bench_REPETITIONS];
+    for (uint8_t repetition = 0; repetition < Bench_REPETITIONS; repetition++)
+    {
+        // Every run starts from the same simulated time and random sequence
+        benchClock.set(0);
+        halRandomSeed(1);
+
+        BenchState state;
+        state.iterations = benchmark.iterations;
+        benchmark.function(state);
+        times[repetition] = state.nanoseconds;
+        if (state.failure)
+        {
+            failure = state.failure;
+            return result;
+        }
+
+        double allocations = (double)state.allocations / state.iterations;
+        double busBytes = (double)state.busBytes / state.iterations;
+        double serialBytes = (double)state.serialBytes / state.iterations;
+        if (repetition > 0 && (allocations != result.allocationsPerOp || busBytes != result.busBytesPerOp || serialBytes != result.serialBytesPerOp))
+        {
+            deterministic = false;
+        }
+        result.allocationsPerOp = allocations;
+        result.busBytesPerOp = busBytes;
+        result.serialBytesPerOp = serialBytes;
+    }
+
+    // The fastest run is the one least disturbed by the rest of the machine
+    result.nanosecondsPerOp = (double)*std::min_element(times, times + Bench_REPETITIONS) / benchmark.iterations;
+    return result;
+}
+
+static void printHeader(FILE *out)
+{
+    fprintf(out, "# %-30s %10s %12s %10s %10s %10s\n", "benchmark", "iterations", "ns/op", "allocs/op", "bus B/op", "serial B/op");
+}
+
+static void printResult(FILE *out, const BenchResult &result)
+{
+    fprintf(out, "  %-30s %10u %12.1f %10.3f %10.3f %10.3f", result.name, result.iterations, result.nanosecondsPerOp,
+            result.allocationsPerOp, result.busBytesPerOp, result.serialBytesPerOp);
+}
+
+static std::vector<BenchResult> readBaseline(const char *path)
+{
+    std::vector<BenchResult> results;
+    FILE *file = fopen(path, "r");
+    if (!file)
+    {
+        fprintf(stderr, "Cannot read the baseline %s\n", path);
+        exit(2);
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), file))
+    {
+        BenchResult result = {};
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%47s %u %lf %lf %lf %lf", result.name, &result.iterations, &result.nanosecondsPerOp,
+                   &result.allocationsPerOp, &result.busBytesPerOp, &result.serialBytesPerOp) == 6)
+        {
+            results.push_back(result);
+        }
+    }
+    fclose(file);
+    return results;
+}
+
+// Compares a result with its baseline entry and prints what got worse. Allocations and bus bytes
+// are deterministic and may not grow at all, the time may grow by tolerance percent.
+static bool compare(const BenchResult &result, const BenchResult *baseline, double tolerance)
+{
+    if (!baseline)
+    {
+        printf("  (new)\n");
+        return true;
+    }
+    const double epsilon = 0.0005; // Rounding of the baseline file
+    bool ok = true;
+    if (result.allocationsPerOp > baseline->allocationsPerOp + epsilon)
+    {
+        printf("  allocs %.3f -> %.3f", baseline->allocationsPerOp, result.allocationsPerOp);
+        ok = false;
+    }
+    if (result.busBytesPerOp > baseline->busBytesPerOp + epsilon)
+    {
+        printf("  bus %.3f -> %.3f", baseline->busBytesPerOp, result.busBytesPerOp);
+        ok = false;
+    }
+    if (result.serialBytesPerOp > baseline->serialBytesPerOp + epsilon)
+    {
+        printf("  serial %.3f -> %.3f", baseline->serialBytesPerOp, result.serialBytesPerOp);
+        ok = false;
+    }
+    double change = baseline->nanosecondsPerOp > 0 ? (result.nanosecondsPerOp / baseline->nanosecondsPerOp - 1) * 100 : 0;
+    if (change > tolerance)
+    {
+        printf("  time +%.0f%%", change);
+        ok = false;
+    }
+    else
+    {
+        printf("  %+.0f%%", change);
+    }
+    printf(ok ? "\n" : "  REGRESSION\n");
+    return ok;
+}
+
+static void usage(const char *program)
+{
+    printf("Usage: %s [--filter text] [--baseline file [--tolerance percent]] [--write file]\n", program);
+    printf("  --filter     only runs benchmarks whose name contains text\n");
+    printf("  --baseline   compares with a file written by --write, exits with 1 on a regression\n");
+    printf("  --tolerance  percent a benchmark may be slower than the baseline (default %d)\n", Bench_DEFAULT_TOLERANCE);
+    printf("  --write      writes the results as a new baseline\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *filter = nullptr;
+    const char *baselinePath = nullptr;
+    const char *writePath = nullptr;
+    double tolerance = Bench_DEFAULT_TOLERANCE;
+    halUseClock(&benchClock);
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) baselinePath = argv[++i];
+        else if (strcmp(argv[i], "--write") == 0 && i + 1 < argc) writePath = argv[++i];
+        else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) tolerance = atof(argv[++i]);
+        else
+        {
+            usage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 2;
+        }
+    }
+
+    std::vector<BenchResult> baseline;
+    if (baselinePath) baseline = readBaseline(baselinePath);
+
+    std::vector<BenchResult> results;
+    bool ok = true;
+    printHeader(stdout);
+    for (const Benchmark &benchmark : BenchRegistry::all())
+    {
+        if (filter && !strstr(benchmark.name, filter)) continue;
+
+        bool deterministic;
+        const char *failure;
+        BenchResult result = run(benchmark, deterministic, failure);
+        if (failure)
+        {
+            printf("  %-30s FAILED: %s\n", benchmark.name, failure);
+            ok = false;
+            continue;
+        }
+        results.push_back(result);
+        printResult(stdout, result);
+
+        if (!deterministic)
+        {
+            printf("  NOT DETERMINISTIC");
+            ok = false;
+        }
+        if (baselinePath)
+        {
+            const BenchResult *entry = nullptr;
+            for (const BenchResult &candidate : baseline)
+                if (strcmp(candidate.name, result.name) == 0) entry = &candidate;
+            ok = compare(result, entry, tolerance) && ok;
+        }
+        else
+        {
+            printf("\n");
+        }
+        fflush(stdout);
+    }
+
+    if (writePath)
+    {
+        FILE *file = fopen(writePath, "w");
+        if (!file)
+        {
+            fprintf(stderr, "Cannot write %s\n", writePath);
+            return 2;
+        }
+        fprintf(file, "# Baseline of host/bench, written by \"make baseline\". Times depend on the machine,\n");
+        fprintf(file, "# allocations and bus / serial bytes per operation do not.\n");
+        printHeader(file);
+        for (const BenchResult &result : results)
+        {
+            printResult(file, result);
+            fprintf(file, "\n");
+        }
+        fclose(file);
+        printf("Baseline written to %s\n", writePath);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+#ifndef Bench_h
+#define Bench_h
+
+// Small benchmark runner for the host builds.
+//
+// A benchmark sets up its objects, then runs state.iterations operations between state.start()
+// and state.stop(). Besides the time it reports the heap allocations made while timing, and the
+// bytes the operations put on the I2C / SPI / LED buses and the serial port, as counted by the
+// recording HAL implementations. Those counts are deterministic: the clock is simulated
+// (benchClock, advanced by the benchmarks) and random() is seeded the same way before every run.
+//
+//   BENCH(servo_single, 10000)
+//   {
+//       ... setup ...
+//       state.start();
+//       for (uint32_t i = 0; i < state.iterations; i++) { ... }
+//       state.stop();
+//       state.busBytes = pwm.busBytes;
+//   }
+
+#include <stdint.h>
+#include <vector>
+#include "../../src/submodules/Hal/HalClock.h"
+
+#define Bench_REPETITIONS 5         // Runs per benchmark, the fastest is reported
+#define Bench_DEFAULT_TOLERANCE 50  // Percent a benchmark may be slower than the baseline
+
+class BenchState
+{
+public:
+    uint32_t iterations = 0;
+
+    void start();
+    void stop();
+
+    // Marks the run as broken, e.g. when a request was not answered as expected
+    void fail(const char *reason);
+
+    // Totals over all iterations, set by the benchmark. Divided by the iterations for the report.
+    uint64_t busBytes = 0;
+
+    // Filled in by start() / stop()
+    uint64_t nanoseconds = 0;
+    uint64_t allocations = 0;
+    uint64_t serialBytes = 0;
+    const char *failure = nullptr;
+
+private:
+    uint64_t _startNanoseconds = 0;
+    uint64_t _startAllocations = 0;
+    uint64_t _startSerialBytes = 0;
+    bool _running = false;
+};
+
+typedef void (*BenchFunction)(BenchState &state);
+
+struct Benchmark {
+    const char *name;
+    BenchFunction function;
+    uint32_t iterations;
+};
+
+// Result line of a benchmark, also the format of the baseline file
+struct BenchResult {
+    char name[48];
+    uint32_t iterations;
+    double nanosecondsPerOp;
+    double allocationsPerOp;
+    double busBytesPerOp;
+    double serialBytesPerOp;
+};
+
+class BenchRegistry
+{
+public:
+    static std::vector<Benchmark> &all();
+    BenchRegistry(const char *name, BenchFunction function, uint32_t iterations);
+};
+
+// Time of the subsystems while benchmarking, set to 0 before every run
+extern SimulatedClock benchClock;
+
+// Heap allocations since the start of the program, counted by the replaced operator new
+uint64_t benchAllocations();
+
+#define BENCH(name, iterations)                                                          \
+    static void bench_##name(BenchState &state);                                         \
+    static BenchRegistry bench_registry_##name(#name, bench_##name, iterations);         \
+    static void bench_##name(BenchState &state)
+
+#endif
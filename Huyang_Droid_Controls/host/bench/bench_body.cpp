@@ -0,0 +1,75 @@
+#include "Bench.h"
+#include <Arduino.h>
+#include "../../src/submodules/Hal/PwmOutput.h"
+#include "../../src/submodules/Hal/LedStrip.h"
+#include "../../src/classes/ServoFrame/ServoFrame.h"
+#include "../../src/classes/HuyangBody/HuyangBody.h"
+
+#define BenchBody_LIGHTS_MICROS 16667 // Period of the lights task in the sketch (TASK_LIGHTS_PERIOD)
+#define BenchBody_SERVO_MICROS 10000  // Period of the servo task in the sketch (TASK_SERVO_PERIOD)
+
+struct BenchBody {
+    RecordingPwmOutput pwm;
+    RecordingLedStrip lights;
+    ServoFrame frame;
+    HuyangBody body;
+
+    BenchBody() : lights(NEO_PIXEL_COUNT), frame(&pwm), body(&pwm, &frame, &lights)
+    {
+        pwm.recording = false;
+        lights.recording = false;
+        body.setup();
+    }
+};
+
+// One lights task run in a static mode
+BENCH(body_chest_lights, 2000000)
+{
+    BenchBody bench;
+    bench.body.currentLightMode = LIGHT_STATIC_BLUE;
+    uint32_t busBytes = bench.lights.busBytes;
+
+    state.start();
+    for (uint32_t i = 0; i < state.iterations; i++)
+    {
+        bench.body.updateChestLights();
+        benchClock.advance(BenchBody_LIGHTS_MICROS);
+    }
+    state.stop();
+    state.busBytes = bench.lights.busBytes - busBytes;
+}
+
+// One lights task run while the warning lights blink red and blue
+BENCH(body_chest_lights_blink, 2000000)
+{
+    BenchBody bench;
+    bench.body.currentLightMode = LIGHT_WARNING_BLINK;
+    uint32_t busBytes = bench.lights.busBytes;
+
+    state.start();
+    for (uint32_t i = 0; i < state.iterations; i++)
+    {
+        bench.body.updateChestLights();
+        benchClock.advance(BenchBody_LIGHTS_MICROS);
+    }
+    state.stop();
+    state.busBytes = bench.lights.busBytes - busBytes;
+}
+
+// Body servos in automatic mode, an operation is one servo task run including the flush
+BENCH(body_loop_automatic, 500000)
+{
+    BenchBody bench;
+    bench.body.automatic = true;
+    uint32_t busBytes = bench.pwm.busBytes;
+
+    state.start();
+    for (uint32_t i = 0; i < state.iterations; i++)
+    {
+        bench.body.loop();
+        bench.frame.flush();
+        benchClock.advance(BenchBody_SERVO_MICROS);
+    }
+    state.stop();
+    state.busBytes = bench.pwm.busBytes - busBytes;
+}
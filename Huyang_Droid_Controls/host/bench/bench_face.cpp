@@ -0,0 +1,76 @@
+#include "Bench.h"
+#include <Arduino.h>
+#include "../../src/submodules/Hal/PixelDisplay.h"
+#include "../../src/classes/HuyangFace/HuyangFace.h"
+
+#define BenchFace_TICK_MICROS 33333 // Period of the face task in the sketch (TASK_FACE_PERIOD)
+#define BenchFace_TRANSITION_TICKS 15 // Face task runs covering one HuyangFace_MOOD_MILLIS transition
+
+// Two 240x240 eyes on recording displays, set up and settled before timing starts
+struct BenchFace {
+    RecordingPixelDisplay left;
+    RecordingPixelDisplay right;
+    HuyangFace face;
+
+    BenchFace() : face(&left, &right)
+    {
+        left.recording = false;
+        right.recording = false;
+        face.setup();
+        face.setAutomatic(false);
+        face.setEyesTo(EYE_STATE_OPEN);
+        for (uint8_t i = 0; i < BenchFace_TRANSITION_TICKS; i++) tick();
+    }
+
+    void tick()
+    {
+        face.loop();
+        benchClock.advance(BenchFace_TICK_MICROS);
+    }
+
+    // SPI bytes of the pixels pushed so far, RGB565
+    uint64_t busBytes() { return 2 * (left.pixelsWritten + right.pixelsWritten); }
+};
+
+// Face task runs while nothing changes, the common case
+BENCH(face_idle, 500000)
+{
+    BenchFace bench;
+    uint64_t busBytes = bench.busBytes();
+
+    state.start();
+    for (uint32_t i = 0; i < state.iterations; i++) bench.tick();
+    state.stop();
+    state.busBytes = bench.busBytes() - busBytes;
+}
+
+// Both eyes going through a complete mood transition, redrawing most of both displays.
+// An operation is the whole transition.
+BENCH(face_redraw, 100)
+{
+    static const EyeState moods[] = {EYE_STATE_ANGRY, EYE_STATE_SAD, EYE_STATE_CLOSED, EYE_STATE_FOCUS, EYE_STATE_OPEN};
+    BenchFace bench;
+    uint64_t busBytes = bench.busBytes();
+
+    state.start();
+    for (uint32_t i = 0; i < state.iterations; i++)
+    {
+        bench.face.setEyesTo(moods[i % 5]);
+        for (uint8_t tick = 0; tick < BenchFace_TRANSITION_TICKS; tick++) bench.tick();
+    }
+    state.stop();
+    state.busBytes = bench.busBytes() - busBytes;
+}
+
+// Automatic mode: random moods every 5-10 s and blinks, an operation is one face task run
+BENCH(face_automatic, 20000)
+{
+    BenchFace bench;
+    bench.face.setAutomatic(true);
+    uint64_t busBytes = bench.busBytes();
+
+    state.start();
+    for (uint32_t i = 0; i < state.iterations; i++) bench.tick();
+    state.stop();
+    state.busBytes = bench.busBytes() - busBytes;
+}
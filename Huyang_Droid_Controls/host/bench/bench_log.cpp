@@ -0,0 +1,38 @@
+#include "Bench.h"
+#include <Arduino.h>
+#include "../../src/submodules/Log/Log.h"
+
+// A message queued, formatted and printed, one rate limit window apart so none is left out.
+// The serial bytes are those of the printed lines.
+BENCH(log_queue_and_drain, 500000)
+{
+    Log::flush(Serial); // Empty ring, nothing left from the other benchmarks
+    uint32_t dropped = Log::dropped();
+
+    state.start();
+    for (uint32_t i = 0; i < state.iterations; i++)
+    {
+        benchClock.advance(Log_SITE_WINDOW * 1000);
+        LOG_INFO("HuyangNeck::doRandomRotate - New random rotation triggered to %.2f", (double)(i % 180) - 90);
+        if (i % Log_ENTRIES == Log_ENTRIES - 1) Log::drain(Serial, SIZE_MAX);
+    }
+    Log::flush(Serial);
+    state.stop();
+    if (Log::dropped() != dropped) state.fail("messages were dropped");
+}
+
+// A call site logging faster than its rate limit, as the manual eye commands did every face run.
+// One message per simulated microsecond, the site passes Log_SITE_BURST of them per window.
+BENCH(log_rate_limited, 5000000)
+{
+    Log::flush(Serial);
+
+    state.start();
+    for (uint32_t i = 0; i < state.iterations; i++)
+    {
+        benchClock.advance(1);
+        LOG_INFO("HuyangFace::setLeftEyeTo called with state: %d", (int)(i & 7));
+    }
+    Log::flush(Serial);
+    state.stop();
+}
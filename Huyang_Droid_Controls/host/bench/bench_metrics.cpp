@@ -0,0 +1,36 @@
+#include "Bench.h"
+#include <Arduino.h>
+#include "../../src/submodules/LoopMetrics/LoopMetrics.h"
+
+// Cost of timing one section, paid by every task run on the robot
+BENCH(loop_metrics_record, 2000000)
+{
+    LoopMetrics metrics;
+
+    state.start();
+    for (uint32_t i = 0; i < state.iterations; i++)
+    {
+        uint32_t start = LoopMetrics::now();
+        benchClock.advance(i & 1023); // Spread over the first histogram buckets
+        metrics.record(METRICS_FACE, start);
+    }
+    state.stop();
+}
+
+// Summary of a full window, as built for every /api/metrics request and serial dump
+BENCH(loop_metrics_summary, 20000)
+{
+    LoopMetrics metrics;
+    for (uint32_t i = 0; i < LoopMetrics_WINDOW; i++)
+    {
+        uint32_t start = LoopMetrics::now();
+        benchClock.advance(random(100, 5000));
+        metrics.record(METRICS_FACE, start);
+    }
+
+    uint32_t sum = 0;
+    state.start();
+    for (uint32_t i = 0; i < state.iterations; i++) sum += metrics.summary(METRICS_FACE).p99;
+    state.stop();
+    if (sum == 0) state.fail("p99 of the face section was 0");
+}
@@ -0,0 +1,83 @@
+#include "Bench.h"
+#include <Arduino.h>
+#include "../../src/submodules/Hal/PwmOutput.h"
+#include "../../src/classes/ServoFrame/ServoFrame.h"
+#include "../../src/classes/EasingServo/EasingServo.h"
+
+#define BenchServo_TICK_MICROS 10000 // Period of the servo task in the sketch (TASK_SERVO_PERIOD)
+
+// Swings a servo between both ends, one move after the other
+static void keepMoving(EasingServo &servo, double duration)
+{
+    if (!servo.isMoving()) servo.moveServoTo(servo.targetDegree() < 90 ? 180 : 0, duration);
+}
+
+// One servo easing back and forth, an operation is one servo task run including the flush
+BENCH(servo_single, 1000000)
+{
+    RecordingPwmOutput pwm;
+    pwm.recording = false;
+    ServoFrame frame(&pwm);
+    EasingServo servo(&frame, 0, 0, 180, 90);
+
+    state.start();
+    for (uint32_t i = 0; i < state.iterations; i++)
+    {
+        keepMoving(servo, 1000);
+        servo.updatePosition();
+        frame.flush();
+        benchClock.advance(BenchServo_TICK_MICROS);
+    }
+    state.stop();
+    state.busBytes = pwm.busBytes;
+}
+
+// Same with the velocity and acceleration limited profile of the body axes
+BENCH(servo_single_trapezoid, 1000000)
+{
+    RecordingPwmOutput pwm;
+    pwm.recording = false;
+    ServoFrame frame(&pwm);
+    EasingServo servo(&frame, 0, 0, 180, 90);
+    servo.setProfile(EASING_PROFILE_TRAPEZOID, 45, 90);
+
+    state.start();
+    for (uint32_t i = 0; i < state.iterations; i++)
+    {
+        keepMoving(servo, 0);
+        servo.updatePosition();
+        frame.flush();
+        benchClock.advance(BenchServo_TICK_MICROS);
+    }
+    state.stop();
+    state.busBytes = pwm.busBytes;
+}
+
+// All 16 PCA9685 channels moving at once with different durations
+BENCH(servo_16_channels, 100000)
+{
+    RecordingPwmOutput pwm;
+    pwm.recording = false;
+    ServoFrame frame(&pwm);
+    EasingServo *servos[ServoFrame_CHANNELS];
+    for (uint8_t channel = 0; channel < ServoFrame_CHANNELS; channel++)
+    {
+        servos[channel] = new EasingServo(&frame, channel, 0, 180, 90);
+    }
+
+    state.start();
+    for (uint32_t i = 0; i < state.iterations; i++)
+    {
+        for (uint8_t channel = 0; channel < ServoFrame_CHANNELS; channel++)
+        {
+            keepMoving(*servos[channel], 800 + 50 * channel);
+            servos[channel]->updatePosition();
+        }
+        frame.flush();
+        benchClock.advance(BenchServo_TICK_MICROS);
+    }
+    state.stop();
+    state.busBytes = pwm.busBytes;
+
+    for (EasingServo *servo : servos) delete servo;
+}
@@ -0,0 +1,121 @@
+#include "Bench.h"
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "../../src/submodules/WebServer/WebServer.h"
+#include "../../src/submodules/Scheduler/Scheduler.h"
+#include "../../src/classes/ServoFrame/ServoFrame.h"
+#include "../../src/submodules/LoopMetrics/LoopMetrics.h"
+
+// Globals of the sketch that WebServer.cpp uses. The subsystems stay nullptr, the API handlers
+// only hand commands to the control tasks through faceCommands and motionCommands.
+class HuyangFace;
+class HuyangBody;
+class HuyangNeck;
+class HuyangAudio;
+HuyangFace *huyangFace = nullptr;
+HuyangBody *huyangBody = nullptr;
+HuyangNeck *huyangNeck = nullptr;
+HuyangAudio *huyangAudio = nullptr;
+ServoFrame *servoFrame = nullptr;
+Scheduler *scheduler = nullptr;
+LoopMetrics *loopMetrics = nullptr;
+
+// WebServer with all features enabled, set up on the in-memory LittleFS
+struct BenchWeb {
+    WebServer web;
+    AsyncWebServer *server;
+
+    BenchWeb() : web(80)
+    {
+        web.setup(true, true, true, true, true, true, true);
+        server = AsyncWebServer::last();
+    }
+
+    // POSTs a body the way the network would deliver it, in chunks of at most chunk bytes.
+    // ArduinoJson parses the body in place, so every request gets a fresh copy.
+    int post(const char *url, const char *body, size_t chunk = 0)
+    {
+        char copy[WebServer_BODY_CAPACITY];
+        size_t length = strlen(body);
+        memcpy(copy, body, length);
+        AsyncWebServerRequest request(HTTP_POST, url);
+        server->receive(&request, (const uint8_t *)copy, length, chunk);
+        return request.responseCode;
+    }
+};
+
+// The JSON document is preallocated and parses in place, the 2 allocations per request are the
+// content type and body Strings of AsyncWebServerRequest::send()
+static void postAll(BenchWeb &bench, const char *body, BenchState &state, size_t chunk = 0)
+{
+    state.start();
+    for (uint32_t i = 0; i < state.iterations; i++)
+    {
+        if (bench.post("/api/action", body, chunk) != 200)
+        {
+            state.fail("POST /api/action was not answered with 200");
+            return;
+        }
+        FaceCommand command;
+        while (faceCommands.pop(command)) {} // Done by the face task on the robot
+    }
+    state.stop();
+}
+
+// Joystick update of the neck, the most frequent request
+BENCH(web_action_neck, 20000)
+{
+    BenchWeb bench;
+    postAll(bench, "{\"type\":\"neck\",\"rotate\":42,\"tiltForward\":-17,\"tiltSideways\":5}", state);
+}
+
+BENCH(web_action_eye, 20000)
+{
+    BenchWeb bench;
+    postAll(bench, "{\"type\":\"eye\",\"target\":\"left\",\"state\":4}", state);
+}
+
+// Same neck update arriving in two TCP segments, assembled in a body buffer first
+BENCH(web_action_neck_chunked, 20000)
+{
+    BenchWeb bench;
+    postAll(bench, "{\"type\":\"neck\",\"rotate\":42,\"tiltForward\":-17,\"tiltSideways\":5}", state, 32);
+}
+
+// Revalidation of the cached web interface: the ETag matches, answered with 304 from the manifest.
+// Most allocations are those of the request and its headers, built for every iteration.
+BENCH(web_asset_not_modified, 20000)
+{
+    const char *page = "<html><body>Huyang</body></html>";
+    File file = LittleFS.open("/index.html", "w");
+    file.print(page);
+    file.close();
+    file = LittleFS.open("/index.html.gz", "w");
+    file.print("gzip");
+    file.close();
+    file = LittleFS.open(AssetHandler_MANIFEST, "w");
+    file.printf("/index.html 0123456789abcdef %u gz\n", (unsigned)strlen(page));
+    file.close();
+
+    {
+        BenchWeb bench;
+        state.start();
+        for (uint32_t i = 0; i < state.iterations; i++)
+        {
+            AsyncWebServerRequest request(HTTP_GET, "/");
+            request.addHeader("Accept-Encoding", "gzip, deflate");
+            request.addHeader("If-None-Match", "\"0123456789abcdef\"");
+            bench.server->receive(&request);
+            if (request.responseCode != 304)
+            {
+                state.fail("GET / with a matching If-None-Match was not answered with 304");
+                break;
+            }
+        }
+        state.stop();
+    }
+
+    LittleFS.remove("/index.html");
+    LittleFS.remove("/index.html.gz");
+    LittleFS.remove(AssetHandler_MANIFEST);
+}
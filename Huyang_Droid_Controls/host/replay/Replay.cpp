@@ -0,0 +1,350 @@
+// Replays a session (web commands and the automatic animations in between) on the host, on a
+// simulated clock and a seeded random source, as fast as the PC can compute it.
+//
+//   build/replay [--seed n] [--out folder] session.txt
+//
+// The subsystems run in the tasks of the robot (src/submodules/Tasks), at the same rates and through
+// the same Scheduler as in Huyang_Droid_Controls.ino, with the recording HAL implementations as
+// hardware. Writes to the out folder:
+//   servos.csv  every PCA9685 channel write: time, burst, channel, on and off ticks
+//   frames.csv  every face task run that changed an eye: time, eye, transfers, pixels, checksum of
+//               the whole display content
+//   lights.csv  every change of the chest lights: time, brightness, colors
+//   log.txt     the LOG_ messages of the subsystems, with their simulated time
+// Equal seeds give equal files, so two firmware versions can be compared with diff.
+
+#include <Arduino.h>
+#include <chrono>
+#include <errno.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include "Session.h"
+#include "../../src/submodules/Hal/Hal.h"
+#include "../../src/submodules/Scheduler/Scheduler.h"
+#include "../../src/submodules/Log/Log.h"
+#include "../../src/submodules/Tasks/Tasks.h"
+
+// Task periods of the sketch in microseconds (TASK_*_PERIOD in Huyang_Droid_Controls.ino)
+#define Replay_SERVO_PERIOD 10000
+#define Replay_SERVO_DEADLINE 5000
+#define Replay_FACE_PERIOD 33333
+#define Replay_LIGHTS_PERIOD 16667
+
+// --- Simulated robot ---
+// Hardware, subsystems and the state the web handlers and tasks share, as set up by the sketch
+
+static SimulatedClock replayClock;
+static SeededRandom replayRandom;
+
+static RecordingPwmOutput pwmOutput;
+static RecordingPixelDisplay leftEyeDisplay;
+static RecordingPixelDisplay rightEyeDisplay;
+static RecordingLedStrip chestLights(NEO_PIXEL_COUNT);
+static ServoFrame replayServoFrame(&pwmOutput);
+static LoopMetrics replayMetrics;
+static Scheduler scheduler;
+
+// Globals of Huyang_Droid_Controls.ino used by the tasks, declared in Tasks.h. Every feature is enabled.
+HuyangFace *huyangFace;
+HuyangNeck *huyangNeck;
+HuyangBody *huyangBody;
+ServoFrame *servoFrame = &replayServoFrame;
+LoopMetrics *loopMetrics = &replayMetrics;
+unsigned long currentMillis = 0;
+bool enableEyes = true;
+bool enableMonacle = true;
+bool enableTorsoLights = true;
+
+// Globals of WebServer.cpp on the robot, declared in WebServer.h. No calibration offsets.
+SpscRing<FaceCommand, 8> faceCommands;
+MotionCommands motionCommands;
+std::atomic<bool> automaticAnimations(true);
+uint16_t allEyes = 0;
+uint16_t faceLeftEyeState = 3;
+uint16_t faceRightEyeState = 3;
+double neckRotate = 0;
+double neckTiltForward = 0;
+double neckTiltSideways = 0;
+int16_t bodyRotate = 0;
+int16_t bodyTiltForward = 0;
+int16_t bodyTiltSideways = 0;
+int16_t monoclePosition = 0;
+int16_t calNeckRotation = 0;
+int16_t calNeckTiltForward = 0;
+int16_t calNeckTiltSideways = 0;
+int16_t calBodyRotation = 0;
+int16_t calBodyTiltForward = 0;
+int16_t calBodyTiltSideways = 0;
+int16_t calMonoclePosition = 0;
+LightMode chestLightMode = LIGHT_STATIC_BLUE;
+
+// --- Logs ---
+
+static FILE *servoLog;
+static FILE *frameLog;
+static FILE *lightLog;
+static FILE *messageLog;
+static uint64_t servoWrites = 0;
+static uint64_t eyeFrames = 0;
+static uint64_t lightChanges = 0;
+static uint64_t eyePixels[2] = {0, 0};
+static std::vector<uint32_t> lastColors;
+static uint8_t lastBrightness = 0;
+
+static void logServos()
+{
+    for (const PwmRecord &record : pwmOutput.records)
+    {
+        fprintf(servoLog, "%u,%u,%u,%u,%u\n", record.micros, record.transaction, record.channel, record.on, record.off);
+    }
+    servoWrites += pwmOutput.records.size();
+    pwmOutput.clear();
+}
+
+// FNV-1a over what the panel shows
+static uint32_t checksum(RecordingPixelDisplay &eye)
+{
+    const uint16_t *pixels = eye.frame();
+    size_t count = (size_t)eye.width() * eye.height();
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < count; i++)
+    {
+        hash = (hash ^ (pixels[i] & 0xFF)) * 16777619u;
+        hash = (hash ^ (pixels[i] >> 8)) * 16777619u;
+    }
+    return hash;
+}
+
+static void logEye(RecordingPixelDisplay &eye, uint8_t index)
+{
+    if (eye.pixelsWritten != eyePixels[index])
+    {
+        fprintf(frameLog, "%u,%s,%u,%llu,%08x\n", halMicros(), index == 0 ? "left" : "right", (unsigned)eye.pushes.size(),
+                (unsigned long long)(eye.pixelsWritten - eyePixels[index]), checksum(eye));
+        eyePixels[index] = eye.pixelsWritten;
+        eyeFrames++;
+    }
+    eye.clear();
+}
+
+static void logLights()
+{
+    for (const LedFrame &frame : chestLights.frames)
+    {
+        if (frame.colors == lastColors && frame.brightness == lastBrightness) continue;
+        fprintf(lightLog, "%u,%u,", frame.micros, frame.brightness);
+        for (size_t i = 0; i < frame.colors.size(); i++) fprintf(lightLog, i ? " %06x" : "%06x", frame.colors[i]);
+        fprintf(lightLog, "\n");
+        lastColors = frame.colors;
+        lastBrightness = frame.brightness;
+        lightChanges++;
+    }
+    chestLights.clear();
+}
+
+// --- Tasks of the robot, each followed by logging what it put on the buses ---
+
+static void replayFaceTask()
+{
+    faceTask();
+    logEye(leftEyeDisplay, 0);
+    logEye(rightEyeDisplay, 1);
+}
+
+static void replayServoTask()
+{
+    servoTask();
+    logServos();
+}
+
+static void replayLightsTask()
+{
+    lightsTask();
+    logLights();
+}
+
+// --- Session ---
+
+// Hands an event to the tasks the way the /api/action and /api/lights handlers do
+static void apply(const SessionEvent &event)
+{
+    switch (event.command)
+    {
+    case SESSION_AUTOMATIC:
+        motionCommands.setAutomatic(event.values[0] != 0);
+        break;
+    case SESSION_NECK:
+        motionCommands.setAxis(AXIS_NECK_ROTATE, map(event.values[0], -100, 100, -90, 90));
+        motionCommands.setAxis(AXIS_NECK_TILT_FORWARD, map(event.values[1], -100, 100, -90, 90));
+        motionCommands.setAxis(AXIS_NECK_TILT_SIDEWAYS, map(event.values[2], -100, 100, -90, 90));
+        break;
+    case SESSION_BODY:
+        motionCommands.setAxis(AXIS_BODY_ROTATE, map(event.values[0], -100, 100, -90, 90));
+        motionCommands.setAxis(AXIS_BODY_TILT_FORWARD, map(event.values[1], -100, 100, -90, 90));
+        motionCommands.setAxis(AXIS_BODY_TILT_SIDEWAYS, map(event.values[2], -100, 100, -90, 90));
+        break;
+    case SESSION_MONOCLE:
+        motionCommands.setAxis(AXIS_MONOCLE, event.values[0]);
+        break;
+    case SESSION_EYES:
+        if (!faceCommands.push({(FaceTarget)event.target, (uint16_t)event.values[0]}))
+        {
+            fprintf(stderr, "Line %u: eye command queue full, command dropped like the API would\n", event.line);
+        }
+        break;
+    case SESSION_LIGHTS:
+        chestLightMode = (LightMode)event.values[0];
+        break;
+    case SESSION_END:
+        break;
+    }
+}
+
+// Earliest release of all tasks
+static uint64_t nextRelease(uint64_t now)
+{
+    uint64_t next = UINT64_MAX;
+    for (uint8_t i = 0; i < scheduler.taskCount(); i++)
+    {
+        int32_t wait = (int32_t)(scheduler.task(i).release - (uint32_t)now);
+        uint64_t release = wait > 0 ? now + wait : now;
+        if (release < next) next = release;
+    }
+    return next;
+}
+
+static FILE *openLog(const std::string &folder, const char *name, const char *header)
+{
+    std::string path = folder + "/" + name;
+    FILE *file = fopen(path.c_str(), "w");
+    if (!file)
+    {
+        fprintf(stderr, "Cannot write %s\n", path.c_str());
+        exit(2);
+    }
+    if (header) fprintf(file, "%s\n", header);
+    return file;
+}
+
+// Scheduler statistics on the console
+class ConsolePrint : public Print
+{
+public:
+    size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+};
+
+// Log messages into log.txt
+class FilePrint : public Print
+{
+public:
+    FILE *file;
+    explicit FilePrint(FILE *file) : file(file) {}
+    size_t write(uint8_t c) override { return fputc(c, file) == EOF ? 0 : 1; }
+    size_t write(const uint8_t *buffer, size_t size) override { return fwrite(buffer, 1, size, file); }
+};
+
+static void usage(const char *program)
+{
+    printf("Usage: %s [--seed n] [--out folder] session.txt\n", program);
+    printf("  --seed  seed of random(), automatic animations differ between seeds (default 1)\n");
+    printf("  --out   folder for servos.csv, frames.csv, lights.csv and log.txt (default replay-out)\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char *sessionPath = nullptr;
+    std::string folder = "replay-out";
+    uint32_t seed = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) folder = argv[++i];
+        else if (argv[i][0] != '-' && !sessionPath) sessionPath = argv[i];
+        else
+        {
+            usage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 2;
+        }
+    }
+    if (!sessionPath)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    Session session;
+    if (!session.load(sessionPath))
+    {
+        fprintf(stderr, "%s: %s\n", sessionPath, session.error.c_str());
+        return 2;
+    }
+    if (mkdir(folder.c_str(), 0755) != 0 && errno != EEXIST)
+    {
+        fprintf(stderr, "Cannot create %s\n", folder.c_str());
+        return 2;
+    }
+    servoLog = openLog(folder, "servos.csv", "micros,burst,channel,on,off");
+    frameLog = openLog(folder, "frames.csv", "micros,eye,transfers,pixels,checksum");
+    lightLog = openLog(folder, "lights.csv", "micros,brightness,colors");
+    messageLog = openLog(folder, "log.txt", nullptr);
+    FilePrint messages(messageLog);
+
+    // Everything from here on runs on simulated time
+    halUseClock(&replayClock);
+    halUseRandom(&replayRandom);
+    replayRandom.seed(seed);
+
+    huyangFace = new HuyangFace(&leftEyeDisplay, &rightEyeDisplay);
+    huyangNeck = new HuyangNeck(&pwmOutput, servoFrame);
+    huyangBody = new HuyangBody(&pwmOutput, servoFrame, &chestLights);
+    huyangFace->setup();
+    huyangBody->setup();
+    huyangNeck->setup();
+    servoFrame->flush();
+    logServos();
+    logEye(leftEyeDisplay, 0);
+    logEye(rightEyeDisplay, 1);
+    logLights();
+
+    scheduler.addTask("servos", replayServoTask, Replay_SERVO_PERIOD, Replay_SERVO_DEADLINE);
+    scheduler.addTask("face", replayFaceTask, Replay_FACE_PERIOD);
+    scheduler.addTask("lights", replayLightsTask, Replay_LIGHTS_PERIOD);
+
+    // Tasks take no simulated time, so the clock jumps from release to release
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint64_t end = session.endMillis * 1000;
+    size_t next = 0;
+    while (true)
+    {
+        uint64_t now = replayClock.now();
+        while (next < session.events.size() && session.events[next].millis * 1000 <= now) apply(session.events[next++]);
+        if (now >= end) break;
+
+        uint64_t release = nextRelease(now);
+        if (release > now)
+        {
+            uint64_t event = next < session.events.size() ? session.events[next].millis * 1000 : UINT64_MAX;
+            replayClock.set(std::min(std::min(release, event), end));
+            continue;
+        }
+        scheduler.run();
+        Log::flush(messages); // Right away, the serial port never fills up here
+    }
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    fclose(servoLog);
+    fclose(frameLog);
+    fclose(lightLog);
+    Log::flush(messages);
+    fclose(messageLog);
+
+    double simulated = end / 1e6;
+    printf("Replayed %s with seed %u: %.1f s in %.2f s (%.0fx real time)\n", sessionPath, seed, simulated, wall,
+           wall > 0 ? simulated / wall : 0.0);
+    printf("  %llu servo writes, %llu eye frames, %llu chest light changes in %s\n", (unsigned long long)servoWrites,
+           (unsigned long long)eyeFrames, (unsigned long long)lightChanges, folder.c_str());
+    ConsolePrint console;
+    scheduler.printStats(console);
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include "Session.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool Session::load(const char *path)
+{
+    events.clear();
+    endMillis = 0;
+    error.clear();
+
+    FILE *file = fopen(path, "r");
+    if (!file)
+    {
+        error = std::string("Cannot read ") + path;
+        return false;
+    }
+
+    char text[256];
+    uint32_t line = 0;
+    bool ended = false;
+    while (fgets(text, sizeof(text), file))
+    {
+        line++;
+        char *comment = strchr(text, '#');
+        if (comment) *comment = 0;
+
+        SessionEvent event = {};
+        if (!parse(text, line, event))
+        {
+            if (!error.empty()) break;
+            continue; // Empty line
+        }
+        if (ended)
+        {
+            error = "Line " + std::to_string(line) + ": event after end";
+            break;
+        }
+        if (!events.empty() && event.millis < events.back().millis)
+        {
+            error = "Line " + std::to_string(line) + ": time goes backwards";
+            break;
+        }
+        endMillis = event.millis;
+        if (event.command == SESSION_END) ended = true;
+        else events.push_back(event);
+    }
+    fclose(file);
+    return error.empty();
+}
+
+// False without an error for a line with nothing on it
+bool Session::parse(const char *text, uint32_t line, SessionEvent &event)
+{
+    char command[16] = "";
+    char target[16] = "";
+    unsigned long long millis = 0;
+    int values[3] = {0, 0, 0};
+    int fields = sscanf(text, "%llu %15s", &millis, command);
+    if (fields <= 0) return false;
+
+    event.millis = millis;
+    event.line = line;
+    const char *arguments = text;
+    for (uint8_t skip = 0; skip < 2; skip++) // Past time and command
+    {
+        arguments += strspn(arguments, " \t");
+        arguments += strcspn(arguments, " \t\r\n");
+    }
+
+    bool ok = fields == 2;
+    if (ok && strcmp(command, "automatic") == 0)
+    {
+        event.command = SESSION_AUTOMATIC;
+        ok = sscanf(arguments, "%15s", target) == 1 && (strcmp(target, "on") == 0 || strcmp(target, "off") == 0);
+        values[0] = strcmp(target, "on") == 0;
+    }
+    else if (ok && (strcmp(command, "neck") == 0 || strcmp(command, "body") == 0))
+    {
+        event.command = command[0] == 'n' ? SESSION_NECK : SESSION_BODY;
+        ok = sscanf(arguments, "%d %d %d", &values[0], &values[1], &values[2]) == 3;
+    }
+    else if (ok && strcmp(command, "monocle") == 0)
+    {
+        event.command = SESSION_MONOCLE;
+        ok = sscanf(arguments, "%d", &values[0]) == 1;
+    }
+    else if (ok && strcmp(command, "eyes") == 0)
+    {
+        event.command = SESSION_EYES;
+        ok = sscanf(arguments, "%15s %d", target, &values[0]) == 2;
+        if (strcmp(target, "all") == 0) event.target = 0;
+        else if (strcmp(target, "left") == 0) event.target = 1;
+        else if (strcmp(target, "right") == 0) event.target = 2;
+        else ok = false;
+    }
+    else if (ok && strcmp(command, "lights") == 0)
+    {
+        event.command = SESSION_LIGHTS;
+        ok = sscanf(arguments, "%d", &values[0]) == 1;
+    }
+    else if (ok && strcmp(command, "end") == 0)
+    {
+        event.command = SESSION_END;
+    }
+    else
+    {
+        ok = false;
+    }
+
+    if (!ok)
+    {
+        error = "Line " + std::to_string(line) + ": cannot read \"" + std::string(text, strcspn(text, "\r\n")) + "\"";
+        return false;
+    }
+    for (uint8_t i = 0; i < 3; i++) event.values[i] = (int16_t)values[i];
+    return true;
+}
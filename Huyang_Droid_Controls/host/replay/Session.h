@@ -0,0 +1,57 @@
+#ifndef Session_h
+#define Session_h
+
+// Recorded or hand written session for the replay: what the web interface sent, and when.
+//
+// One event per line, the time in milliseconds since the start, then the command. The values are
+// the ones the web interface sends to /api/action and /api/lights.
+//
+//   # comment
+//   0       automatic off
+//   500     neck 40 -20 10       rotate, tiltForward, tiltSideways in -100 .. 100
+//   2000    body -30 0 15        rotate, tiltForward, tiltSideways in -100 .. 100
+//   3000    monocle 20
+//   4000    eyes all 4           all / left / right and the eye state of the API
+//   4000    lights 2             chest light mode
+//   60000   automatic on
+//   3600000 end                  the replay stops here, otherwise after the last event
+//
+// Times have to be ascending, events at the same time are applied in file order.
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+enum SessionCommand : uint8_t {
+    SESSION_AUTOMATIC,
+    SESSION_NECK,
+    SESSION_BODY,
+    SESSION_MONOCLE,
+    SESSION_EYES,
+    SESSION_LIGHTS,
+    SESSION_END
+};
+
+struct SessionEvent {
+    uint64_t millis;
+    SessionCommand command;
+    uint8_t target;     // FaceTarget of SESSION_EYES
+    int16_t values[3];
+    uint32_t line;
+};
+
+class Session
+{
+public:
+    // Reads a session file, false with error set if it cannot be read or has a broken line
+    bool load(const char *path);
+
+    std::vector<SessionEvent> events;
+    uint64_t endMillis = 0; // Of the end event, or of the last event
+    std::string error;
+
+private:
+    bool parse(const char *text, uint32_t line, SessionEvent &event);
+};
+
+#endif
@@ -0,0 +1,103 @@
+#include "Arduino.h"
+#include "../../src/submodules/Hal/HalClock.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+
+String::String(double value, unsigned char decimals)
+{
+    char text[32];
+    snprintf(text, sizeof(text), "%.*f", decimals, value);
+    _text = text;
+}
+
+size_t Print::printf(const char *format, ...)
+{
+    char text[256];
+    va_list arguments;
+    va_start(arguments, format);
+    int length = vsnprintf(text, sizeof(text), format, arguments);
+    va_end(arguments);
+    if (length < 0) return 0;
+    return write((const uint8_t *)text, min((size_t)length, sizeof(text) - 1));
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    bytesWritten += size;
+    if (echo) fwrite(buffer, 1, size, stdout);
+    return size;
+}
+
+// Cycles at the CPU frequency of the HAL clock, enough for code measuring durations with it
+uint32_t EspClass::getCycleCount()
+{
+    return halMicros() * getCpuFreqMHz();
+}
+
+// The core functions follow the HAL clock and random source, so code that still calls them directly
+// runs on the same (possibly simulated) time as the subsystems
+unsigned long millis()
+{
+    return halMillis();
+}
+
+unsigned long micros()
+{
+    return halMicros();
+}
+
+void delay(unsigned long ms)
+{
+    halWait(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    halWait(us);
+}
+
+void yield()
+{
+}
+
+long random(long max)
+{
+    return halRandom(max);
+}
+
+long random(long min, long max)
+{
+    return halRandom(min, max);
+}
+
+void randomSeed(unsigned long seed)
+{
+    halRandomSeed(seed);
+}
+
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh)
+{
+    return (value - fromLow) * (toHigh - toLow) / (fromHigh - fromLow) + toLow;
+}
+
+#ifdef HOST_STRLCPY
+size_t strlcpy(char *destination, const char *source, size_t size)
+{
+    size_t length = strlen(source);
+    if (size > 0)
+    {
+        size_t count = length < size - 1 ? length : size - 1;
+        memcpy(destination, source, count);
+        destination[count] = 0;
+    }
+    return length;
+}
+#endif
+
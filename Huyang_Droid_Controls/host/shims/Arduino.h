@@ -0,0 +1,269 @@
+#ifndef Arduino_h
+#define Arduino_h
+
+// Arduino core for the host builds in host/. Only what the sketch uses. Time and random() come from
+// the HAL clock and random source (src/submodules/Hal/HalClock.h), which the benchmarks and the
+// replay replace by a SimulatedClock and a SeededRandom so every run behaves the same.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+
+using std::min;
+using std::max;
+using std::abs;
+
+#define F(text) text
+#define PROGMEM
+#define IRAM_ATTR
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+class String
+{
+public:
+    String() {}
+    String(const char *text) : _text(text ? text : "") {}
+    String(const String &other) = default;
+    explicit String(char c) : _text(1, c) {}
+    explicit String(int value) : _text(std::to_string(value)) {}
+    explicit String(unsigned int value) : _text(std::to_string(value)) {}
+    explicit String(long value) : _text(std::to_string(value)) {}
+    explicit String(unsigned long value) : _text(std::to_string(value)) {}
+    explicit String(double value, unsigned char decimals = 2);
+
+    String &operator=(const String &other) = default;
+    String &operator=(const char *text)
+    {
+        _text = text ? text : "";
+        return *this;
+    }
+
+    const char *c_str() const { return _text.c_str(); }
+    unsigned int length() const { return _text.size(); }
+    bool reserve(unsigned int size)
+    {
+        _text.reserve(size);
+        return true;
+    }
+
+    bool concat(const char *text)
+    {
+        if (text) _text += text;
+        return true;
+    }
+    bool concat(const char *text, unsigned int length)
+    {
+        _text.append(text, length);
+        return true;
+    }
+    bool concat(char c)
+    {
+        _text += c;
+        return true;
+    }
+    String &operator+=(const String &other)
+    {
+        _text += other._text;
+        return *this;
+    }
+    String &operator+=(const char *text) { concat(text); return *this; }
+    String &operator+=(char c) { concat(c); return *this; }
+
+    bool operator==(const String &other) const { return _text == other._text; }
+    bool operator==(const char *text) const { return _text == (text ? text : ""); }
+    bool operator!=(const String &other) const { return !(*this == other); }
+    bool operator!=(const char *text) const { return !(*this == text); }
+    char operator[](unsigned int index) const { return index < _text.size() ? _text[index] : 0; }
+
+    int indexOf(char c) const { size_t at = _text.find(c); return at == std::string::npos ? -1 : (int)at; }
+    int indexOf(const char *text) const { size_t at = _text.find(text); return at == std::string::npos ? -1 : (int)at; }
+    bool startsWith(const String &prefix) const { return _text.compare(0, prefix._text.size(), prefix._text) == 0; }
+    bool endsWith(const String &suffix) const
+    {
+        return _text.size() >= suffix._text.size() && _text.compare(_text.size() - suffix._text.size(), suffix._text.size(), suffix._text) == 0;
+    }
+    String substring(unsigned int from) const { return from < _text.size() ? String(_text.substr(from).c_str()) : String(); }
+    String substring(unsigned int from, unsigned int to) const { return from < to && from < _text.size() ? String(_text.substr(from, to - from).c_str()) : String(); }
+    long toInt() const { return atol(_text.c_str()); }
+
+private:
+    std::string _text;
+};
+
+// Result type of String + String, ArduinoJson 6 looks for it by name
+class StringSumHelper : public String
+{
+public:
+    StringSumHelper(const String &text) : String(text) {}
+};
+
+inline StringSumHelper operator+(const String &a, const String &b)
+{
+    StringSumHelper sum(a);
+    sum += b;
+    return sum;
+}
+inline StringSumHelper operator+(const String &a, const char *b) { return a + String(b); }
+inline StringSumHelper operator+(const char *a, const String &b) { return String(a) + b; }
+
+class Print;
+
+class Printable
+{
+public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print &print) const = 0;
+};
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size)
+    {
+        size_t written = 0;
+        while (size--) written += write(*buffer++);
+        return written;
+    }
+    size_t write(const char *text) { return text ? write((const uint8_t *)text, strlen(text)) : 0; }
+
+    size_t print(const char *text) { return write(text); }
+    size_t print(const String &text) { return write(text.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int value) { return printf("%d", value); }
+    size_t print(unsigned int value) { return printf("%u", value); }
+    size_t print(long value) { return printf("%ld", value); }
+    size_t print(unsigned long value) { return printf("%lu", value); }
+    size_t print(double value, int decimals = 2) { return printf("%.*f", decimals, value); }
+    size_t print(const Printable &printable) { return printable.printTo(*this); }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T &value) { return print(value) + println(); }
+    size_t println(double value, int decimals) { return print(value, decimals) + println(); }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() { return -1; }
+
+    size_t readBytes(char *buffer, size_t length)
+    {
+        size_t count = 0;
+        while (count < length)
+        {
+            int c = read();
+            if (c < 0) break;
+            buffer[count++] = (char)c;
+        }
+        return count;
+    }
+    size_t readBytes(uint8_t *buffer, size_t length) { return readBytes((char *)buffer, length); }
+    size_t readBytesUntil(char terminator, char *buffer, size_t length)
+    {
+        size_t count = 0;
+        while (count < length)
+        {
+            int c = read();
+            if (c < 0 || c == terminator) break;
+            buffer[count++] = (char)c;
+        }
+        return count;
+    }
+    String readString()
+    {
+        String text;
+        int c;
+        while ((c = read()) >= 0) text += (char)c;
+        return text;
+    }
+};
+
+// Serial output is counted and dropped, set echo to see it
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long) {}
+    operator bool() const { return true; }
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int availableForWrite() { return 128; }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+
+    bool echo = false;
+    uint64_t bytesWritten = 0;
+};
+extern HardwareSerial Serial;
+
+class EspClass
+{
+public:
+    void restart() { restarts++; }
+    uint32_t getFreeHeap() { return 40000; }
+    uint32_t getMaxFreeBlockSize() { return 30000; }
+    uint32_t getMaxAllocHeap() { return 30000; }
+    uint8_t getHeapFragmentation() { return 25; }
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz() { return 80; }
+
+    uint32_t restarts = 0;
+};
+extern EspClass ESP;
+
+class IPAddress
+{
+public:
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _address{a, b, c, d} {}
+    String toString() const
+    {
+        char text[16];
+        snprintf(text, sizeof(text), "%u.%u.%u.%u", _address[0], _address[1], _address[2], _address[3]);
+        return String(text);
+    }
+
+private:
+    uint8_t _address[4] = {0, 0, 0, 0};
+};
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh);
+
+template <typename T, typename L, typename H>
+T constrain(T value, L low, H high)
+{
+    return value < low ? low : (value > high ? high : value);
+}
+
+// glibc only has strlcpy() since 2.38, macOS always had it
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 38)
+#define HOST_STRLCPY
+size_t strlcpy(char *destination, const char *source, size_t size);
+#endif
+
+#endif
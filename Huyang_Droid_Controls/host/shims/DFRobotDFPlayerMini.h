@@ -0,0 +1,27 @@
+#ifndef DFRobotDFPlayerMini_h
+#define DFRobotDFPlayerMini_h
+
+// Declared for HuyangAudio.h only, the audio player is not part of the host builds
+
+#include "Arduino.h"
+
+class DFRobotDFPlayerMini
+{
+public:
+    bool begin(Stream &, bool = true, bool = true) { return false; }
+    void volume(uint8_t) {}
+    void play(int) {}
+    void pause() {}
+    void start() {}
+    void stop() {}
+    void next() {}
+    void previous() {}
+    bool available() { return false; }
+    uint8_t readType() { return 0; }
+    int read() { return 0; }
+    int readVolume() { return 0; }
+    int readCurrentFileNumber() { return 0; }
+    int readFileCounts() { return 0; }
+};
+
+#endif
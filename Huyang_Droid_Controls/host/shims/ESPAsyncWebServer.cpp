@@ -0,0 +1,3 @@
+#include "ESPAsyncWebServer.h"
+
+AsyncWebServer *AsyncWebServer::_last = nullptr;
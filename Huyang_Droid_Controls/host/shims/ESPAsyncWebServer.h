@@ -0,0 +1,372 @@
+#ifndef ESPAsyncWebServer_h
+#define ESPAsyncWebServer_h
+
+// ESPAsyncWebServer for the host builds. Routes are only recorded; AsyncWebServer::receive()
+// hands a request to them the way the library would, so the API handlers can be driven from tests
+// and benchmarks without a network.
+
+#include "Arduino.h"
+#include "FS.h"
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+typedef enum {
+    HTTP_GET = 0b00000001,
+    HTTP_POST = 0b00000010,
+    HTTP_DELETE = 0b00000100,
+    HTTP_PUT = 0b00001000,
+    HTTP_PATCH = 0b00010000,
+    HTTP_HEAD = 0b00100000,
+    HTTP_OPTIONS = 0b01000000,
+    HTTP_ANY = 0b01111111,
+} WebRequestMethod;
+typedef uint8_t WebRequestMethodComposite;
+
+class AsyncWebHeader
+{
+public:
+    AsyncWebHeader(const String &name, const String &value) : _name(name), _value(value) {}
+    const String &name() const { return _name; }
+    const String &value() const { return _value; }
+
+private:
+    String _name;
+    String _value;
+};
+
+class AsyncWebParameter
+{
+public:
+    AsyncWebParameter(const String &name, const String &value) : _name(name), _value(value) {}
+    const String &name() const { return _name; }
+    const String &value() const { return _value; }
+
+private:
+    String _name;
+    String _value;
+};
+
+class AsyncWebServerResponse
+{
+public:
+    AsyncWebServerResponse(int code = 200, size_t length = 0) : code(code), length(length) {}
+    virtual ~AsyncWebServerResponse() {}
+    void addHeader(const String &name, const String &value)
+    {
+        if (strcasecmp(name.c_str(), "ETag") == 0) strlcpy(etag, value.c_str(), sizeof(etag));
+        headers++;
+    }
+    void setCode(int value) { code = value; }
+
+    int code;
+    size_t length;
+    uint8_t headers = 0;
+    char etag[40] = {}; // Kept without allocating, so the benchmarks count the library's allocations only
+};
+
+// Response body streamed through Print, only its length is kept
+class AsyncResponseStream : public AsyncWebServerResponse, public Print
+{
+public:
+    size_t write(uint8_t) override
+    {
+        length++;
+        return 1;
+    }
+    size_t write(const uint8_t *, size_t size) override
+    {
+        length += size;
+        return size;
+    }
+    using Print::write;
+};
+
+typedef std::function<void(void)> ArDisconnectHandler;
+
+class AsyncWebServerRequest
+{
+public:
+    AsyncWebServerRequest(WebRequestMethodComposite method = HTTP_GET, const char *url = "/")
+        : _method(method), _url(url) {}
+    ~AsyncWebServerRequest()
+    {
+        for (AsyncWebHeader *header : _headers) delete header;
+        for (AsyncWebParameter *parameter : _parameters) delete parameter;
+    }
+
+    WebRequestMethodComposite method() const { return _method; }
+    const String &url() const { return _url; }
+
+    bool hasHeader(const char *name) const { return getHeader(name) != nullptr; }
+    AsyncWebHeader *getHeader(const char *name) const
+    {
+        for (AsyncWebHeader *header : _headers)
+            if (strcasecmp(header->name().c_str(), name) == 0) return header;
+        return nullptr;
+    }
+    bool hasParam(const char *name) const { return getParam(name) != nullptr; }
+    AsyncWebParameter *getParam(const char *name) const
+    {
+        for (AsyncWebParameter *parameter : _parameters)
+            if (parameter->name() == name) return parameter;
+        return nullptr;
+    }
+
+    void send(int code, const String &contentType = String(), const String &content = String())
+    {
+        (void)contentType;
+        respond(code, content.length());
+    }
+    void send(FS &, const String &, const String & = String(), bool = false) { respond(200, 0); }
+    void send(AsyncWebServerResponse *response)
+    {
+        respond(response->code, response->length);
+        strlcpy(responseETag, response->etag, sizeof(responseETag));
+        delete response;
+    }
+    AsyncWebServerResponse *beginResponse(int code, const String & = String(), const String &content = String())
+    {
+        return new AsyncWebServerResponse(code, content.length());
+    }
+    AsyncWebServerResponse *beginResponse(FS &fs, const String &path, const String & = String(), bool = false)
+    {
+        File file = fs.open(path, "r");
+        return new AsyncWebServerResponse(file ? 200 : 404, file.size());
+    }
+    AsyncWebServerResponse *beginResponse_P(int code, const String &, const uint8_t *, size_t length)
+    {
+        return new AsyncWebServerResponse(code, length);
+    }
+    AsyncResponseStream *beginResponseStream(const String &, size_t = 1460) { return new AsyncResponseStream(); }
+
+    void onDisconnect(ArDisconnectHandler handler) { _onDisconnect = handler; }
+
+    // Headers kept for handleRequest(), "ANY" keeps all of them
+    void addInterestingHeader(const String &name) { _interestingHeaders.push_back(name); }
+
+    // --- Host only ---
+    void addHeader(const char *name, const char *value) { _headers.push_back(new AsyncWebHeader(name, value)); }
+    void addParam(const char *name, const char *value) { _parameters.push_back(new AsyncWebParameter(name, value)); }
+    void disconnect()
+    {
+        if (_onDisconnect) _onDisconnect();
+    }
+    // Like the library after canHandle(): every header no handler asked for is dropped
+    void removeNotInterestingHeaders()
+    {
+        for (const String &name : _interestingHeaders)
+            if (name == "ANY") return;
+        for (size_t i = 0; i < _headers.size();)
+        {
+            bool interesting = false;
+            for (const String &name : _interestingHeaders)
+                if (strcasecmp(name.c_str(), _headers[i]->name().c_str()) == 0) interesting = true;
+            if (interesting)
+            {
+                i++;
+                continue;
+            }
+            delete _headers[i];
+            _headers.erase(_headers.begin() + i);
+        }
+    }
+
+    int responseCode = 0;      // Of the last response sent, 0 = none
+    size_t responseLength = 0;
+    uint32_t responses = 0;    // More than one is a bug in the handler
+    char responseETag[40] = {};
+
+    void *_tempObject = nullptr;
+
+private:
+    WebRequestMethodComposite _method;
+    String _url;
+    std::vector<AsyncWebHeader *> _headers;
+    std::vector<AsyncWebParameter *> _parameters;
+    std::vector<String> _interestingHeaders;
+    ArDisconnectHandler _onDisconnect;
+
+    void respond(int code, size_t length)
+    {
+        responseCode = code;
+        responseLength = length;
+        responses++;
+    }
+};
+
+typedef std::function<void(AsyncWebServerRequest *request)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest *request, const String &filename, size_t index, uint8_t *data, size_t len, bool final)> ArUploadHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)> ArBodyHandlerFunction;
+
+class AsyncWebHandler
+{
+public:
+    virtual ~AsyncWebHandler() {}
+    virtual bool canHandle(AsyncWebServerRequest *) { return false; }
+    virtual void handleRequest(AsyncWebServerRequest *) {}
+    virtual bool isRequestHandlerTrivial() { return true; }
+};
+
+class AsyncStaticWebHandler : public AsyncWebHandler
+{
+public:
+    AsyncStaticWebHandler &setDefaultFile(const char *) { return *this; }
+    AsyncStaticWebHandler &setCacheControl(const char *) { return *this; }
+};
+
+class AsyncCallbackWebHandler : public AsyncWebHandler
+{
+public:
+    String uri;
+    WebRequestMethodComposite method = HTTP_ANY;
+    ArRequestHandlerFunction onRequest;
+    ArBodyHandlerFunction onBody;
+};
+
+class AsyncWebSocketClient
+{
+public:
+    AsyncWebSocketClient(uint32_t id = 1) : _id(id) {}
+    uint32_t id() const { return _id; }
+    void binary(const uint8_t *, size_t) {}
+    void text(const char *) {}
+    bool canSend() const { return true; }
+
+private:
+    uint32_t _id;
+};
+
+typedef enum { WS_EVT_CONNECT, WS_EVT_DISCONNECT, WS_EVT_PONG, WS_EVT_ERROR, WS_EVT_DATA } AwsEventType;
+typedef enum { WS_CONTINUATION, WS_TEXT, WS_BINARY, WS_DISCONNECT = 0x08, WS_PING, WS_PONG } AwsFrameType;
+typedef struct {
+    uint8_t message_opcode;
+    uint32_t num;
+    uint8_t final;
+    uint8_t masked;
+    uint8_t opcode;
+    uint64_t len;
+    uint8_t mask[4];
+    uint64_t index;
+} AwsFrameInfo;
+
+class AsyncWebSocket;
+typedef std::function<void(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len)> AwsEventHandler;
+
+class AsyncWebSocket : public AsyncWebHandler
+{
+public:
+    AsyncWebSocket(const String &url) : _url(url) {}
+    void onEvent(AwsEventHandler handler) { _handler = handler; }
+    void cleanupClients(uint16_t = 8) {}
+    size_t count() const { return 0; }
+
+    // --- Host only ---
+    void event(AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len)
+    {
+        if (_handler) _handler(this, client, type, arg, data, len);
+    }
+
+private:
+    String _url;
+    AwsEventHandler _handler;
+};
+
+class AsyncWebServer
+{
+public:
+    AsyncWebServer(uint16_t port) : _port(port) { _last = this; }
+    ~AsyncWebServer()
+    {
+        for (AsyncCallbackWebHandler *route : _routes) delete route;
+        if (_last == this) _last = nullptr;
+    }
+
+    void begin() { started = true; }
+    AsyncStaticWebHandler &serveStatic(const char *, FS &, const char *, const char * = nullptr) { return _static; }
+    AsyncWebHandler &addHandler(AsyncWebHandler *handler)
+    {
+        _handlers.push_back(handler);
+        return *handler;
+    }
+    AsyncCallbackWebHandler &on(const char *uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest)
+    {
+        return on(uri, method, onRequest, nullptr, nullptr);
+    }
+    AsyncCallbackWebHandler &on(const char *uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+                                ArUploadHandlerFunction, ArBodyHandlerFunction onBody)
+    {
+        AsyncCallbackWebHandler *route = new AsyncCallbackWebHandler();
+        route->uri = uri;
+        route->method = method;
+        route->onRequest = onRequest;
+        route->onBody = onBody;
+        _routes.push_back(route);
+        return *route;
+    }
+    void onNotFound(ArRequestHandlerFunction handler) { _notFound = handler; }
+
+    // --- Host only ---
+    // Serves a request like the library: handlers added with addHandler() first, then the routes.
+    // canHandle() sees all headers, handleRequest() only those declared with addInterestingHeader()
+    // (routes keep all of them). A body is handed to the route in chunks of at most chunk bytes
+    // before the request handler runs.
+    void receive(AsyncWebServerRequest *request, const uint8_t *body = nullptr, size_t length = 0, size_t chunk = 0)
+    {
+        for (AsyncWebHandler *handler : _handlers)
+        {
+            if (handler->canHandle(request))
+            {
+                request->removeNotInterestingHeaders();
+                handler->handleRequest(request);
+                return;
+            }
+        }
+        for (AsyncCallbackWebHandler *route : _routes)
+        {
+            if (!(route->method & request->method()) || route->uri != request->url().c_str()) continue;
+            if (route->onBody && length > 0)
+            {
+                if (chunk == 0) chunk = length;
+                for (size_t index = 0; index < length; index += chunk)
+                {
+                    route->onBody(request, (uint8_t *)body + index, min(chunk, length - index), index, length);
+                }
+            }
+            if (route->onRequest) route->onRequest(request);
+            return;
+        }
+        request->removeNotInterestingHeaders();
+        if (_notFound) _notFound(request);
+    }
+
+    // Hands one chunk of a body to the route of the request, without running its request handler.
+    // Lets tests interleave the chunks of several requests the way AsyncTCP may deliver them.
+    bool receiveBody(AsyncWebServerRequest *request, const uint8_t *data, size_t length, size_t index, size_t total)
+    {
+        for (AsyncCallbackWebHandler *route : _routes)
+        {
+            if (!(route->method & request->method()) || route->uri != request->url().c_str() || !route->onBody) continue;
+            route->onBody(request, (uint8_t *)data, length, index, total);
+            return true;
+        }
+        return false;
+    }
+
+    // Most recently created server, for code that keeps its server private
+    static AsyncWebServer *last() { return _last; }
+
+    bool started = false;
+
+private:
+    uint16_t _port;
+    std::vector<AsyncWebHandler *> _handlers;
+    std::vector<AsyncCallbackWebHandler *> _routes;
+    AsyncStaticWebHandler _static;
+    ArRequestHandlerFunction _notFound;
+
+    static AsyncWebServer *_last;
+};
+
+#endif
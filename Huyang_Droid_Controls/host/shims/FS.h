@@ -0,0 +1,112 @@
+#ifndef FS_h
+#define FS_h
+
+// In-memory file system for the host builds, behaving like LittleFS for the calls the sketch makes
+
+#include "Arduino.h"
+#include <map>
+#include <memory>
+#include <string>
+
+namespace fs {
+
+class File : public Stream
+{
+public:
+    File() {}
+    File(std::shared_ptr<std::string> data, const char *name, bool writable)
+        : _data(data), _name(name), _writable(writable) {}
+
+    operator bool() const { return (bool)_data; }
+
+    int available() override { return _data ? (int)(_data->size() - _position) : 0; }
+    int read() override { return _data && _position < _data->size() ? (uint8_t)(*_data)[_position++] : -1; }
+    int peek() override { return _data && _position < _data->size() ? (uint8_t)(*_data)[_position] : -1; }
+    size_t read(uint8_t *buffer, size_t length)
+    {
+        if (!_data) return 0;
+        size_t count = min(length, _data->size() - _position);
+        memcpy(buffer, _data->data() + _position, count);
+        _position += count;
+        return count;
+    }
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t *buffer, size_t length) override
+    {
+        if (!_data || !_writable) return 0;
+        _data->append((const char *)buffer, length);
+        return length;
+    }
+    using Print::write;
+
+    bool seek(uint32_t position)
+    {
+        if (!_data || position > _data->size()) return false;
+        _position = position;
+        return true;
+    }
+    size_t position() const { return _position; }
+    size_t size() const { return _data ? _data->size() : 0; }
+    const char *name() const { return _name.c_str(); }
+    bool isDirectory() const { return false; }
+    void close() { _data.reset(); }
+
+private:
+    std::shared_ptr<std::string> _data;
+    std::string _name;
+    bool _writable = false;
+    size_t _position = 0;
+};
+
+class FS
+{
+public:
+    bool begin() { return true; }
+    bool format()
+    {
+        _files.clear();
+        return true;
+    }
+    bool exists(const char *path) { return _files.count(path) > 0; }
+    bool exists(const String &path) { return exists(path.c_str()); }
+    File open(const char *path, const char *mode = "r")
+    {
+        if (mode[0] == 'w')
+        {
+            _files[path] = std::make_shared<std::string>();
+        }
+        else if (mode[0] == 'a')
+        {
+            if (!exists(path)) _files[path] = std::make_shared<std::string>();
+        }
+        else if (!exists(path))
+        {
+            return File();
+        }
+        return File(_files[path], path, mode[0] != 'r');
+    }
+    File open(const String &path, const char *mode = "r") { return open(path.c_str(), mode); }
+    bool remove(const char *path) { return _files.erase(path) > 0; }
+    bool rename(const char *from, const char *to)
+    {
+        if (failRenames || !exists(from)) return false;
+        _files[to] = _files[from];
+        _files.erase(from);
+        return true;
+    }
+    bool mkdir(const char *) { return true; }
+
+    // Host only: rename() fails while set, as it does on a full or worn out flash
+    bool failRenames = false;
+
+private:
+    std::map<std::string, std::shared_ptr<std::string>> _files;
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef SoftwareSerial_h
+#define SoftwareSerial_h
+
+// Declared for HuyangAudio.h only, the audio player is not part of the host builds
+
+#include "Arduino.h"
+
+class SoftwareSerial : public Stream
+{
+public:
+    SoftwareSerial(int8_t rx, int8_t tx) { (void)rx; (void)tx; }
+    void begin(unsigned long) {}
+    int available() override { return 0; }
+    int read() override { return -1; }
+    size_t write(uint8_t) override { return 1; }
+    using Print::write;
+};
+
+#endif
@@ -0,0 +1,1240 @@
+#ifndef ArduinoJson_h
+#define ArduinoJson_h
+
+// ArduinoJson 6 for the host build, pinned here so the WebServer benchmarks always build and
+// always measure the same JSON code.
+//
+// This is not the ArduinoJson release but a compact implementation of the part of its version 6
+// API the sketch uses, with the same memory model:
+//   - StaticJsonDocument<N> keeps everything in its own N bytes, nothing is taken from the heap.
+//     Values and members take a slot from the front of the pool, copied strings are stored at the
+//     back. When the pool is full, assignments fail and overflowed() is set.
+//   - deserializeJson() of a char * decodes the strings in place (zero-copy), the document points
+//     into the input. Other inputs (const char *, Stream) get their strings copied into the pool.
+//   - const char * values are stored as pointers, char * and String values are copied.
+//   - Conversions, is<T>() and the | operator follow ArduinoJson 6: integers out of the range of
+//     the asked type read as 0, "| 0" on a float falls back to the default.
+// Floats are printed with 9 significant digits. Comments in the input, filters and JsonVariantConst
+// are not supported.
+//
+// To measure the real library instead, build with ARDUINOJSON=<folder of ArduinoJson.h>, see
+// host/Makefile. The results are then not comparable with bench_baseline.txt.
+
+#include <Arduino.h>
+#include <limits>
+#include <errno.h>
+#include <math.h>
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <type_traits>
+
+#define ARDUINOJSON_VERSION "6.21-host"
+#define ARDUINOJSON_VERSION_MAJOR 6
+#define ARDUINOJSON_DEFAULT_NESTING_LIMIT 10
+
+class JsonDocument;
+class JsonObject;
+class JsonArray;
+class JsonVariant;
+template <typename TUpstream>
+class MemberProxy;
+
+namespace ArduinoJsonHost {
+
+enum Type : uint8_t {
+    TYPE_NULL,
+    TYPE_BOOL,
+    TYPE_INTEGER,
+    TYPE_FLOAT,
+    TYPE_STRING,
+    TYPE_ARRAY,
+    TYPE_OBJECT
+};
+
+struct Slot;
+
+struct Variant {
+    Type type = TYPE_NULL;
+    union {
+        bool boolean;
+        int64_t integer;
+        double number;
+        const char *string;
+        Slot *head; // First member or element
+    };
+    Variant() : integer(0) {}
+};
+
+struct Slot {
+    Variant value;
+    const char *key = nullptr; // nullptr in arrays
+    Slot *next = nullptr;
+};
+
+// Slots from the front, copied strings from the back, like the pool of ArduinoJson
+class Pool
+{
+public:
+    Pool(char *buffer, size_t capacity) : _begin(buffer), _left(buffer), _right(buffer + capacity), _end(buffer + capacity) {}
+
+    void clear()
+    {
+        _left = _begin;
+        _right = _end;
+        _overflowed = false;
+    }
+
+    Slot *allocSlot()
+    {
+        uintptr_t aligned = ((uintptr_t)_left + alignof(Slot) - 1) & ~(uintptr_t)(alignof(Slot) - 1);
+        if (aligned + sizeof(Slot) > (uintptr_t)_right)
+        {
+            _overflowed = true;
+            return nullptr;
+        }
+        _left = (char *)aligned + sizeof(Slot);
+        return new ((void *)aligned) Slot();
+    }
+
+    const char *copyString(const char *text, size_t length)
+    {
+        if ((size_t)(_right - _left) < length + 1)
+        {
+            _overflowed = true;
+            return nullptr;
+        }
+        _right -= length + 1;
+        memcpy(_right, text, length);
+        _right[length] = 0;
+        return _right;
+    }
+
+    // A string being decoded is written into the free space, then moved to the back with save()
+    char *builderStart() { return _left; }
+    size_t builderRoom() const { return _right - _left; }
+    const char *save(size_t length)
+    {
+        if (builderRoom() < length + 1)
+        {
+            _overflowed = true;
+            return nullptr;
+        }
+        memmove(_right - length - 1, _left, length);
+        _right -= length + 1;
+        _right[length] = 0;
+        return _right;
+    }
+    void overflow() { _overflowed = true; }
+
+    size_t capacity() const { return _end - _begin; }
+    size_t size() const { return (_left - _begin) + (_end - _right); }
+    bool overflowed() const { return _overflowed; }
+
+private:
+    char *_begin;
+    char *_left;
+    char *_right;
+    char *_end;
+    bool _overflowed = false;
+};
+
+inline Slot *findMember(const Variant *object, const char *key)
+{
+    if (!object || object->type != TYPE_OBJECT || !key) return nullptr;
+    for (Slot *slot = object->head; slot; slot = slot->next)
+        if (strcmp(slot->key, key) == 0) return slot;
+    return nullptr;
+}
+
+inline Variant *getMember(const Variant *object, const char *key)
+{
+    Slot *slot = findMember(object, key);
+    return slot ? &slot->value : nullptr;
+}
+
+inline Slot *appendSlot(Variant *collection, Pool *pool)
+{
+    Slot *slot = pool->allocSlot();
+    if (!slot) return nullptr;
+    Slot **last = &collection->head;
+    while (*last) last = &(*last)->next;
+    *last = slot;
+    return slot;
+}
+
+// Member of an object, added when missing. A null variant becomes an object.
+inline Variant *getOrAddMember(Variant *object, const char *key, Pool *pool, bool copyKey = false)
+{
+    if (!object || !key) return nullptr;
+    if (object->type == TYPE_NULL)
+    {
+        object->type = TYPE_OBJECT;
+        object->head = nullptr;
+    }
+    if (object->type != TYPE_OBJECT) return nullptr;
+    Slot *slot = findMember(object, key);
+    if (slot) return &slot->value;
+
+    if (copyKey)
+    {
+        key = pool->copyString(key, strlen(key));
+        if (!key) return nullptr;
+    }
+    slot = appendSlot(object, pool);
+    if (!slot) return nullptr;
+    slot->key = key;
+    return &slot->value;
+}
+
+// New element at the end of an array. A null variant becomes an array.
+inline Variant *addElement(Variant *array, Pool *pool)
+{
+    if (!array) return nullptr;
+    if (array->type == TYPE_NULL)
+    {
+        array->type = TYPE_ARRAY;
+        array->head = nullptr;
+    }
+    if (array->type != TYPE_ARRAY) return nullptr;
+    Slot *slot = appendSlot(array, pool);
+    return slot ? &slot->value : nullptr;
+}
+
+inline size_t collectionSize(const Variant *collection)
+{
+    if (!collection || (collection->type != TYPE_ARRAY && collection->type != TYPE_OBJECT)) return 0;
+    size_t size = 0;
+    for (Slot *slot = collection->head; slot; slot = slot->next) size++;
+    return size;
+}
+
+template <typename T>
+struct IsInteger : std::integral_constant<bool, std::is_integral<T>::value && !std::is_same<T, bool>::value> {};
+
+template <typename T>
+inline bool integerFits(int64_t value)
+{
+    if (std::is_unsigned<T>::value) return value >= 0 && (uint64_t)value <= (uint64_t)std::numeric_limits<T>::max();
+    return value >= (int64_t)std::numeric_limits<T>::min() && value <= (int64_t)std::numeric_limits<T>::max();
+}
+
+template <typename T>
+inline bool floatFits(double value)
+{
+    return value >= (double)std::numeric_limits<T>::min() && value <= (double)std::numeric_limits<T>::max();
+}
+
+// --- Reading and writing values of type T ---
+
+template <typename T, typename Enable = void>
+struct Converter;
+
+template <>
+struct Converter<bool> {
+    static bool fromJson(const Variant *v)
+    {
+        if (!v) return false;
+        if (v->type == TYPE_BOOL) return v->boolean;
+        if (v->type == TYPE_INTEGER) return v->integer != 0;
+        if (v->type == TYPE_FLOAT) return v->number != 0;
+        return false;
+    }
+    static bool checkJson(const Variant *v) { return v && v->type == TYPE_BOOL; }
+    static bool toJson(bool value, Variant *v, Pool *)
+    {
+        v->type = TYPE_BOOL;
+        v->boolean = value;
+        return true;
+    }
+};
+
+template <typename T>
+struct Converter<T, typename std::enable_if<IsInteger<T>::value>::type> {
+    static T fromJson(const Variant *v)
+    {
+        if (!v) return 0;
+        if (v->type == TYPE_INTEGER) return integerFits<T>(v->integer) ? (T)v->integer : 0;
+        if (v->type == TYPE_FLOAT) return floatFits<T>(v->number) ? (T)v->number : 0;
+        if (v->type == TYPE_BOOL) return v->boolean ? 1 : 0;
+        return 0;
+    }
+    static bool checkJson(const Variant *v) { return v && v->type == TYPE_INTEGER && integerFits<T>(v->integer); }
+    static bool toJson(T value, Variant *v, Pool *)
+    {
+        v->type = TYPE_INTEGER;
+        v->integer = (int64_t)value;
+        return true;
+    }
+};
+
+template <typename T>
+struct Converter<T, typename std::enable_if<std::is_enum<T>::value>::type> {
+    typedef typename std::underlying_type<T>::type Integer;
+    static T fromJson(const Variant *v) { return (T)Converter<Integer>::fromJson(v); }
+    static bool checkJson(const Variant *v) { return Converter<Integer>::checkJson(v); }
+    static bool toJson(T value, Variant *v, Pool *pool) { return Converter<Integer>::toJson((Integer)value, v, pool); }
+};
+
+template <typename T>
+struct Converter<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+    static T fromJson(const Variant *v)
+    {
+        if (!v) return 0;
+        if (v->type == TYPE_FLOAT) return (T)v->number;
+        if (v->type == TYPE_INTEGER) return (T)v->integer;
+        if (v->type == TYPE_BOOL) return v->boolean ? 1 : 0;
+        return 0;
+    }
+    static bool checkJson(const Variant *v) { return v && (v->type == TYPE_FLOAT || v->type == TYPE_INTEGER); }
+    static bool toJson(T value, Variant *v, Pool *)
+    {
+        v->type = TYPE_FLOAT;
+        v->number = (double)value;
+        return true;
+    }
+};
+
+template <>
+struct Converter<const char *> {
+    static const char *fromJson(const Variant *v) { return v && v->type == TYPE_STRING ? v->string : nullptr; }
+    static bool checkJson(const Variant *v) { return v && v->type == TYPE_STRING; }
+    static bool toJson(const char *value, Variant *v, Pool *) // Linked, not copied
+    {
+        if (!value)
+        {
+            v->type = TYPE_NULL;
+            return true;
+        }
+        v->type = TYPE_STRING;
+        v->string = value;
+        return true;
+    }
+};
+
+inline bool setCopiedString(Variant *v, Pool *pool, const char *value, size_t length)
+{
+    const char *copy = pool->copyString(value, length);
+    if (!copy)
+    {
+        v->type = TYPE_NULL;
+        return false;
+    }
+    v->type = TYPE_STRING;
+    v->string = copy;
+    return true;
+}
+
+template <>
+struct Converter<char *> {
+    static bool toJson(const char *value, Variant *v, Pool *pool)
+    {
+        if (!value)
+        {
+            v->type = TYPE_NULL;
+            return true;
+        }
+        return setCopiedString(v, pool, value, strlen(value));
+    }
+};
+
+template <>
+struct Converter<String> {
+    static String fromJson(const Variant *v) { return v && v->type == TYPE_STRING ? String(v->string) : String(); }
+    static bool checkJson(const Variant *v) { return v && v->type == TYPE_STRING; }
+    static bool toJson(const String &value, Variant *v, Pool *pool) { return setCopiedString(v, pool, value.c_str(), value.length()); }
+};
+
+template <typename T>
+inline bool setValue(Variant *v, Pool *pool, const T &value)
+{
+    if (!v) return false;
+    return Converter<T>::toJson(value, v, pool);
+}
+
+inline bool setValue(Variant *v, Pool *pool, const char *value)
+{
+    return v ? Converter<const char *>::toJson(value, v, pool) : false;
+}
+
+inline bool setValue(Variant *v, Pool *pool, char *value)
+{
+    return v ? Converter<char *>::toJson(value, v, pool) : false;
+}
+
+template <size_t N>
+inline bool setValue(Variant *v, Pool *pool, const char (&value)[N])
+{
+    return setValue(v, pool, (const char *)value);
+}
+
+template <size_t N>
+inline bool setValue(Variant *v, Pool *pool, char (&value)[N])
+{
+    return setValue(v, pool, (char *)value);
+}
+
+// What a MemberProxy keeps of the value it is a member of: small handles are copied, documents referenced
+template <typename T>
+struct Upstream {
+    typedef T type;
+};
+
+template <>
+struct Upstream<JsonDocument> {
+    typedef const JsonDocument &type;
+};
+
+} // namespace ArduinoJsonHost
+
+// --- Functions shared by documents, variants and member proxies ---
+
+template <typename TDerived>
+class VariantApi
+{
+public:
+    template <typename T>
+    T as() const { return ArduinoJsonHost::Converter<T>::fromJson(derived().getData()); }
+
+    template <typename T>
+    bool is() const { return ArduinoJsonHost::Converter<T>::checkJson(derived().getData()); }
+
+    bool isNull() const
+    {
+        const ArduinoJsonHost::Variant *v = derived().getData();
+        return !v || v->type == ArduinoJsonHost::TYPE_NULL;
+    }
+
+    template <typename T>
+    bool set(const T &value) const { return ArduinoJsonHost::setValue(derived().getOrAddData(), derived().getPool(), value); }
+    bool set(const char *value) const { return ArduinoJsonHost::setValue(derived().getOrAddData(), derived().getPool(), value); }
+    bool set(char *value) const { return ArduinoJsonHost::setValue(derived().getOrAddData(), derived().getPool(), value); }
+
+    MemberProxy<typename ArduinoJsonHost::Upstream<TDerived>::type> operator[](const char *key) const;
+    MemberProxy<typename ArduinoJsonHost::Upstream<TDerived>::type> operator[](const String &key) const;
+
+    bool containsKey(const char *key) const { return ArduinoJsonHost::findMember(derived().getData(), key) != nullptr; }
+    size_t size() const { return ArduinoJsonHost::collectionSize(derived().getData()); }
+
+    // Value when it is a T, defaultValue otherwise
+    template <typename T>
+    typename std::enable_if<!std::is_array<T>::value, T>::type operator|(const T &defaultValue) const
+    {
+        const ArduinoJsonHost::Variant *v = derived().getData();
+        return ArduinoJsonHost::Converter<T>::checkJson(v) ? ArduinoJsonHost::Converter<T>::fromJson(v) : defaultValue;
+    }
+    const char *operator|(const char *defaultValue) const
+    {
+        const char *value = ArduinoJsonHost::Converter<const char *>::fromJson(derived().getData());
+        return value ? value : defaultValue;
+    }
+
+    template <typename T>
+    bool add(const T &value) const { return ArduinoJsonHost::setValue(ArduinoJsonHost::addElement(derived().getOrAddData(), derived().getPool()), derived().getPool(), value); }
+    bool add(const char *value) const { return ArduinoJsonHost::setValue(ArduinoJsonHost::addElement(derived().getOrAddData(), derived().getPool()), derived().getPool(), value); }
+
+    JsonArray createNestedArray() const;
+    JsonObject createNestedObject() const;
+    JsonArray createNestedArray(const char *key) const;
+    JsonObject createNestedObject(const char *key) const;
+
+private:
+    const TDerived &derived() const { return static_cast<const TDerived &>(*this); }
+};
+
+// Reads a member, or writes it (creating it and the objects above it) when assigned to
+template <typename TUpstream>
+class MemberProxy : public VariantApi<MemberProxy<TUpstream>>
+{
+public:
+    MemberProxy(TUpstream upstream, const char *key) : _upstream(upstream), _key(key) {}
+    MemberProxy(const MemberProxy &other) = default;
+
+    template <typename T>
+    MemberProxy &operator=(const T &value)
+    {
+        this->set(value);
+        return *this;
+    }
+    MemberProxy &operator=(const char *value)
+    {
+        this->set(value);
+        return *this;
+    }
+    MemberProxy &operator=(char *value)
+    {
+        this->set(value);
+        return *this;
+    }
+
+    template <typename T, typename = typename std::enable_if<!std::is_array<T>::value>::type>
+    operator T() const { return this->template as<T>(); }
+
+    ArduinoJsonHost::Variant *getData() const { return ArduinoJsonHost::getMember(_upstream.getData(), _key); }
+    ArduinoJsonHost::Variant *getOrAddData() const { return ArduinoJsonHost::getOrAddMember(_upstream.getOrAddData(), _key, getPool()); }
+    ArduinoJsonHost::Pool *getPool() const { return _upstream.getPool(); }
+
+private:
+    TUpstream _upstream;
+    const char *_key;
+};
+
+class JsonVariant : public VariantApi<JsonVariant>
+{
+public:
+    JsonVariant() {}
+    JsonVariant(ArduinoJsonHost::Variant *data, ArduinoJsonHost::Pool *pool) : _data(data), _pool(pool) {}
+
+    template <typename T, typename = typename std::enable_if<!std::is_array<T>::value>::type>
+    operator T() const { return this->template as<T>(); }
+
+    ArduinoJsonHost::Variant *getData() const { return _data; }
+    ArduinoJsonHost::Variant *getOrAddData() const { return _data; }
+    ArduinoJsonHost::Pool *getPool() const { return _pool; }
+
+private:
+    ArduinoJsonHost::Variant *_data = nullptr;
+    ArduinoJsonHost::Pool *_pool = nullptr;
+};
+
+class JsonObject : public VariantApi<JsonObject>
+{
+public:
+    JsonObject() {}
+    JsonObject(ArduinoJsonHost::Variant *data, ArduinoJsonHost::Pool *pool)
+        : _data(data && data->type == ArduinoJsonHost::TYPE_OBJECT ? data : nullptr), _pool(pool) {}
+
+    ArduinoJsonHost::Variant *getData() const { return _data; }
+    ArduinoJsonHost::Variant *getOrAddData() const { return _data; }
+    ArduinoJsonHost::Pool *getPool() const { return _pool; }
+
+private:
+    ArduinoJsonHost::Variant *_data = nullptr;
+    ArduinoJsonHost::Pool *_pool = nullptr;
+};
+
+class JsonArray : public VariantApi<JsonArray>
+{
+public:
+    JsonArray() {}
+    JsonArray(ArduinoJsonHost::Variant *data, ArduinoJsonHost::Pool *pool)
+        : _data(data && data->type == ArduinoJsonHost::TYPE_ARRAY ? data : nullptr), _pool(pool) {}
+
+    ArduinoJsonHost::Variant *getData() const { return _data; }
+    ArduinoJsonHost::Variant *getOrAddData() const { return _data; }
+    ArduinoJsonHost::Pool *getPool() const { return _pool; }
+
+private:
+    ArduinoJsonHost::Variant *_data = nullptr;
+    ArduinoJsonHost::Pool *_pool = nullptr;
+};
+
+namespace ArduinoJsonHost {
+
+template <>
+struct Converter<JsonObject> {
+    static JsonObject fromJson(const Variant *) { return JsonObject(); } // Use as() through a document
+    static bool checkJson(const Variant *v) { return v && v->type == TYPE_OBJECT; }
+};
+
+template <>
+struct Converter<JsonArray> {
+    static JsonArray fromJson(const Variant *) { return JsonArray(); }
+    static bool checkJson(const Variant *v) { return v && v->type == TYPE_ARRAY; }
+};
+
+} // namespace ArduinoJsonHost
+
+class JsonDocument : public VariantApi<JsonDocument>
+{
+public:
+    JsonDocument(const JsonDocument &) = delete;
+    JsonDocument &operator=(const JsonDocument &) = delete;
+
+    void clear()
+    {
+        _pool.clear();
+        _root = ArduinoJsonHost::Variant();
+    }
+
+    size_t capacity() const { return _pool.capacity(); }
+    size_t memoryUsage() const { return _pool.size(); }
+    bool overflowed() const { return _pool.overflowed(); }
+
+    // Empties the document and makes the root an object or an array
+    template <typename T>
+    T to()
+    {
+        clear();
+        _root.type = std::is_same<T, JsonArray>::value ? ArduinoJsonHost::TYPE_ARRAY : ArduinoJsonHost::TYPE_OBJECT;
+        _root.head = nullptr;
+        return T(&_root, &_pool);
+    }
+
+    JsonObject asObject() const { return JsonObject(&_root, &_pool); }
+    JsonVariant asVariant() const { return JsonVariant(&_root, &_pool); }
+
+    ArduinoJsonHost::Variant *getData() const { return &_root; }
+    ArduinoJsonHost::Variant *getOrAddData() const { return &_root; }
+    ArduinoJsonHost::Pool *getPool() const { return &_pool; }
+
+protected:
+    JsonDocument(char *buffer, size_t capacity) : _pool(buffer, capacity) {}
+
+private:
+    mutable ArduinoJsonHost::Variant _root;
+    mutable ArduinoJsonHost::Pool _pool;
+};
+
+template <size_t Capacity>
+class StaticJsonDocument : public JsonDocument
+{
+public:
+    StaticJsonDocument() : JsonDocument(_buffer, Capacity) {}
+
+private:
+    alignas(ArduinoJsonHost::Slot) char _buffer[Capacity];
+};
+
+template <typename TDerived>
+MemberProxy<typename ArduinoJsonHost::Upstream<TDerived>::type> VariantApi<TDerived>::operator[](const char *key) const
+{
+    return MemberProxy<typename ArduinoJsonHost::Upstream<TDerived>::type>(derived(), key);
+}
+
+template <typename TDerived>
+MemberProxy<typename ArduinoJsonHost::Upstream<TDerived>::type> VariantApi<TDerived>::operator[](const String &key) const
+{
+    return MemberProxy<typename ArduinoJsonHost::Upstream<TDerived>::type>(derived(), key.c_str());
+}
+
+template <typename TDerived>
+JsonArray VariantApi<TDerived>::createNestedArray() const
+{
+    ArduinoJsonHost::Pool *pool = derived().getPool();
+    ArduinoJsonHost::Variant *element = ArduinoJsonHost::addElement(derived().getOrAddData(), pool);
+    if (!element) return JsonArray();
+    element->type = ArduinoJsonHost::TYPE_ARRAY;
+    element->head = nullptr;
+    return JsonArray(element, pool);
+}
+
+template <typename TDerived>
+JsonObject VariantApi<TDerived>::createNestedObject() const
+{
+    ArduinoJsonHost::Pool *pool = derived().getPool();
+    ArduinoJsonHost::Variant *element = ArduinoJsonHost::addElement(derived().getOrAddData(), pool);
+    if (!element) return JsonObject();
+    element->type = ArduinoJsonHost::TYPE_OBJECT;
+    element->head = nullptr;
+    return JsonObject(element, pool);
+}
+
+template <typename TDerived>
+JsonArray VariantApi<TDerived>::createNestedArray(const char *key) const
+{
+    ArduinoJsonHost::Pool *pool = derived().getPool();
+    ArduinoJsonHost::Variant *member = ArduinoJsonHost::getOrAddMember(derived().getOrAddData(), key, pool);
+    if (!member) return JsonArray();
+    member->type = ArduinoJsonHost::TYPE_ARRAY;
+    member->head = nullptr;
+    return JsonArray(member, pool);
+}
+
+template <typename TDerived>
+JsonObject VariantApi<TDerived>::createNestedObject(const char *key) const
+{
+    ArduinoJsonHost::Pool *pool = derived().getPool();
+    ArduinoJsonHost::Variant *member = ArduinoJsonHost::getOrAddMember(derived().getOrAddData(), key, pool);
+    if (!member) return JsonObject();
+    member->type = ArduinoJsonHost::TYPE_OBJECT;
+    member->head = nullptr;
+    return JsonObject(member, pool);
+}
+
+// --- Deserialization ---
+
+class DeserializationError
+{
+public:
+    enum Code {
+        Ok,
+        EmptyInput,
+        IncompleteInput,
+        InvalidInput,
+        NoMemory,
+        TooDeep
+    };
+
+    DeserializationError() {}
+    DeserializationError(Code code) : _code(code) {}
+
+    friend bool operator==(const DeserializationError &left, Code right) { return left._code == right; }
+    friend bool operator!=(const DeserializationError &left, Code right) { return left._code != right; }
+
+    explicit operator bool() const { return _code != Ok; }
+    Code code() const { return _code; }
+
+    const char *c_str() const
+    {
+        static const char *const names[] = {"Ok", "EmptyInput", "IncompleteInput", "InvalidInput", "NoMemory", "TooDeep"};
+        return names[_code];
+    }
+    const char *f_str() const { return c_str(); }
+
+private:
+    Code _code = Ok;
+};
+
+namespace ArduinoJsonHost {
+
+// Input in memory. With a writable buffer the strings are decoded in place.
+class MemoryReader
+{
+public:
+    MemoryReader(const char *begin, const char *end, char *writable) : _p(begin), _end(end), _writable(writable) {}
+    int peek() const { return _p < _end && *_p ? (uint8_t)*_p : -1; }
+    int read() { return _p < _end && *_p ? (uint8_t)*_p++ : -1; }
+    bool inPlace() const { return _writable != nullptr; }
+    char *position() { return _writable + (_p - (const char *)_writable); }
+
+private:
+    const char *_p;
+    const char *_end;
+    char *_writable;
+};
+
+class StreamReader
+{
+public:
+    explicit StreamReader(Stream &stream) : _stream(stream) {}
+    int peek()
+    {
+        if (_next == -2) _next = _stream.read();
+        return _next;
+    }
+    int read()
+    {
+        int c = peek();
+        _next = -2;
+        return c;
+    }
+    bool inPlace() const { return false; }
+    char *position() { return nullptr; }
+
+private:
+    Stream &_stream;
+    int _next = -2; // -2: nothing read ahead
+};
+
+template <typename TReader>
+class Parser
+{
+public:
+    Parser(TReader &reader, Pool &pool) : _reader(reader), _pool(pool) {}
+
+    DeserializationError::Code parse(Variant &root)
+    {
+        skipSpaces();
+        if (_reader.peek() < 0) return DeserializationError::EmptyInput;
+        return parseValue(root, ARDUINOJSON_DEFAULT_NESTING_LIMIT);
+    }
+
+private:
+    TReader &_reader;
+    Pool &_pool;
+
+    void skipSpaces()
+    {
+        int c;
+        while ((c = _reader.peek()) == ' ' || c == '\t' || c == '\r' || c == '\n') _reader.read();
+    }
+
+    DeserializationError::Code parseValue(Variant &value, uint8_t depth)
+    {
+        skipSpaces();
+        int c = _reader.peek();
+        if (c < 0) return DeserializationError::IncompleteInput;
+        if (c == '{') return depth == 0 ? DeserializationError::TooDeep : parseObject(value, depth - 1);
+        if (c == '[') return depth == 0 ? DeserializationError::TooDeep : parseArray(value, depth - 1);
+        if (c == '"' || c == '\'')
+        {
+            const char *text;
+            DeserializationError::Code code = parseString(text);
+            if (code != DeserializationError::Ok) return code;
+            value.type = TYPE_STRING;
+            value.string = text;
+            return DeserializationError::Ok;
+        }
+        if (c == '-' || (c >= '0' && c <= '9')) return parseNumber(value);
+        if (c == 't') return parseLiteral("true", value, TYPE_BOOL, true);
+        if (c == 'f') return parseLiteral("false", value, TYPE_BOOL, false);
+        if (c == 'n') return parseLiteral("null", value, TYPE_NULL, false);
+        return DeserializationError::InvalidInput;
+    }
+
+    DeserializationError::Code parseLiteral(const char *literal, Variant &value, Type type, bool boolean)
+    {
+        for (const char *p = literal; *p; p++)
+        {
+            int c = _reader.read();
+            if (c < 0) return DeserializationError::IncompleteInput;
+            if (c != *p) return DeserializationError::InvalidInput;
+        }
+        value.type = type;
+        value.boolean = boolean;
+        return DeserializationError::Ok;
+    }
+
+    DeserializationError::Code parseNumber(Variant &value)
+    {
+        char text[64];
+        size_t length = 0;
+        bool isFloat = false;
+        int c;
+        while ((c = _reader.peek()) >= 0 && strchr("+-0123456789.eE", c))
+        {
+            if (length + 1 >= sizeof(text)) return DeserializationError::InvalidInput;
+            if (c == '.' || c == 'e' || c == 'E') isFloat = true;
+            text[length++] = (char)_reader.read();
+        }
+        text[length] = 0;
+
+        char *end;
+        if (!isFloat)
+        {
+            errno = 0;
+            long long integer = strtoll(text, &end, 10);
+            if (*end == 0 && end != text && errno != ERANGE)
+            {
+                value.type = TYPE_INTEGER;
+                value.integer = integer;
+                return DeserializationError::Ok;
+            }
+        }
+        double number = strtod(text, &end);
+        if (*end != 0 || end == text) return DeserializationError::InvalidInput;
+        value.type = TYPE_FLOAT;
+        value.number = number;
+        return DeserializationError::Ok;
+    }
+
+    static void appendUtf8(char *out, size_t &length, uint32_t codepoint)
+    {
+        if (codepoint < 0x80)
+        {
+            out[length++] = (char)codepoint;
+        }
+        else if (codepoint < 0x800)
+        {
+            out[length++] = (char)(0xC0 | (codepoint >> 6));
+            out[length++] = (char)(0x80 | (codepoint & 0x3F));
+        }
+        else if (codepoint < 0x10000)
+        {
+            out[length++] = (char)(0xE0 | (codepoint >> 12));
+            out[length++] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+            out[length++] = (char)(0x80 | (codepoint & 0x3F));
+        }
+        else
+        {
+            out[length++] = (char)(0xF0 | (codepoint >> 18));
+            out[length++] = (char)(0x80 | ((codepoint >> 12) & 0x3F));
+            out[length++] = (char)(0x80 | ((codepoint >> 6) & 0x3F));
+            out[length++] = (char)(0x80 | (codepoint & 0x3F));
+        }
+    }
+
+    DeserializationError::Code readHex(uint32_t &value)
+    {
+        value = 0;
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            int c = _reader.read();
+            if (c < 0) return DeserializationError::IncompleteInput;
+            if (c >= '0' && c <= '9') value = value * 16 + (c - '0');
+            else if (c >= 'a' && c <= 'f') value = value * 16 + (c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') value = value * 16 + (c - 'A' + 10);
+            else return DeserializationError::InvalidInput;
+        }
+        return DeserializationError::Ok;
+    }
+
+    // Decoded in place (zero-copy) or into the pool. An escaped character is never longer
+    // decoded than in the input, so the in-place output never overtakes the reader.
+    DeserializationError::Code parseString(const char *&text)
+    {
+        int quote = _reader.read();
+        char *out = _reader.inPlace() ? _reader.position() : _pool.builderStart();
+        size_t room = _reader.inPlace() ? SIZE_MAX : _pool.builderRoom();
+        size_t length = 0;
+
+        while (true)
+        {
+            int c = _reader.read();
+            if (c < 0) return DeserializationError::IncompleteInput;
+            if (c == quote) break;
+            if (length + 4 >= room)
+            {
+                _pool.overflow();
+                return DeserializationError::NoMemory;
+            }
+            if (c != '\\')
+            {
+                out[length++] = (char)c;
+                continue;
+            }
+
+            c = _reader.read();
+            switch (c)
+            {
+            case -1: return DeserializationError::IncompleteInput;
+            case 'b': out[length++] = '\b'; break;
+            case 'f': out[length++] = '\f'; break;
+            case 'n': out[length++] = '\n'; break;
+            case 'r': out[length++] = '\r'; break;
+            case 't': out[length++] = '\t'; break;
+            case 'u':
+            {
+                uint32_t codepoint;
+                DeserializationError::Code code = readHex(codepoint);
+                if (code != DeserializationError::Ok) return code;
+                if (codepoint >= 0xD800 && codepoint < 0xDC00) // Surrogate pair
+                {
+                    uint32_t low;
+                    if (_reader.read() != '\\' || _reader.read() != 'u') return DeserializationError::InvalidInput;
+                    code = readHex(low);
+                    if (code != DeserializationError::Ok) return code;
+                    codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(out, length, codepoint);
+                break;
+            }
+            default: out[length++] = (char)c; break; // \" \\ \/
+            }
+        }
+
+        if (_reader.inPlace())
+        {
+            out[length] = 0; // At or before the closing quote
+            text = out;
+            return DeserializationError::Ok;
+        }
+        text = _pool.save(length);
+        return text ? DeserializationError::Ok : DeserializationError::NoMemory;
+    }
+
+    DeserializationError::Code parseObject(Variant &object, uint8_t depth)
+    {
+        _reader.read(); // {
+        object.type = TYPE_OBJECT;
+        object.head = nullptr;
+        skipSpaces();
+        if (_reader.peek() == '}')
+        {
+            _reader.read();
+            return DeserializationError::Ok;
+        }
+
+        while (true)
+        {
+            skipSpaces();
+            int c = _reader.peek();
+            if (c < 0) return DeserializationError::IncompleteInput;
+            if (c != '"' && c != '\'') return DeserializationError::InvalidInput;
+            const char *key;
+            DeserializationError::Code code = parseString(key);
+            if (code != DeserializationError::Ok) return code;
+
+            skipSpaces();
+            c = _reader.read();
+            if (c < 0) return DeserializationError::IncompleteInput;
+            if (c != ':') return DeserializationError::InvalidInput;
+
+            // A repeated key replaces the earlier value
+            Slot *slot = findMember(&object, key);
+            if (!slot)
+            {
+                slot = appendSlot(&object, &_pool);
+                if (!slot) return DeserializationError::NoMemory;
+                slot->key = key;
+            }
+            slot->value = Variant();
+            code = parseValue(slot->value, depth);
+            if (code != DeserializationError::Ok) return code;
+
+            skipSpaces();
+            c = _reader.read();
+            if (c < 0) return DeserializationError::IncompleteInput;
+            if (c == '}') return DeserializationError::Ok;
+            if (c != ',') return DeserializationError::InvalidInput;
+        }
+    }
+
+    DeserializationError::Code parseArray(Variant &array, uint8_t depth)
+    {
+        _reader.read(); // [
+        array.type = TYPE_ARRAY;
+        array.head = nullptr;
+        skipSpaces();
+        if (_reader.peek() == ']')
+        {
+            _reader.read();
+            return DeserializationError::Ok;
+        }
+
+        while (true)
+        {
+            Slot *slot = appendSlot(&array, &_pool);
+            if (!slot) return DeserializationError::NoMemory;
+            DeserializationError::Code code = parseValue(slot->value, depth);
+            if (code != DeserializationError::Ok) return code;
+
+            skipSpaces();
+            int c = _reader.read();
+            if (c < 0) return DeserializationError::IncompleteInput;
+            if (c == ']') return DeserializationError::Ok;
+            if (c != ',') return DeserializationError::InvalidInput;
+        }
+    }
+};
+
+template <typename TReader>
+inline DeserializationError deserialize(JsonDocument &doc, TReader &reader)
+{
+    doc.clear();
+    Parser<TReader> parser(reader, *doc.getPool());
+    DeserializationError::Code code = parser.parse(*doc.getData());
+    if (code != DeserializationError::Ok) doc.clear();
+    return DeserializationError(code);
+}
+
+} // namespace ArduinoJsonHost
+
+// Zero-copy: the strings of the document point into input
+inline DeserializationError deserializeJson(JsonDocument &doc, char *input, size_t size)
+{
+    ArduinoJsonHost::MemoryReader reader(input, input + size, input);
+    return ArduinoJsonHost::deserialize(doc, reader);
+}
+
+inline DeserializationError deserializeJson(JsonDocument &doc, char *input)
+{
+    return deserializeJson(doc, input, strlen(input));
+}
+
+inline DeserializationError deserializeJson(JsonDocument &doc, const char *input, size_t size)
+{
+    ArduinoJsonHost::MemoryReader reader(input, input + size, nullptr);
+    return ArduinoJsonHost::deserialize(doc, reader);
+}
+
+inline DeserializationError deserializeJson(JsonDocument &doc, const char *input)
+{
+    return deserializeJson(doc, input, strlen(input));
+}
+
+inline DeserializationError deserializeJson(JsonDocument &doc, const String &input)
+{
+    return deserializeJson(doc, input.c_str(), input.length());
+}
+
+inline DeserializationError deserializeJson(JsonDocument &doc, Stream &input)
+{
+    ArduinoJsonHost::StreamReader reader(input);
+    return ArduinoJsonHost::deserialize(doc, reader);
+}
+
+// --- Serialization ---
+
+namespace ArduinoJsonHost {
+
+class PrintWriter
+{
+public:
+    explicit PrintWriter(Print &out) : _out(out) {}
+    void write(const char *text, size_t length) { count += _out.write((const uint8_t *)text, length); }
+    size_t count = 0;
+
+private:
+    Print &_out;
+};
+
+// Writes what fits, always terminated
+class BufferWriter
+{
+public:
+    BufferWriter(char *buffer, size_t capacity) : _buffer(buffer), _capacity(capacity) {}
+    void write(const char *text, size_t length)
+    {
+        if (_capacity == 0) return;
+        size_t room = _capacity - 1 - count;
+        if (length > room) length = room;
+        memcpy(_buffer + count, text, length);
+        count += length;
+        _buffer[count] = 0;
+    }
+    size_t count = 0;
+
+private:
+    char *_buffer;
+    size_t _capacity;
+};
+
+class CountingWriter
+{
+public:
+    void write(const char *, size_t length) { count += length; }
+    size_t count = 0;
+};
+
+class StringWriter
+{
+public:
+    explicit StringWriter(String &out) : _out(out) {}
+    void write(const char *text, size_t length)
+    {
+        for (size_t i = 0; i < length; i++) _out += text[i];
+        count += length;
+    }
+    size_t count = 0;
+
+private:
+    String &_out;
+};
+
+template <typename TWriter>
+inline void writeString(TWriter &writer, const char *text)
+{
+    writer.write("\"", 1);
+    const char *run = text;
+    for (const char *p = text; *p; p++)
+    {
+        char escape = 0;
+        switch (*p)
+        {
+        case '"': escape = '"'; break;
+        case '\\': escape = '\\'; break;
+        case '\b': escape = 'b'; break;
+        case '\f': escape = 'f'; break;
+        case '\n': escape = 'n'; break;
+        case '\r': escape = 'r'; break;
+        case '\t': escape = 't'; break;
+        default:
+            if ((uint8_t)*p >= 0x20) continue;
+            break;
+        }
+        writer.write(run, p - run);
+        char sequence[8];
+        if (escape)
+        {
+            sequence[0] = '\\';
+            sequence[1] = escape;
+            writer.write(sequence, 2);
+        }
+        else
+        {
+            snprintf(sequence, sizeof(sequence), "\\u%04x", (uint8_t)*p);
+            writer.write(sequence, 6);
+        }
+        run = p + 1;
+    }
+    writer.write(run, strlen(run));
+    writer.write("\"", 1);
+}
+
+template <typename TWriter>
+inline void writeValue(TWriter &writer, const Variant *value)
+{
+    char text[32];
+    int length;
+    if (!value)
+    {
+        writer.write("null", 4);
+        return;
+    }
+    switch (value->type)
+    {
+    case TYPE_NULL:
+        writer.write("null", 4);
+        break;
+    case TYPE_BOOL:
+        if (value->boolean) writer.write("true", 4);
+        else writer.write("false", 5);
+        break;
+    case TYPE_INTEGER:
+        length = snprintf(text, sizeof(text), "%lld", (long long)value->integer);
+        writer.write(text, length);
+        break;
+    case TYPE_FLOAT:
+        if (isnan(value->number) || isinf(value->number))
+        {
+            writer.write("null", 4);
+            break;
+        }
+        length = snprintf(text, sizeof(text), "%.9g", value->number);
+        writer.write(text, length);
+        break;
+    case TYPE_STRING:
+        writeString(writer, value->string);
+        break;
+    case TYPE_ARRAY:
+    case TYPE_OBJECT:
+    {
+        bool object = value->type == TYPE_OBJECT;
+        writer.write(object ? "{" : "[", 1);
+        for (const Slot *slot = value->head; slot; slot = slot->next)
+        {
+            if (slot != value->head) writer.write(",", 1);
+            if (object)
+            {
+                writeString(writer, slot->key);
+                writer.write(":", 1);
+            }
+            writeValue(writer, &slot->value);
+        }
+        writer.write(object ? "}" : "]", 1);
+        break;
+    }
+    }
+}
+
+} // namespace ArduinoJsonHost
+
+template <typename TSource>
+inline size_t serializeJson(const TSource &source, Print &out)
+{
+    ArduinoJsonHost::PrintWriter writer(out);
+    ArduinoJsonHost::writeValue(writer, source.getData());
+    return writer.count;
+}
+
+template <typename TSource>
+inline size_t serializeJson(const TSource &source, char *buffer, size_t capacity)
+{
+    ArduinoJsonHost::BufferWriter writer(buffer, capacity);
+    ArduinoJsonHost::writeValue(writer, source.getData());
+    return writer.count;
+}
+
+template <typename TSource>
+inline size_t serializeJson(const TSource &source, String &out)
+{
+    out = "";
+    ArduinoJsonHost::StringWriter writer(out);
+    ArduinoJsonHost::writeValue(writer, source.getData());
+    return writer.count;
+}
+
+template <typename TSource>
+inline size_t measureJson(const TSource &source)
+{
+    ArduinoJsonHost::CountingWriter writer;
+    ArduinoJsonHost::writeValue(writer, source.getData());
+    return writer.count;
+}
+
+#endif
@@ -0,0 +1,246 @@
+// Debounced writes and file format of ConfigStore, against the in-memory FS of the shims and on
+// simulated time. Each case starts from an empty file system.
+//
+//   build/test_config_store
+//
+// Exits with 1 when a case fails.
+
+#include <Arduino.h>
+#include <FS.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "../../src/submodules/Hal/HalClock.h"
+#include "../../src/submodules/ConfigStore/ConfigStore.h"
+
+#define TestConfigStore_LOOP_MILLIS 10 // WebServer::loop() period of the sketch
+
+static SimulatedClock testClock;
+
+// Runs the store's loop() for the given time
+static void runFor(ConfigStore &store, uint32_t millis)
+{
+    for (uint32_t elapsed = 0; elapsed < millis; elapsed += TestConfigStore_LOOP_MILLIS)
+    {
+        store.loop();
+        testClock.advance(TestConfigStore_LOOP_MILLIS * 1000);
+    }
+}
+
+static ConfigData defaults()
+{
+    ConfigData data = {};
+    data.masterMovementSpeed = 100;
+    strcpy(data.robotName, "Huyang");
+    return data;
+}
+
+// Whole content of a file, empty if it does not exist
+static std::string readFile(FS &fs, const char *path)
+{
+    std::string content;
+    File file = fs.open(path, "r");
+    if (!file) return content;
+    int c;
+    while ((c = file.read()) >= 0) content += (char)c;
+    file.close();
+    return content;
+}
+
+static void writeFile(FS &fs, const char *path, const std::string &content)
+{
+    File file = fs.open(path, "w");
+    file.write((const uint8_t *)content.data(), content.size());
+    file.close();
+}
+
+// Reference CRC32 (IEEE 802.3), independent of the one in ConfigStore
+static uint32_t referenceCrc32(const uint8_t *data, size_t length)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+    }
+    return ~crc;
+}
+
+static bool fail(const char *test, const char *message)
+{
+    printf("FAILED: %s: %s\n", test, message);
+    return false;
+}
+
+// A slider sends 50 values 40 ms apart, they settle into a single write
+static bool testSliderBurst()
+{
+    const char *test = "slider burst";
+    FS fs;
+    ConfigStore store;
+    store.begin(fs);
+    ConfigData data = defaults();
+
+    for (int16_t value = 0; value < 50; value++)
+    {
+        data.neckRotation = value;
+        store.update(data);
+        runFor(store, 40);
+    }
+    if (store.writes != 0) return fail(test, "written while the slider was still moving");
+    runFor(store, ConfigStore_FLUSH_DELAY + 100);
+
+    if (store.updates != 50) return fail(test, "not every changed snapshot was counted");
+    if (store.writes != 1) return fail(test, "the burst did not end in exactly one write");
+    if (store.dirty()) return fail(test, "still dirty after the write");
+
+    // The file round-trips the last value
+    ConfigStore reloaded;
+    reloaded.begin(fs);
+    ConfigData loaded = {};
+    if (!reloaded.load(loaded)) return fail(test, "the written file does not load");
+    if (memcmp(&loaded, &data, sizeof(data)) != 0) return fail(test, "the loaded values differ from the written ones");
+    return true;
+}
+
+// Changes that never settle are still written every ConfigStore_MAX_DELAY, 12 s of them twice
+static bool testContinuousChanges()
+{
+    const char *test = "continuous changes";
+    FS fs;
+    ConfigStore store;
+    store.begin(fs);
+    ConfigData data = defaults();
+
+    for (int16_t value = 0; value < 120; value++)
+    {
+        data.bodyRotation = value;
+        store.update(data);
+        runFor(store, 100);
+    }
+    if (store.writes != 1) return fail(test, "not written once after ConfigStore_MAX_DELAY");
+    runFor(store, ConfigStore_FLUSH_DELAY + 100);
+
+    if (store.writes != 2) return fail(test, "12 s of changes did not end in exactly two writes");
+    if (store.dirty()) return fail(test, "still dirty after the last write");
+
+    // Identical snapshots are ignored
+    store.update(data);
+    if (store.dirty() || store.updates != 120) return fail(test, "an unchanged snapshot marked the store dirty");
+    return true;
+}
+
+// A write whose rename fails keeps the old file and is retried
+static bool testFailedRename()
+{
+    const char *test = "failed rename";
+    FS fs;
+    ConfigStore store;
+    store.begin(fs);
+    ConfigData data = defaults();
+    data.monoclePosition = 10;
+    store.update(data);
+    if (!store.flush()) return fail(test, "the first write failed");
+    std::string previous = readFile(fs, ConfigStore_FILE);
+
+    fs.failRenames = true;
+    data.monoclePosition = 20;
+    store.update(data);
+    runFor(store, ConfigStore_FLUSH_DELAY + 100);
+    if (store.writes != 1) return fail(test, "a failed write was counted");
+    if (!store.dirty()) return fail(test, "the store is clean although nothing was written");
+    if (readFile(fs, ConfigStore_FILE) != previous) return fail(test, "the previous file was changed");
+
+    fs.failRenames = false;
+    runFor(store, ConfigStore_FLUSH_DELAY + 100);
+    if (store.writes != 2 || store.dirty()) return fail(test, "the write was not retried");
+
+    ConfigStore reloaded;
+    reloaded.begin(fs);
+    ConfigData loaded = {};
+    if (!reloaded.load(loaded) || loaded.monoclePosition != 20) return fail(test, "the retried write did not store the new value");
+    return true;
+}
+
+// A file whose payload does not match its CRC is ignored and leaves the values alone
+static bool testCorruptCrc()
+{
+    const char *test = "corrupt CRC";
+    FS fs;
+    ConfigStore store;
+    store.begin(fs);
+    ConfigData data = defaults();
+    data.neckTiltForward = 42;
+    store.update(data);
+    store.flush();
+
+    std::string content = readFile(fs, ConfigStore_FILE);
+    content[content.size() - 1] ^= 0x01;
+    writeFile(fs, ConfigStore_FILE, content);
+
+    ConfigStore reloaded;
+    reloaded.begin(fs);
+    ConfigData loaded = defaults();
+    if (reloaded.load(loaded)) return fail(test, "a damaged file was accepted");
+    if (loaded.neckTiltForward != 0) return fail(test, "a damaged file changed the values");
+    return true;
+}
+
+// A file of an older version holds a prefix of ConfigData, the fields appended since keep their defaults
+static bool testOlderVersion()
+{
+    const char *test = "older version";
+    FS fs;
+
+    ConfigData stored = {};
+    stored.neckRotation = -15;
+    stored.neckTiltForward = 7;
+    stored.neckTiltSideways = 3;
+    stored.bodyRotation = 12;
+    stored.bodyTiltForward = -4;
+    stored.bodyTiltSideways = 5;
+    stored.monoclePosition = 30;
+    uint16_t length = offsetof(ConfigData, masterMovementSpeed);
+
+    // Same header layout as ConfigStore::Header: magic, version, length, CRC32
+    uint32_t magic = ConfigStore_MAGIC;
+    uint16_t version = 0;
+    uint32_t crc = referenceCrc32((const uint8_t *)&stored, length);
+    std::string content;
+    content.append((const char *)&magic, sizeof(magic));
+    content.append((const char *)&version, sizeof(version));
+    content.append((const char *)&length, sizeof(length));
+    content.append((const char *)&crc, sizeof(crc));
+    content.append((const char *)&stored, length);
+    writeFile(fs, ConfigStore_FILE, content);
+
+    ConfigStore store;
+    store.begin(fs);
+    ConfigData loaded = defaults();
+    if (!store.load(loaded)) return fail(test, "the older file was rejected");
+    if (memcmp(&loaded, &stored, length) != 0) return fail(test, "the stored prefix was not loaded");
+    if (loaded.masterMovementSpeed != 100 || strcmp(loaded.robotName, "Huyang") != 0)
+        return fail(test, "the fields missing in the file lost their defaults");
+    if (store.dirty()) return fail(test, "loading marked the store dirty");
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        fprintf(stderr, "Usage: %s\n", argv[0]);
+        return strcmp(argv[1], "--help") == 0 ? 0 : 2;
+    }
+
+    halUseClock(&testClock);
+
+    bool (*const tests[])() = {testSliderBurst, testContinuousChanges, testFailedRename, testCorruptCrc, testOlderVersion};
+    for (bool (*test)() : tests)
+    {
+        if (!test()) return 1;
+    }
+
+    printf("ConfigStore: %u cases passed\n", (unsigned)(sizeof(tests) / sizeof(tests[0])));
+    return 0;
+}
@@ -0,0 +1,130 @@
+// Accuracy of the fixed point ease of EasingServo against the double implementation it replaced.
+// Random moves are eased on simulated time, every millisecond the pulse written to the PCA9685 is
+// compared with the pulse the old easeInAndOut() and map() would have computed.
+//
+//   build/test_easing [--seed n] [--moves n]
+//
+// Exits with 1 when a pulse is further than TestEasing_MAX_ERROR ticks from the reference.
+
+#include <Arduino.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../src/submodules/Hal/HalClock.h"
+#include "../../src/submodules/Hal/PwmOutput.h"
+#include "../../src/classes/ServoFrame/ServoFrame.h"
+#include "../../src/classes/EasingServo/EasingServo.h"
+#include "../../src/classes/HuyangNeck/HuyangNeck.h" // SERVOMIN / SERVOMAX
+
+#define TestEasing_MAX_ERROR 0.67     // PCA9685 ticks: rounding to a whole tick plus the lookup table
+#define TestEasing_MAX_DURATION 3000  // Longest random move in ms
+
+// --- Reference: EasingServo before the fixed point version ---
+
+static double easeInOutQuad(double t)
+{
+    return t < 0.5 ? 2 * t * t : t * (4 - 2 * t) - 1;
+}
+
+static double easeInAndOut(double start, double current, double target, double percentage)
+{
+    double result = target;
+    if (percentage > 1.0) percentage = 1.0;
+
+    if (current != target)
+    {
+        double easeInOut = easeInOutQuad(percentage);
+        if (current < target)
+        {
+            result = start + (target - start) * easeInOut;
+            if (result > target) result = target;
+        }
+        else if (current > target)
+        {
+            result = start - (start - target) * easeInOut;
+            if (result < target) result = target;
+        }
+    }
+    return result;
+}
+
+// map(degree, 0, 180, SERVOMIN, SERVOMAX) without its integer math. map() truncated the degree
+// first, up to 2.5 ticks off, which the fixed point version fixed on purpose.
+static double pulseForDegree(double degree)
+{
+    return HuyangNeck_SERVOMIN + degree * (HuyangNeck_SERVOMAX - HuyangNeck_SERVOMIN) / 180.0;
+}
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "Usage: %s [--seed n] [--moves n]\n", program);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t seed = 1;
+    uint32_t moves = 2000;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) seed = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--moves") == 0 && i + 1 < argc) moves = strtoul(argv[++i], nullptr, 10);
+        else
+        {
+            usage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 2;
+        }
+    }
+
+    SimulatedClock clock;
+    SeededRandom random(seed);
+    halUseClock(&clock);
+
+    RecordingPwmOutput pwm;
+    pwm.recording = false;
+    ServoFrame frame(&pwm);
+    EasingServo servo(&frame, 0, 0, 180, 90);
+
+    uint32_t samples = 0;
+    double maxError = 0;
+    double sumError = 0;
+    for (uint32_t move = 0; move < moves; move++)
+    {
+        double target = random.random(0, 18001) / 100.0;
+        uint32_t duration = random.random(1, TestEasing_MAX_DURATION + 1);
+        double start = servo.currentDegree();
+        if (EasingServo::degreeToTicks(target) == EasingServo::degreeToTicks(start)) continue;
+
+        servo.moveServoTo(target, duration);
+        double current = start;
+        for (uint32_t elapsed = 0; elapsed <= duration; elapsed++)
+        {
+            servo.updatePosition();
+            frame.flush();
+
+            current = easeInAndOut(start, current, target, (double)elapsed / duration);
+            double error = fabs(pwm.off[0] - pulseForDegree(current));
+            sumError += error;
+            samples++;
+            if (error > maxError) maxError = error;
+            if (error > TestEasing_MAX_ERROR)
+            {
+                printf("FAILED: move %lu from %.2f to %.2f in %lu ms, at %lu ms the pulse is %u instead of %.3f\n",
+                       (unsigned long)move, start, target, (unsigned long)duration, (unsigned long)elapsed,
+                       (unsigned)pwm.off[0], pulseForDegree(current));
+                return 1;
+            }
+            clock.advance(1000);
+        }
+        if (servo.isMoving())
+        {
+            printf("FAILED: move %lu still running after its %lu ms\n", (unsigned long)move, (unsigned long)duration);
+            return 1;
+        }
+    }
+
+    printf("EasingServo ease: %lu samples, error avg %.3f max %.3f ticks (limit %.2f)\n",
+           (unsigned long)samples, samples ? sumError / samples : 0.0, maxError, TestEasing_MAX_ERROR);
+    return 0;
+}
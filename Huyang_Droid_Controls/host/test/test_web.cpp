@@ -0,0 +1,276 @@
+// Request handling of WebServer, driven through the ESPAsyncWebServer shim without a network.
+//
+//   build/test_web
+//
+// Exits with 1 when a case fails.
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <memory>
+#include <stdio.h>
+#include <string.h>
+#include "../../src/submodules/WebServer/WebServer.h"
+#include "../../src/submodules/Scheduler/Scheduler.h"
+#include "../../src/classes/ServoFrame/ServoFrame.h"
+#include "../../src/submodules/LoopMetrics/LoopMetrics.h"
+
+// Globals of the sketch that WebServer.cpp uses, see bench/bench_web.cpp
+class HuyangFace;
+class HuyangBody;
+class HuyangNeck;
+class HuyangAudio;
+HuyangFace *huyangFace = nullptr;
+HuyangBody *huyangBody = nullptr;
+HuyangNeck *huyangNeck = nullptr;
+HuyangAudio *huyangAudio = nullptr;
+ServoFrame *servoFrame = nullptr;
+Scheduler *scheduler = nullptr;
+LoopMetrics *loopMetrics = nullptr;
+
+#define TestWeb_CHUNK 16 // Bytes per chunk of the bodies assembled in the body pool
+
+static const char *const TestWeb_NECK = "{\"type\":\"neck\",\"rotate\":100,\"tiltForward\":-100,\"tiltSideways\":0}";
+static const char *const TestWeb_EYE = "{\"type\":\"eye\",\"target\":\"left\",\"state\":4}";
+
+// WebServer with all features enabled and the server it registered its routes with
+struct TestWeb {
+    WebServer web;
+    AsyncWebServer *server;
+
+    TestWeb() : web(80)
+    {
+        web.setup(true, true, true, true, true, true, true);
+        server = AsyncWebServer::last();
+    }
+
+    // Hands chunk number n of body to the route of request. ArduinoJson parses in place, so the
+    // chunks are copied like the network buffers AsyncTCP reuses.
+    void chunk(AsyncWebServerRequest &request, const char *body, size_t n)
+    {
+        uint8_t copy[TestWeb_CHUNK];
+        size_t total = strlen(body);
+        size_t index = n * TestWeb_CHUNK;
+        size_t length = min((size_t)TestWeb_CHUNK, total - index);
+        memcpy(copy, body + index, length);
+        server->receiveBody(&request, copy, length, index, total);
+    }
+
+    static size_t chunks(const char *body) { return (strlen(body) + TestWeb_CHUNK - 1) / TestWeb_CHUNK; }
+
+    // Delivers a whole body in chunks
+    void post(AsyncWebServerRequest &request, const char *body)
+    {
+        for (size_t n = 0; n < chunks(body); n++) chunk(request, body, n);
+    }
+
+    // GET /api/calibration, revalidating etag unless it is nullptr. Returns the response code and
+    // copies the ETag of the response into etag.
+    int getStatus(const char *ifNoneMatch, char *etag = nullptr)
+    {
+        AsyncWebServerRequest request(HTTP_GET, "/api/calibration");
+        if (ifNoneMatch) request.addHeader("If-None-Match", ifNoneMatch);
+        server->receive(&request);
+        if (etag) strcpy(etag, request.responseETag);
+        return request.responses == 1 ? request.responseCode : 0;
+    }
+};
+
+static void drainCommands()
+{
+    FaceCommand command;
+    while (faceCommands.pop(command)) {}
+    motionCommands.drain();
+}
+
+static bool fail(const char *test, const char *message)
+{
+    printf("FAILED: %s: %s\n", test, message);
+    return false;
+}
+
+// Two chunked bodies whose chunks alternate are assembled in separate slots
+static bool testInterleavedBodies()
+{
+    const char *test = "interleaved bodies";
+    TestWeb bench;
+    drainCommands();
+
+    AsyncWebServerRequest neck(HTTP_POST, "/api/action");
+    AsyncWebServerRequest eye(HTTP_POST, "/api/action");
+    size_t count = max(TestWeb::chunks(TestWeb_NECK), TestWeb::chunks(TestWeb_EYE));
+    for (size_t n = 0; n < count; n++)
+    {
+        if (n < TestWeb::chunks(TestWeb_NECK)) bench.chunk(neck, TestWeb_NECK, n);
+        if (n < TestWeb::chunks(TestWeb_EYE)) bench.chunk(eye, TestWeb_EYE, n);
+    }
+
+    if (neck.responseCode != 200 || neck.responses != 1) return fail(test, "the neck body was not answered once with 200");
+    if (eye.responseCode != 200 || eye.responses != 1) return fail(test, "the eye body was not answered once with 200");
+
+    uint16_t changed = motionCommands.drain();
+    if (!(changed & (1 << AXIS_NECK_ROTATE)) || motionCommands.target(AXIS_NECK_ROTATE) != 90 ||
+        motionCommands.target(AXIS_NECK_TILT_FORWARD) != -90)
+        return fail(test, "the neck body did not arrive intact");
+    FaceCommand command;
+    if (!faceCommands.pop(command) || command.target != FACE_LEFT || command.state != 4)
+        return fail(test, "the eye body did not arrive intact");
+    return true;
+}
+
+// With every slot assembling a body, a further chunked body is answered with 503, and the slot of
+// a completed body is free again
+static bool testPoolExhausted()
+{
+    const char *test = "pool exhausted";
+    TestWeb bench;
+    drainCommands();
+
+    std::unique_ptr<AsyncWebServerRequest> pending[WebServer_BODY_SLOTS];
+    for (std::unique_ptr<AsyncWebServerRequest> &request : pending)
+    {
+        request.reset(new AsyncWebServerRequest(HTTP_POST, "/api/action"));
+        bench.chunk(*request, TestWeb_NECK, 0);
+        if (request->responses != 0) return fail(test, "a body was answered before it was complete");
+    }
+
+    AsyncWebServerRequest rejected(HTTP_POST, "/api/action");
+    bench.post(rejected, TestWeb_NECK);
+    if (rejected.responseCode != 503 || rejected.responses != 1) return fail(test, "a body without a free slot was not answered once with 503");
+
+    for (size_t n = 1; n < TestWeb::chunks(TestWeb_NECK); n++) bench.chunk(*pending[0], TestWeb_NECK, n);
+    if (pending[0]->responseCode != 200) return fail(test, "a body holding a slot was not completed");
+
+    AsyncWebServerRequest next(HTTP_POST, "/api/action");
+    bench.post(next, TestWeb_EYE);
+    if (next.responseCode != 200) return fail(test, "the slot of a completed body was not released");
+    drainCommands();
+    return true;
+}
+
+// A body larger than WebServer_BODY_CAPACITY is answered with 413 once, and takes no slot
+static bool testTooLarge()
+{
+    const char *test = "body too large";
+    TestWeb bench;
+
+    static uint8_t body[WebServer_BODY_CAPACITY + 1];
+    memset(body, ' ', sizeof(body));
+    AsyncWebServerRequest large(HTTP_POST, "/api/action");
+    for (size_t index = 0; index < sizeof(body); index += 256)
+    {
+        bench.server->receiveBody(&large, body + index, min((size_t)256, sizeof(body) - index), index, sizeof(body));
+    }
+    if (large.responseCode != 413 || large.responses != 1) return fail(test, "not answered once with 413");
+
+    // Every slot is still free
+    std::unique_ptr<AsyncWebServerRequest> pending[WebServer_BODY_SLOTS];
+    for (std::unique_ptr<AsyncWebServerRequest> &request : pending)
+    {
+        request.reset(new AsyncWebServerRequest(HTTP_POST, "/api/action"));
+        bench.chunk(*request, TestWeb_NECK, 0);
+        if (request->responses != 0) return fail(test, "the rejected body kept a slot");
+    }
+    return true;
+}
+
+// A client that disconnects in the middle of its body releases the slot
+static bool testDisconnect()
+{
+    const char *test = "disconnect";
+    TestWeb bench;
+    drainCommands();
+
+    std::unique_ptr<AsyncWebServerRequest> gone[WebServer_BODY_SLOTS];
+    for (std::unique_ptr<AsyncWebServerRequest> &request : gone)
+    {
+        request.reset(new AsyncWebServerRequest(HTTP_POST, "/api/action"));
+        bench.chunk(*request, TestWeb_NECK, 0);
+        request->disconnect();
+    }
+
+    std::unique_ptr<AsyncWebServerRequest> next[WebServer_BODY_SLOTS];
+    for (std::unique_ptr<AsyncWebServerRequest> &request : next)
+    {
+        request.reset(new AsyncWebServerRequest(HTTP_POST, "/api/action"));
+        bench.chunk(*request, TestWeb_EYE, 0);
+    }
+    for (std::unique_ptr<AsyncWebServerRequest> &request : next)
+    {
+        for (size_t n = 1; n < TestWeb::chunks(TestWeb_EYE); n++) bench.chunk(*request, TestWeb_EYE, n);
+        if (request->responseCode != 200) return fail(test, "the slot of a disconnected client was not released");
+    }
+    for (std::unique_ptr<AsyncWebServerRequest> &request : gone)
+    {
+        if (request->responses != 0) return fail(test, "a disconnected client was answered");
+    }
+    drainCommands();
+    return true;
+}
+
+// The cached /api/calibration response is only rebuilt when one of its fields changed, and its ETag
+// changes with every rebuild
+static bool testStatusCache()
+{
+    const char *test = "status cache";
+    TestWeb bench;
+    char etag[40];
+    char previous[40];
+
+    if (bench.getStatus(nullptr, etag) != 200 || etag[0] == '\0') return fail(test, "GET /api/calibration was not answered with 200 and an ETag");
+    for (int i = 0; i < 10; i++) bench.getStatus(nullptr);
+    if (bench.web.statusBuilds != 1) return fail(test, "repeated requests rebuilt the unchanged response");
+
+    // The servo task publishes a new neck position
+    strcpy(previous, etag);
+    neckRotate += 5;
+    bench.getStatus(nullptr, etag);
+    if (bench.web.statusBuilds != 2 || strcmp(etag, previous) == 0) return fail(test, "a neck change kept the ETag");
+
+    strcpy(previous, etag);
+    String name = robotName;
+    robotName = "Huyang Test";
+    bench.getStatus(nullptr, etag);
+    robotName = name;
+    neckRotate -= 5;
+    if (bench.web.statusBuilds != 3 || strcmp(etag, previous) == 0) return fail(test, "a name change kept the ETag");
+    return true;
+}
+
+// A browser revalidating its copy gets 304 while nothing changed, and the new response afterwards
+static bool testStatusNotModified()
+{
+    const char *test = "status not modified";
+    TestWeb bench;
+    char etag[40];
+    char revalidated[40];
+
+    bench.getStatus(nullptr, etag);
+    if (bench.getStatus(etag, revalidated) != 304) return fail(test, "a matching If-None-Match was not answered with 304");
+    if (strcmp(etag, revalidated) != 0) return fail(test, "the 304 carries a different ETag");
+    if (bench.web.statusNotModified != 1 || bench.web.statusBuilds != 1) return fail(test, "the 304 was not counted or rebuilt the response");
+
+    monoclePosition += 10;
+    int code = bench.getStatus(etag, revalidated);
+    monoclePosition -= 10;
+    if (code != 200 || strcmp(etag, revalidated) == 0) return fail(test, "a stale If-None-Match was not answered with the new response");
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        fprintf(stderr, "Usage: %s\n", argv[0]);
+        return strcmp(argv[1], "--help") == 0 ? 0 : 2;
+    }
+
+    bool (*const tests[])() = {testInterleavedBodies, testPoolExhausted, testTooLarge, testDisconnect,
+                               testStatusCache, testStatusNotModified};
+    for (bool (*test)() : tests)
+    {
+        if (!test()) return 1;
+    }
+
+    printf("WebServer: %u cases passed\n", (unsigned)(sizeof(tests) / sizeof(tests[0])));
+    return 0;
+}
@@ -1,116 +1,297 @@
 #include "EasingServo.h" // In the same folder
 #include <Arduino.h>
-#include <Adafruit_PWMServoDriver.h>
 #include "../HuyangNeck/HuyangNeck.h" // NEW: Include HuyangNeck.h to get SERVOMIN/MAX definitions
 
-EasingServo::EasingServo(Adafruit_PWMServoDriver *pwm, uint8_t servo, double min, double max, double start)
+// Quadratic ease-in-out sampled at EasingServo_EASE_SEGMENTS + 1 points, in Q16.16.
+// Linear interpolation between the samples stays within 0.0002 of the exact curve.
+static const uint32_t EasingServo_easeInOutQuadTable[EasingServo_EASE_SEGMENTS + 1] = {
+    0, 32, 128, 288, 512, 800, 1152, 1568,
+    2048, 2592, 3200, 3872, 4608, 5408, 6272, 7200,
+    8192, 9248, 10368, 11552, 12800, 14112, 15488, 16928,
+    18432, 20000, 21632, 23328, 25088, 26912, 28800, 30752,
+    32768, 34784, 36736, 38624, 40448, 42208, 43904, 45536,
+    47104, 48608, 50048, 51424, 52736, 53984, 55168, 56288,
+    57344, 58336, 59264, 60128, 60928, 61664, 62336, 62944,
+    63488, 63968, 64384, 64736, 65024, 65248, 65408, 65504,
+    65536};
+
+EasingServo::EasingServo(ServoFrame *frame, uint8_t servo, double min, double max, double start)
 {
-    _pwm = pwm;
+    _frame = frame;
     _servoPin = servo;
-    _min = min;
-    _max = max;
-    currentDegree = start; // Initialize current degree to start position
-    targetDegree = start;  // Initialize target degree to start position
-    _start = start;        // Set initial start for easing to current position
-    _duration = 0;         // No active easing movement initially
-    _startMillis = 0;      // No active easing movement initially
+    _minTicks = degreeToTicks(min);
+    _maxTicks = degreeToTicks(max);
+    _currentTicks = clampTicks(degreeToTicks(start)); // Initialize current position to start position
+    _targetTicks = _currentTicks; // Initialize target position to start position
+    _startTicks = _currentTicks;  // Set initial start for easing to current position
+    _duration = 0;                // No active easing movement initially
+    _startMillis = 0;             // No active easing movement initially
+}
+
+int32_t EasingServo::degreeToTicks(double degree)
+{
+    double ticks = HuyangNeck_SERVOMIN + degree * (HuyangNeck_SERVOMAX - HuyangNeck_SERVOMIN) / 180.0;
+    return (int32_t)(ticks * EasingServo_Q16_ONE + (ticks < 0 ? -0.5 : 0.5));
+}
+
+double EasingServo::ticksToDegree(int32_t ticks)
+{
+    return ((double)ticks / EasingServo_Q16_ONE - HuyangNeck_SERVOMIN) * 180.0 / (HuyangNeck_SERVOMAX - HuyangNeck_SERVOMIN);
+}
+
+double EasingServo::targetDegree()
+{
+    return ticksToDegree(_targetTicks);
+}
+
+double EasingServo::currentDegree()
+{
+    return ticksToDegree(_currentTicks);
+}
+
+int32_t EasingServo::clampTicks(int32_t ticks)
+{
+    if (ticks < _minTicks) ticks = _minTicks;
+    if (ticks > _maxTicks) ticks = _maxTicks;
+    return ticks;
+}
+
+uint16_t EasingServo::pulseFor(int32_t ticks)
+{
+    return (uint16_t)((ticks + EasingServo_Q16_ONE / 2) >> 16);
+}
+
+void EasingServo::setMirrorServo(uint8_t servo)
+{
+    _mirrorPin = servo;
+}
+
+bool EasingServo::isMoving()
+{
+    return _profile == EASING_PROFILE_EASE ? _duration > 0 : _tracking;
+}
+
+void EasingServo::setProfile(EasingProfile profile, double maxVelocity, double maxAcceleration, double maxJerk)
+{
+    _maxVelocity = limitTicks(maxVelocity);
+    _maxAcceleration = limitTicks(maxAcceleration);
+    _profile = profile;
+
+    // Smoothing the trapezoid with a first order filter of time constant 2 * a / j turns every
+    // acceleration step (at most from +a to -a) into a ramp whose jerk stays below j
+    _smoothingMillis = maxJerk > 0 ? (uint32_t)(2000.0 * maxAcceleration / maxJerk) : 0;
+
+    // A profile without usable limits falls back to the timed ease
+    if (_maxVelocity <= 0 || _maxAcceleration <= 0 || (profile == EASING_PROFILE_SCURVE && _smoothingMillis == 0))
+    {
+        _profile = EASING_PROFILE_EASE;
+    }
+    _duration = 0;
+    stopAt(_currentTicks);
+}
+
+// Degrees (per second, squared, cubed) as Q16.16 ticks, capped so the tracking math cannot overflow
+int32_t EasingServo::limitTicks(double degrees)
+{
+    double ticks = degrees * (HuyangNeck_SERVOMAX - HuyangNeck_SERVOMIN) / 180.0 * EasingServo_Q16_ONE;
+    if (ticks > 0x3FFFFFFF) ticks = 0x3FFFFFFF;
+    return ticks < 0 ? 0 : (int32_t)ticks;
+}
+
+void EasingServo::stopAt(int32_t ticks)
+{
+    _currentTicks = ticks;
+    _profileTicks = ticks;
+    _velocity = 0;
+    _tracking = false;
+}
+
+void EasingServo::writePosition()
+{
+    _frame->setPWM(_servoPin, 0, pulseFor(_currentTicks));
+    if (_mirrorPin != EasingServo_NO_MIRROR)
+    {
+        // 180 - degree, mapped to ticks
+        int32_t mirrored = ((int32_t)(HuyangNeck_SERVOMIN + HuyangNeck_SERVOMAX) << 16) - _currentTicks;
+        _frame->setPWM(_mirrorPin, 0, pulseFor(mirrored));
+    }
 }
 
 // Sets the servo to a specific degree immediately (without easing)
 void EasingServo::rotateServo(double degree)
 {
     // Clamp degree within min/max range
-    if (degree < _min) degree = _min;
-    if (degree > _max) degree = _max;
-
-    // Map the degree to the PCA9685 pulse length range
-    uint16_t pulselength = map(degree, 0, 180, HuyangNeck_SERVOMIN, HuyangNeck_SERVOMAX);
-    _pwm->setPWM(_servoPin, 0, pulselength);
-    currentDegree = degree; // Update current degree immediately
-    targetDegree = degree;  // Target is also reached immediately
-    _duration = 0;          // No active easing
-    _startMillis = 0;       // No active easing
+    _currentTicks = clampTicks(degreeToTicks(degree));
+    writePosition();
+    _targetTicks = _currentTicks; // Target is also reached immediately
+    stopAt(_currentTicks);
+    _duration = 0;                // No active easing
+    _startMillis = 0;             // No active easing
 }
 
 // Initiates a smooth movement to a target degree over a specified duration
 void EasingServo::moveServoTo(double degree, double duration)
 {
     // Clamp target degree within min/max range
-    if (degree < _min) degree = _min;
-    if (degree > _max) degree = _max;
+    int32_t targetTicks = clampTicks(degreeToTicks(degree));
+
+    // Callers in manual mode repeat the same target every loop() pass, which must not restart the movement
+    if (targetTicks == _targetTicks) return;
+
+    _targetTicks = targetTicks;
+    if (_profile != EASING_PROFILE_EASE)
+    {
+        // Keep the current velocity, updateTracking() bends the motion towards the new target
+        if (!_tracking) _lastUpdateMillis = halMillis();
+        _tracking = true;
+        return;
+    }
 
-    targetDegree = degree;
-    _start = currentDegree; // Start easing from the current position
-    _duration = duration;
-    _startMillis = millis(); // Record start time
+    _startTicks = _currentTicks; // Start easing from the current position
+    _duration = duration < 1 ? 1 : (uint32_t)duration;
+    _progressPerMillis = (EasingServo_Q16_ONE << 8) / _duration;
+    _startMillis = halMillis(); // Record start time
 }
 
 // Updates the servo's position during an easing movement
 void EasingServo::updatePosition()
+{
+    if (_profile == EASING_PROFILE_EASE)
+    {
+        updateEase();
+    }
+    else
+    {
+        updateTracking();
+    }
+}
+
+// Timed quadratic ease
+void EasingServo::updateEase()
 {
     if (_duration > 0) // If an easing movement is active
     {
-        unsigned long currentMillis = millis();
-        unsigned long elapsedMillis = currentMillis - _startMillis;
-        double percentage = (double)elapsedMillis / _duration;
+        uint32_t elapsedMillis = halMillis() - _startMillis;
 
-        if (percentage >= 1.0)
+        if (elapsedMillis >= _duration)
         {
-            currentDegree = targetDegree; // Reached target
+            _currentTicks = _targetTicks; // Reached target
             _duration = 0; // End easing movement
         }
         else
         {
-            // Calculate eased position
-            currentDegree = easeInAndOut(_start, currentDegree, targetDegree, percentage);
+            // Calculate eased position. elapsed * _progressPerMillis stays below 2^24 because elapsed < duration.
+            uint32_t progress = (elapsedMillis * _progressPerMillis) >> 8;
+            uint32_t eased = easeInOutQuad(progress);
+            _currentTicks = _startTicks + (int32_t)(((int64_t)(_targetTicks - _startTicks) * eased) >> 16);
         }
-        // Apply the calculated degree to the servo
-        // Map the degree to the PCA9685 pulse length range
-        uint16_t pulselength = map(currentDegree, 0, 180, HuyangNeck_SERVOMIN, HuyangNeck_SERVOMAX);
-        _pwm->setPWM(_servoPin, 0, pulselength);
+        // Apply the calculated position to the servo
+        writePosition();
     }
 }
 
-// Easing function: Ease-in-out quadratic
-double EasingServo::easeInOutQuad(double t)
+// Velocity and acceleration limited tracking of the target (trapezoidal velocity profile).
+// Each step decides between speeding up towards the target, cruising and braking, based on the
+// distance needed to stop from the current velocity. Because only the velocity carries over
+// between steps, the target may change at any time without a jump in speed.
+// The S-curve profile follows the trapezoid through a first order filter.
+void EasingServo::updateTracking()
 {
-    // Quadratic easing in/out function
-    return t < 0.5 ? 2 * t * t : t * (4 - 2 * t) - 1;
-}
+    if (!_tracking) return;
 
-// Generic easing function to calculate intermediate position
-double EasingServo::easeInAndOut(double start, double current, double target, double percentage)
-{
-    double result = target; // Default to target if percentage is >= 1.0
+    unsigned long now = halMillis();
+    uint32_t dt = now - _lastUpdateMillis;
+    if (dt == 0) return;
+    _lastUpdateMillis = now;
+    if (dt > EasingServo_MAX_STEP_MILLIS) dt = EasingServo_MAX_STEP_MILLIS;
 
-    if (percentage > 1.0)
+    int64_t error = (int64_t)_targetTicks - _profileTicks;
+    if (error != 0 || _velocity != 0)
     {
-        percentage = 1.0; // Cap percentage at 1.0 (100%)
-    }
+        int64_t velocity = _velocity;
+        int64_t speed = velocity < 0 ? -velocity : velocity;
+        int64_t distance = error < 0 ? -error : error;
+        int8_t direction = error < 0 ? -1 : 1;
 
-    // Only apply easing if current is not already at target
-    if (current != target)
-    {
-        double easeInOut = easeInOutQuad(percentage);
+        // Distance needed to come to a stop from the current velocity
+        int64_t stopDistance = velocity * velocity / (2 * (int64_t)_maxAcceleration);
 
-        if (current < target)
+        bool towardsTarget = (error > 0 && velocity >= 0) || (error < 0 && velocity <= 0);
+        int64_t acceleration;
+        if (towardsTarget && distance <= stopDistance)
         {
-            double subTarget = (target - start);
-            result = start + (subTarget * easeInOut);
-            if (result > target)
-            {
-                result = target;
-            }
+            acceleration = -direction * (int64_t)_maxAcceleration; // Brake
         }
-        else if (current > target)
+        else if (!towardsTarget || speed < _maxVelocity)
         {
-            double subTarget = (start - target);
-            result = start - (subTarget * easeInOut);
-            if (result < target)
+            acceleration = direction * (int64_t)_maxAcceleration;  // Speed up towards the target (or turn around)
+        }
+        else
+        {
+            acceleration = 0;                                       // Cruise
+        }
+
+        int64_t previousVelocity = velocity;
+        velocity += acceleration * dt / 1000;
+        if (velocity > _maxVelocity) velocity = _maxVelocity;
+        if (velocity < -_maxVelocity) velocity = -_maxVelocity;
+
+        // Trapezoidal integration of the position
+        int64_t position = _profileTicks + (previousVelocity + velocity) * (int64_t)dt / 2000;
+        int64_t remaining = (int64_t)_targetTicks - position;
+
+        // Arrived when the target was reached or passed at a speed that one step of braking can absorb
+        bool passed = remaining == 0 || (remaining < 0) != (error < 0);
+        int64_t stepSpeed = (int64_t)_maxAcceleration * dt / 1000;
+        if (passed && (velocity < 0 ? -velocity : velocity) <= 2 * stepSpeed)
+        {
+            _profileTicks = _targetTicks;
+            _velocity = 0;
+        }
+        else
+        {
+            // A target at the end of the range is easily passed, the end stop ends the movement there
+            if (position < _minTicks || position > _maxTicks)
             {
-                result = target;
+                position = position < _minTicks ? _minTicks : _maxTicks;
+                velocity = 0;
             }
+            _profileTicks = (int32_t)position;
+            _velocity = (int32_t)velocity;
         }
     }
-    return result;
+
+    if (_profile == EASING_PROFILE_SCURVE)
+    {
+        int32_t lag = _profileTicks - _currentTicks;
+        uint32_t alpha = (dt << 16) / (_smoothingMillis + dt); // Q16.16
+        _currentTicks += (int32_t)(((int64_t)lag * alpha) >> 16);
+        if (_velocity == 0 && lag > -EasingServo_Q16_ONE / 4 && lag < EasingServo_Q16_ONE / 4)
+        {
+            _currentTicks = _profileTicks; // Settled within a quarter tick
+        }
+    }
+    else
+    {
+        _currentTicks = _profileTicks;
+    }
+
+    if (_velocity == 0 && _profileTicks == _targetTicks && _currentTicks == _targetTicks)
+    {
+        _tracking = false;
+    }
+    writePosition();
+}
+
+// Easing function: Ease-in-out quadratic, looked up and linearly interpolated
+uint32_t EasingServo::easeInOutQuad(uint32_t progress)
+{
+    if (progress >= (uint32_t)EasingServo_Q16_ONE) return EasingServo_Q16_ONE;
+
+    const uint8_t shift = 10; // 65536 / EasingServo_EASE_SEGMENTS
+    uint32_t index = progress >> shift;
+    uint32_t fraction = progress & ((1UL << shift) - 1);
+    uint32_t from = EasingServo_easeInOutQuadTable[index];
+    uint32_t to = EasingServo_easeInOutQuadTable[index + 1];
+    return from + (((to - from) * fraction) >> shift);
 }
@@ -2,39 +2,86 @@
 #define EasingServo_h
 
 #include "Arduino.h"
-#include <Adafruit_PWMServoDriver.h>
+#include "../ServoFrame/ServoFrame.h" // Servo outputs are buffered and written once per loop() pass
+
+// Positions are kept as PCA9685 ticks in Q16.16 fixed point, so easing needs no floating point
+// (the ESP8266 has no FPU). Degrees only appear at the public interface.
+#define EasingServo_Q16_ONE 65536L    // 1.0 in Q16.16
+#define EasingServo_EASE_SEGMENTS 64  // Linear segments of the ease curve lookup table
+#define EasingServo_NO_MIRROR 0xFF    // No mirrored servo attached
+#define EasingServo_MAX_STEP_MILLIS 50 // Longer gaps between updates are integrated as this, so a stall never causes a jump
+
+// How a servo gets to its target
+enum EasingProfile {
+    EASING_PROFILE_EASE = 0,      // Quadratic ease-in-out over the duration given to moveServoTo()
+    EASING_PROFILE_TRAPEZOID = 1, // Velocity and acceleration limited, the duration is ignored
+    EASING_PROFILE_SCURVE = 2     // Trapezoid smoothed to limit the jerk, the duration is ignored
+};
 
 class EasingServo
 {
 public:
-    EasingServo(Adafruit_PWMServoDriver *pwm, uint8_t servo, double min, double max, double start);
+    EasingServo(ServoFrame *frame, uint8_t servo, double min, double max, double start);
     void moveServoTo(double degree, double duration = 1000);
     void loop(); // This loop function is meant to be called externally to update the servo position
 
-    double targetDegree = 0;  // The target degree the servo should move to
-    double currentDegree = 0; // The current interpolated degree of the servo
+    double targetDegree();  // The target degree the servo should move to
+    double currentDegree(); // The current interpolated degree of the servo
 
     // These methods are now public so that HuyangNeck can call them to manage the servo
     void rotateServo(double degree);    // Directly sets the servo PWM to a degree
     void updatePosition();              // Calculates and updates the servo's position based on easing
+    bool isMoving();                    // True while an easing movement is running
+
+    // Switches to a velocity (deg/s), acceleration (deg/s^2) and for EASING_PROFILE_SCURVE jerk (deg/s^3) limited profile.
+    // A new target during a movement continues from the current velocity instead of restarting.
+    void setProfile(EasingProfile profile, double maxVelocity = 0, double maxAcceleration = 0, double maxJerk = 0);
+
+    // Drives a second, opposing servo with the mirrored position (180 - degree), e.g. the other side of a body axis
+    void setMirrorServo(uint8_t servo);
+
+    // Easing curve shared with the eye animations, progress and result in Q16.16 (0 - EasingServo_Q16_ONE)
+    static uint32_t easeInOutQuad(uint32_t progress);
+
+    // Degree (0-180) to PCA9685 ticks in Q16.16 and back
+    static int32_t degreeToTicks(double degree);
+    static double ticksToDegree(int32_t ticks);
 
 private:
     unsigned long _currentMillis = 0;   // Current time for internal timing
     unsigned long _previousMillis = 0;  // Previous time for internal timing
 
-    Adafruit_PWMServoDriver *_pwm;      // Pointer to the PWM driver instance
+    ServoFrame *_frame;                 // Pointer to the buffered PWM outputs
 
     uint8_t _servoPin = 0;              // The PWM channel pin for this servo
+    uint8_t _mirrorPin = EasingServo_NO_MIRROR; // Opposing servo moving with this one
 
-    double _min = -100;                 // Minimum allowed degree for this servo
-    double _max = 100;                  // Maximum allowed degree for this servo
-    double _start = 0;                  // Starting degree for the current easing movement
-    double _duration = 0;               // Duration of the current easing movement in milliseconds
+    int32_t _minTicks = 0;              // Minimum allowed position (Q16.16 ticks)
+    int32_t _maxTicks = 0;              // Maximum allowed position (Q16.16 ticks)
+    int32_t _startTicks = 0;            // Starting position of the current easing movement
+    int32_t _currentTicks = 0;          // The current interpolated position
+    int32_t _targetTicks = 0;           // The position the servo should move to
+    uint32_t _duration = 0;             // Duration of the current easing movement in milliseconds
+    uint32_t _progressPerMillis = 0;    // Progress per millisecond, Q16.16 scaled by another 256
     unsigned long _startMillis = 0;     // Timestamp when the current easing movement started
 
-    // Private helper for easing calculation
-    double easeInOutQuad(double t);
-    double easeInAndOut(double start, double current, double target, double percentage);
+    // Limited profiles: state of the tracking motion, Q16.16 ticks per second (squared)
+    EasingProfile _profile = EASING_PROFILE_EASE;
+    int32_t _maxVelocity = 0;
+    int32_t _maxAcceleration = 0;
+    uint32_t _smoothingMillis = 0;      // S-curve: time constant of the filter behind the trapezoid
+    int32_t _profileTicks = 0;          // Position of the trapezoid (before S-curve smoothing)
+    int32_t _velocity = 0;
+    bool _tracking = false;             // True while a limited profile movement is running
+    unsigned long _lastUpdateMillis = 0;
+
+    int32_t clampTicks(int32_t ticks);
+    void writePosition();                    // Hands the current position to the ServoFrame
+    void updateEase();
+    void updateTracking();
+    void stopAt(int32_t ticks);
+    static int32_t limitTicks(double degrees);
+    static uint16_t pulseFor(int32_t ticks); // Rounds Q16.16 ticks to the value written to the PCA9685
 };
 
 #endif
@@ -0,0 +1,72 @@
+#include "EyeAnimator.h" // In the same folder
+#include <Arduino.h>
+#include "../EasingServo/EasingServo.h" // Same easing curve as the servos
+
+// Rounded value between a and b, progress in Q16.16
+static int16_t tween(int16_t a, int16_t b, uint32_t progress)
+{
+    return a + (int16_t)(((int32_t)(b - a) * (int32_t)progress + EasingServo_Q16_ONE / 2) >> 16);
+}
+
+EyePose EyeAnimator::interpolate(const EyePose &from, const EyePose &to, uint32_t progress)
+{
+    EyePose pose;
+    pose.lidTop = tween(from.lidTop, to.lidTop, progress);
+    pose.lidBottom = tween(from.lidBottom, to.lidBottom, progress);
+    pose.pupilX = tween(from.pupilX, to.pupilX, progress);
+    pose.pupilY = tween(from.pupilY, to.pupilY, progress);
+    pose.pupilRadius = tween(from.pupilRadius, to.pupilRadius, progress);
+    pose.ringRadius = tween(from.ringRadius, to.ringRadius, progress);
+    pose.browY = tween(from.browY, to.browY, progress);
+    pose.browLength = tween(from.browLength, to.browLength, progress);
+    pose.browTilt = tween(from.browTilt, to.browTilt, progress);
+    return pose;
+}
+
+void EyeAnimator::setPose(const EyePose &pose)
+{
+    _pose = pose;
+    _count = 0;
+    _index = 0;
+}
+
+void EyeAnimator::moveTo(const EyePose &pose, uint16_t millis, unsigned long now)
+{
+    EyeKeyframe frame = {pose, millis};
+    play(&frame, 1, now);
+}
+
+void EyeAnimator::play(const EyeKeyframe *frames, uint8_t count, unsigned long now)
+{
+    if (count > EyeAnimator_MAX_KEYFRAMES) count = EyeAnimator_MAX_KEYFRAMES;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        _frames[i] = frames[i];
+    }
+    _count = count;
+    _index = 0;
+    _from = _pose; // Continue from wherever a replaced sequence was
+    _frameStart = now;
+}
+
+bool EyeAnimator::update(unsigned long now)
+{
+    while (_index < _count)
+    {
+        const EyeKeyframe &frame = _frames[_index];
+        unsigned long elapsed = now - _frameStart;
+        if (elapsed < frame.millis)
+        {
+            uint32_t progress = (elapsed << 16) / frame.millis; // elapsed < millis <= 65535, no overflow
+            _pose = interpolate(_from, frame.pose, EasingServo::easeInOutQuad(progress));
+            return true;
+        }
+
+        // Keyframe reached, carry the remaining time over to the next one
+        _pose = frame.pose;
+        _from = frame.pose;
+        _frameStart += frame.millis;
+        _index++;
+    }
+    return false;
+}
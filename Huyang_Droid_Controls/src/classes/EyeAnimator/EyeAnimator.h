@@ -0,0 +1,60 @@
+#ifndef EyeAnimator_h
+#define EyeAnimator_h
+
+#include "Arduino.h"
+
+#define EyeAnimator_MAX_KEYFRAMES 4 // Longest sequence play() accepts
+
+// Animatable geometry of one eye, in display pixels.
+// Colors are not part of the pose, they are applied by HuyangFace when the pose is turned into an EyeScene.
+struct EyePose {
+    int16_t lidTop;      // First row not covered by the upper eyelid
+    int16_t lidBottom;   // Last row not covered by the lower eyelid (lidBottom < lidTop = closed)
+    int16_t pupilX;
+    int16_t pupilY;
+    int16_t pupilRadius;
+    int16_t ringRadius;  // 0 = no ring
+    int16_t browY;       // Height of the brow center
+    int16_t browLength;  // Half length of the brow, 0 = no brow
+    int16_t browTilt;    // Brow angle as the rise of the right end over the left end
+};
+
+// A pose to reach and the time it takes to get there from the previous one
+struct EyeKeyframe {
+    EyePose pose;
+    uint16_t millis;
+};
+
+// Tweens an EyePose through a short sequence of keyframes using EasingServo's easing curve.
+// update() only computes the pose for the current time, so a slow frame never slows the animation down.
+class EyeAnimator
+{
+public:
+    // Jumps to a pose, stopping any running sequence
+    void setPose(const EyePose &pose);
+
+    // Eases from the current pose to the given one
+    void moveTo(const EyePose &pose, uint16_t millis, unsigned long now);
+
+    // Eases through up to EyeAnimator_MAX_KEYFRAMES keyframes, starting at the current pose
+    void play(const EyeKeyframe *frames, uint8_t count, unsigned long now);
+
+    // Advances the pose to the given time. Returns true while a sequence is running.
+    bool update(unsigned long now);
+
+    bool isRunning() { return _index < _count; }
+    const EyePose &pose() { return _pose; }
+
+    // Pose between from (progress 0) and to (progress EasingServo_Q16_ONE)
+    static EyePose interpolate(const EyePose &from, const EyePose &to, uint32_t progress);
+
+private:
+    EyePose _pose = {};
+    EyePose _from = {};                             // Pose the current keyframe started at
+    EyeKeyframe _frames[EyeAnimator_MAX_KEYFRAMES];
+    uint8_t _count = 0;
+    uint8_t _index = 0;                             // Keyframe being tweened towards
+    unsigned long _frameStart = 0;                  // Time the current keyframe started
+};
+
+#endif
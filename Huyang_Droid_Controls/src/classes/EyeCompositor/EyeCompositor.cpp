@@ -0,0 +1,291 @@
+#include "EyeCompositor.h" // In the same folder
+#include <Arduino.h>
+
+// Integer square root, used for the horizontal extent of circles per row
+static int16_t isqrt32(uint32_t value)
+{
+    uint32_t result = 0;
+    uint32_t bit = 1UL << 30;
+    while (bit > value) bit >>= 2;
+    while (bit != 0)
+    {
+        if (value >= result + bit)
+        {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else
+        {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (int16_t)result;
+}
+
+// Fills line[x0..x1] with color, clipped to the row
+static void fillSpan(uint16_t *line, int16_t width, int16_t x0, int16_t x1, uint16_t color)
+{
+    if (x0 < 0) x0 = 0;
+    if (x1 >= width) x1 = width - 1;
+    for (int16_t x = x0; x <= x1; x++)
+    {
+        line[x] = color;
+    }
+}
+
+EyeCompositor::EyeCompositor(PixelDisplay *display, uint16_t width, uint16_t height)
+{
+    _display = display;
+    _width = width;
+    _height = height;
+    _line = new uint16_t[width];
+    _shownLine = new uint16_t[width];
+    _dirtyRows = new uint8_t[(height + 7) / 8];
+    _pipeline = new EyePipeline(display, width);
+}
+
+void EyeCompositor::flush()
+{
+    _pipeline->flush();
+}
+
+bool EyeCompositor::sameScene(const EyeScene &a, const EyeScene &b)
+{
+    return sameContent(a, b) &&
+           a.windowTop == b.windowTop && a.windowBottom == b.windowBottom && a.outsideColor == b.outsideColor;
+}
+
+bool EyeCompositor::sameContent(const EyeScene &a, const EyeScene &b)
+{
+    return a.background == b.background &&
+           a.pupilX == b.pupilX && a.pupilY == b.pupilY && a.pupilRadius == b.pupilRadius && a.pupilColor == b.pupilColor &&
+           a.ringRadius == b.ringRadius && a.ringColor == b.ringColor &&
+           a.brow == b.brow && a.browX0 == b.browX0 && a.browY0 == b.browY0 && a.browX1 == b.browX1 && a.browY1 == b.browY1 && a.browColor == b.browColor;
+}
+
+// Rasterizes row y of a scene into line[0..width-1]
+void EyeCompositor::renderRow(const EyeScene &scene, int16_t y, uint16_t width, uint16_t *line)
+{
+    if (y < scene.windowTop || y > scene.windowBottom)
+    {
+        fillSpan(line, width, 0, width - 1, scene.outsideColor);
+        return;
+    }
+
+    fillSpan(line, width, 0, width - 1, scene.background);
+
+    int16_t dy = y - scene.pupilY;
+    if (scene.pupilRadius > 0 && abs(dy) <= scene.pupilRadius)
+    {
+        int16_t dx = isqrt32((int32_t)scene.pupilRadius * scene.pupilRadius - (int32_t)dy * dy);
+        fillSpan(line, width, scene.pupilX - dx, scene.pupilX + dx, scene.pupilColor);
+    }
+
+    if (scene.ringRadius > 0 && abs(dy) <= scene.ringRadius)
+    {
+        // Pixels inside the outer circle but outside the circle one pixel smaller
+        int16_t outer = isqrt32((int32_t)scene.ringRadius * scene.ringRadius - (int32_t)dy * dy);
+        int16_t inner = outer;
+        if (abs(dy) <= scene.ringRadius - 1)
+        {
+            int16_t innerRadius = scene.ringRadius - 1;
+            inner = isqrt32((int32_t)innerRadius * innerRadius - (int32_t)dy * dy) + 1;
+            if (inner > outer) inner = outer;
+        }
+        else
+        {
+            inner = 0; // Top and bottom cap of the ring
+        }
+        fillSpan(line, width, scene.pupilX - outer, scene.pupilX - inner, scene.ringColor);
+        fillSpan(line, width, scene.pupilX + inner, scene.pupilX + outer, scene.ringColor);
+    }
+
+    if (scene.brow)
+    {
+        // Orient the line top to bottom
+        int16_t xa = scene.browX0, ya = scene.browY0, xb = scene.browX1, yb = scene.browY1;
+        if (ya > yb)
+        {
+            xa = scene.browX1; ya = scene.browY1;
+            xb = scene.browX0; yb = scene.browY0;
+        }
+        if (y >= ya && y <= yb)
+        {
+            int16_t xMin = min(xa, xb);
+            int16_t xMax = max(xa, xb);
+            if (ya != yb)
+            {
+                // x range the line covers between y - 0.5 and y + 0.5
+                int32_t dx = xb - xa;
+                int32_t rows = yb - ya;
+                int32_t from = xa + (dx * (2 * (y - ya) - 1)) / (2 * rows);
+                int32_t to = xa + (dx * (2 * (y - ya) + 1)) / (2 * rows);
+                if (from > to)
+                {
+                    int32_t swap = from;
+                    from = to;
+                    to = swap;
+                }
+                xMin = max((int32_t)xMin, from);
+                xMax = min((int32_t)xMax, to);
+            }
+            fillSpan(line, width, xMin, xMax, scene.browColor);
+        }
+    }
+}
+
+void EyeCompositor::reset(uint16_t color)
+{
+    _shown = EyeScene();
+    _shown.background = color;
+    _shown.outsideColor = color;
+    _hasShown = true;
+}
+
+void EyeCompositor::markRows(int16_t from, int16_t to)
+{
+    if (from < 0) from = 0;
+    if (to >= (int16_t)_height) to = _height - 1;
+    for (int16_t y = from; y <= to; y++)
+    {
+        _dirtyRows[y >> 3] |= (1 << (y & 7));
+    }
+}
+
+bool EyeCompositor::isRowDirty(int16_t y)
+{
+    return _dirtyRows[y >> 3] & (1 << (y & 7));
+}
+
+// Marks every row that may look different between scene a and scene b
+void EyeCompositor::markSceneChanges(const EyeScene &a, const EyeScene &b)
+{
+    if (a.background != b.background)
+    {
+        markRows(0, _height - 1);
+        return;
+    }
+
+    // Rows switching between eye and outside
+    int16_t topA = constrain(a.windowTop, (int16_t)0, (int16_t)_height);
+    int16_t topB = constrain(b.windowTop, (int16_t)0, (int16_t)_height);
+    int16_t bottomA = constrain(a.windowBottom, (int16_t)-1, (int16_t)(_height - 1));
+    int16_t bottomB = constrain(b.windowBottom, (int16_t)-1, (int16_t)(_height - 1));
+    if (topA != topB) markRows(min(topA, topB), max(topA, topB));
+    if (bottomA != bottomB) markRows(min(bottomA, bottomB), max(bottomA, bottomB));
+    if (a.outsideColor != b.outsideColor)
+    {
+        markRows(0, max(topA, topB) - 1);
+        markRows(min(bottomA, bottomB) + 1, _height - 1);
+    }
+
+    // Shapes: both the old and the new extent
+    bool pupilMoved = a.pupilX != b.pupilX || a.pupilY != b.pupilY;
+    if (pupilMoved || a.pupilRadius != b.pupilRadius || a.pupilColor != b.pupilColor)
+    {
+        markRows(a.pupilY - a.pupilRadius, a.pupilY + a.pupilRadius);
+        markRows(b.pupilY - b.pupilRadius, b.pupilY + b.pupilRadius);
+    }
+    if (pupilMoved || a.ringRadius != b.ringRadius || a.ringColor != b.ringColor)
+    {
+        markRows(a.pupilY - a.ringRadius, a.pupilY + a.ringRadius);
+        markRows(b.pupilY - b.ringRadius, b.pupilY + b.ringRadius);
+    }
+    if (a.brow != b.brow || a.browX0 != b.browX0 || a.browY0 != b.browY0 || a.browX1 != b.browX1 || a.browY1 != b.browY1 || a.browColor != b.browColor)
+    {
+        if (a.brow) markRows(min(a.browY0, a.browY1), max(a.browY0, a.browY1));
+        if (b.brow) markRows(min(b.browY0, b.browY1), max(b.browY0, b.browY1));
+    }
+}
+
+bool EyeCompositor::present(const EyeScene &scene)
+{
+    if (!_display) return false;
+
+    if (_hasShown && sameScene(_shown, scene))
+    {
+        skippedFrames++;
+        return false;
+    }
+
+    memset(_dirtyRows, 0, (_height + 7) / 8);
+    if (_hasShown)
+    {
+        markSceneChanges(_shown, scene);
+    }
+    else
+    {
+        markRows(0, _height - 1);
+    }
+
+    // Consecutive changed rows are collected into one band and pushed as one rectangle
+    bool pushed = false;
+    uint16_t *band = nullptr;
+    int16_t bandY = 0;
+    uint16_t bandRows = 0;
+    int16_t bandFirst = 0;
+    int16_t bandLast = 0;
+    for (int16_t y = 0; y < (int16_t)_height; y++)
+    {
+        if (!isRowDirty(y)) continue;
+
+        renderRow(scene, y, _width, _line);
+
+        // Narrow the row down to the span that actually differs from the display
+        int16_t first = 0;
+        int16_t last = _width - 1;
+        if (_hasShown)
+        {
+            renderRow(_shown, y, _width, _shownLine);
+            while (first <= last && _line[first] == _shownLine[first]) first++;
+            if (first > last) continue;
+            while (_line[last] == _shownLine[last]) last--;
+        }
+
+        if (band && (y != bandY + bandRows || bandRows == _pipeline->bandRows()))
+        {
+            submitBand(band, bandY, bandRows, bandFirst, bandLast);
+            band = nullptr;
+        }
+        if (!band)
+        {
+            band = _pipeline->acquire();
+            bandY = y;
+            bandRows = 0;
+            bandFirst = first;
+            bandLast = last;
+        }
+        memcpy(band + (uint32_t)bandRows * _width, _line, _width * sizeof(uint16_t));
+        bandFirst = min(bandFirst, first);
+        bandLast = max(bandLast, last);
+        bandRows++;
+        pushed = true;
+    }
+    if (band)
+    {
+        submitBand(band, bandY, bandRows, bandFirst, bandLast);
+    }
+
+    _shown = scene;
+    _hasShown = true;
+    if (!pushed) skippedFrames++;
+    return pushed;
+}
+
+// Packs the columns first..last of every band row together and queues the rectangle
+void EyeCompositor::submitBand(uint16_t *band, int16_t y, uint16_t rows, int16_t first, int16_t last)
+{
+    uint16_t w = last - first + 1;
+    if (w < _width)
+    {
+        // Moving towards the buffer start, so rows never overwrite pixels not yet moved
+        for (uint16_t row = 0; row < rows; row++)
+        {
+            memmove(band + (uint32_t)row * w, band + (uint32_t)row * _width + first, w * sizeof(uint16_t));
+        }
+    }
+    _pipeline->submit(band, first, y, w, rows);
+    pushedPixels += (uint32_t)w * rows;
+    pushedSpans++;
+}
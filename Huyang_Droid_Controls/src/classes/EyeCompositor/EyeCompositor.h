@@ -0,0 +1,89 @@
+#ifndef EyeCompositor_h
+#define EyeCompositor_h
+
+#include "Arduino.h"
+#include "../../submodules/Hal/PixelDisplay.h" // For TFT displays (eyes)
+#include "../EyePipeline/EyePipeline.h" // Bands are handed to the display through a per-eye queue
+
+#define EyeCompositor_WINDOW_ALL 0x7FFF // windowBottom value meaning "down to the last row"
+
+// Description of everything visible on one eye display.
+// Eye drawings are built from these few shapes, so a frame can be rasterized one row at a time
+// without keeping a 240x240 framebuffer (115 KB) per eye in RAM.
+struct EyeScene {
+    uint16_t background = 0x0000;
+
+    // Filled pupil
+    int16_t pupilX = 0;
+    int16_t pupilY = 0;
+    int16_t pupilRadius = 0;         // 0 = no pupil
+    uint16_t pupilColor = 0x0000;
+
+    // One pixel ring around the pupil center
+    int16_t ringRadius = 0;          // 0 = no ring
+    uint16_t ringColor = 0xFFFF;
+
+    // One pixel brow line
+    bool brow = false;
+    int16_t browX0 = 0;
+    int16_t browY0 = 0;
+    int16_t browX1 = 0;
+    int16_t browY1 = 0;
+    uint16_t browColor = 0xFFFF;
+
+    // Only rows windowTop..windowBottom show the eye, all other rows show outsideColor (eyelids / wipes)
+    int16_t windowTop = 0;
+    int16_t windowBottom = EyeCompositor_WINDOW_ALL;
+    uint16_t outsideColor = 0x0000;
+};
+
+// Pushes EyeScenes to one display, sending only the pixel spans that differ from the
+// scene currently shown. Presenting an unchanged scene costs no SPI traffic at all. Every frame is
+// diffed: moods and blinks are eased, so a frame only changes a few hundred pixels, far less than
+// pushing the whole eye.
+// Changed rows are composed into bands of the EyePipeline, which streams one band while the next is composed.
+class EyeCompositor
+{
+public:
+    EyeCompositor(PixelDisplay *display, uint16_t width, uint16_t height);
+
+    // Makes the display show the given scene. Returns false if nothing had to be pushed.
+    bool present(const EyeScene &scene);
+
+    // Tells the compositor the display was filled with a single color outside of present()
+    void reset(uint16_t color);
+
+    // Waits until everything presented so far reached the display
+    void flush();
+
+    EyePipeline *pipeline() { return _pipeline; }
+
+    // Statistics for tuning
+    uint32_t pushedPixels = 0;  // Pixels sent over SPI
+    uint32_t pushedSpans = 0;   // Windowed writes (bands) issued
+    uint32_t skippedFrames = 0; // present() calls that found nothing to push
+
+    static bool sameScene(const EyeScene &a, const EyeScene &b);
+    static bool sameContent(const EyeScene &a, const EyeScene &b); // Ignores the eyelid window
+    static void renderRow(const EyeScene &scene, int16_t y, uint16_t width, uint16_t *line);
+
+private:
+    PixelDisplay *_display;
+    EyePipeline *_pipeline;
+    uint16_t _width;
+    uint16_t _height;
+
+    EyeScene _shown;         // What the display currently shows
+    bool _hasShown = false;  // False until the display content is known
+
+    uint16_t *_line;         // Row of the new scene
+    uint16_t *_shownLine;    // Same row of the shown scene
+    uint8_t *_dirtyRows;     // One bit per row that may differ
+
+    void markRows(int16_t from, int16_t to);
+    void markSceneChanges(const EyeScene &a, const EyeScene &b);
+    bool isRowDirty(int16_t y);
+    void submitBand(uint16_t *band, int16_t y, uint16_t rows, int16_t first, int16_t last);
+};
+
+#endif
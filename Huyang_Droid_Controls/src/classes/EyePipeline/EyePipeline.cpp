@@ -0,0 +1,91 @@
+#include "EyePipeline.h" // In the same folder
+#include <Arduino.h>
+
+#if defined(ESP32)
+#include <esp_heap_caps.h>
+#endif
+
+void (*EyePipeline::bandCallback)() = nullptr;
+
+EyePipeline::EyePipeline(PixelDisplay *display, uint16_t width)
+{
+    _display = display;
+    _width = width;
+
+    size_t bytes = (size_t)width * EyePipeline_BAND_ROWS * sizeof(uint16_t);
+#if defined(ESP32)
+    _pending = xQueueCreate(EyePipeline_BUFFERS, sizeof(Transfer));
+    _free = xQueueCreate(EyePipeline_BUFFERS, sizeof(uint16_t *));
+    for (uint8_t i = 0; i < EyePipeline_BUFFERS; i++)
+    {
+        // SPI DMA can only read from internal, DMA capable memory
+        _buffers[i] = (uint16_t *)heap_caps_malloc(bytes, MALLOC_CAP_DMA);
+        xQueueSend(_free, &_buffers[i], 0);
+    }
+    xTaskCreatePinnedToCore(transferTask, "EyePipeline", 2048, this, EyePipeline_TASK_PRIORITY, &_task, EyePipeline_TASK_CORE);
+#else
+    for (uint8_t i = 0; i < EyePipeline_BUFFERS; i++)
+    {
+        _buffers[i] = (uint16_t *)malloc(bytes);
+    }
+#endif
+}
+
+#if defined(ESP32)
+// Streams queued bands to the display and hands their buffers back
+void EyePipeline::transferTask(void *parameter)
+{
+    EyePipeline *pipeline = (EyePipeline *)parameter;
+    Transfer transfer;
+    for (;;)
+    {
+        if (xQueueReceive(pipeline->_pending, &transfer, portMAX_DELAY) == pdTRUE)
+        {
+            pipeline->_display->draw16bitRGBBitmap(transfer.x, transfer.y, transfer.pixels, transfer.w, transfer.h);
+            xQueueSend(pipeline->_free, &transfer.pixels, portMAX_DELAY);
+        }
+    }
+}
+#endif
+
+uint16_t *EyePipeline::acquire()
+{
+#if defined(ESP32)
+    uint16_t *buffer = nullptr;
+    if (xQueueReceive(_free, &buffer, 0) != pdTRUE)
+    {
+        unsigned long waitStart = micros();
+        xQueueReceive(_free, &buffer, portMAX_DELAY);
+        waitMicros += micros() - waitStart;
+    }
+    return buffer;
+#else
+    return _buffers[0];
+#endif
+}
+
+void EyePipeline::submit(uint16_t *pixels, int16_t x, int16_t y, uint16_t w, uint16_t h)
+{
+    transfers++;
+#if defined(ESP32)
+    Transfer transfer = {pixels, x, y, w, h};
+    xQueueSend(_pending, &transfer, portMAX_DELAY);
+#else
+    _display->draw16bitRGBBitmap(x, y, pixels, w, h);
+#endif
+    if (bandCallback) bandCallback();
+}
+
+void EyePipeline::flush()
+{
+#if defined(ESP32)
+    unsigned long waitStart = micros();
+    bool waited = false;
+    while (uxQueueMessagesWaiting(_free) < EyePipeline_BUFFERS)
+    {
+        waited = true;
+        vTaskDelay(1);
+    }
+    if (waited) waitMicros += micros() - waitStart;
+#endif
+}
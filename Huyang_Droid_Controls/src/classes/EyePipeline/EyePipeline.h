@@ -0,0 +1,73 @@
+#ifndef EyePipeline_h
+#define EyePipeline_h
+
+#include "Arduino.h"
+#include "../../submodules/Hal/PixelDisplay.h" // For TFT displays (eyes)
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+// Two band buffers per eye: the CPU composes into one while the other is transferred
+#define EyePipeline_BUFFERS 2
+#define EyePipeline_BAND_ROWS 16
+#define EyePipeline_TASK_CORE 0      // Keep transfers away from the Arduino loop on core 1
+#define EyePipeline_TASK_PRIORITY 2
+#else
+// ESP8266: no second core to hand transfers to, a single buffer is pushed synchronously
+#define EyePipeline_BUFFERS 1
+#define EyePipeline_BAND_ROWS 4
+#endif
+
+// Queue of pixel bands for one eye display.
+// On ESP32 every eye has its own transfer task and queue, so both panels are fed concurrently
+// (use one Arduino_ESP32SPIDMA bus per eye so the transfers themselves run on DMA).
+class EyePipeline
+{
+public:
+    EyePipeline(PixelDisplay *display, uint16_t width);
+
+    // Band buffer to compose into (width x EyePipeline_BAND_ROWS pixels).
+    // Waits only if all buffers are still being transferred.
+    uint16_t *acquire();
+
+    // Queues the acquired buffer for transfer. The pixels must be packed with a stride of w.
+    void submit(uint16_t *pixels, int16_t x, int16_t y, uint16_t w, uint16_t h);
+
+    // Waits until every queued band reached the display
+    void flush();
+
+    uint16_t width() { return _width; }
+    uint16_t bandRows() { return EyePipeline_BAND_ROWS; }
+
+    // Called after every submitted band, so more urgent work (servos) can run while a frame is pushed
+    static void (*bandCallback)();
+
+    // Statistics for tuning
+    uint32_t transfers = 0;  // Bands submitted
+    uint32_t waitMicros = 0; // Time the CPU spent waiting for a free buffer
+
+private:
+    PixelDisplay *_display;
+    uint16_t _width;
+    uint16_t *_buffers[EyePipeline_BUFFERS];
+
+#if defined(ESP32)
+    struct Transfer {
+        uint16_t *pixels;
+        int16_t x;
+        int16_t y;
+        uint16_t w;
+        uint16_t h;
+    };
+
+    QueueHandle_t _pending;   // Transfers waiting for the task
+    QueueHandle_t _free;      // Buffers the CPU may compose into
+    TaskHandle_t _task = nullptr;
+
+    static void transferTask(void *parameter);
+#endif
+};
+
+#endif
@@ -80,7 +80,7 @@
         // Only engage in random playback if manual control is NOT active AND player is not currently playing
         if (!_manualControlActive)
         {
-            _currentMillis = millis();
+            _currentMillis = halMillis();
 
             if (_currentMillis < _previousMillis) {
                 _previousMillis = 0;
@@ -106,7 +106,7 @@
 
                 if (_audioItemCount > 0)
                 {
-                    uint16_t randomItemNumber = random(1, _audioItemCount + 1); 
+                    uint16_t randomItemNumber = halRandom(1, _audioItemCount + 1); 
 
                     if (randomItemNumber == 8) { randomItemNumber = randomItemNumber + 1; }
 
@@ -114,7 +114,7 @@
                     _player.play(randomItemNumber);
                     _currentPlayingTrack = randomItemNumber; 
 
-                    _audioPause = 2000 + (random(10, 50) * 100);
+                    _audioPause = 2000 + (halRandom(10, 50) * 100);
                 }
             }
             // If player *is* playing (e.g., just started automatically) and _currentPlayingTrack is unknown,
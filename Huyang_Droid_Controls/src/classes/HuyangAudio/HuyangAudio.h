@@ -3,6 +3,7 @@
 
 #include "SoftwareSerial.h"
 #include "DFRobotDFPlayerMini.h"
+#include "../../submodules/Hal/HalClock.h" // Time and random tracks, simulated on the host
 
 class HuyangAudio
 {
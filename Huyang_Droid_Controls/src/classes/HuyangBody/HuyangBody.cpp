@@ -1,18 +1,25 @@
 #include "HuyangBody.h" // In the same folder
-#include <Adafruit_PWMServoDriver.h>
-#include <Adafruit_NeoPixel.h>
-#include <Wire.h> // Include Wire.h for I2C communication
 #include <Arduino.h> // For Serial.println
+#include "../../submodules/Log/Log.h" // Serial messages of the servo task
 
-// Corrected typo: Adafruit_PWMServoDriver
-HuyangBody::HuyangBody(Adafruit_PWMServoDriver *pwm)
+HuyangBody::HuyangBody(PwmOutput *pwm, ServoFrame *frame, LedStrip *lights)
 {
 	_pwm = pwm;
-	// Initialize NeoPixel object for 2 pixels on NEO_PIXEL_PIN
-	// This pin MUST be defined in config.h or similar if it's not a fixed value.
-	_neoPixelLights = new Adafruit_NeoPixel(NEO_PIXEL_COUNT, NEO_PIXEL_PIN, pixelFormat);
+	_frame = frame;
+	// NeoPixel strip of NEO_PIXEL_COUNT pixels, created by the sketch
+	_neoPixelLights = lights;
 	_neoPixelLights->setBrightness(20); // Set initial brightness (0-255)
-	// Note: _neoPixelLights->begin() is called here, but _pwm->begin() is still needed below.
+
+	// Initialize EasingServo instances for body movements, 0-180 degrees, start at 90 (center)
+	_rotateServo = new EasingServo(_frame, pwm_pin_body_rotate, 0, 180, 90);
+	_tiltForwardServo = new EasingServo(_frame, pwm_pin_forward_left, 0, 180, 90);
+	_tiltForwardServo->setMirrorServo(pwm_pin_forward_right); // Invert for opposing motion
+	_tiltSidewaysServo = new EasingServo(_frame, pwm_pin_sideway_left, 0, 180, 90);
+	_tiltSidewaysServo->setMirrorServo(pwm_pin_sideway_right); // Invert for opposing motion
+
+	_rotateServo->setProfile(EASING_PROFILE_TRAPEZOID, HuyangBody_MAX_VELOCITY, HuyangBody_MAX_ACCELERATION);
+	_tiltForwardServo->setProfile(EASING_PROFILE_TRAPEZOID, HuyangBody_MAX_VELOCITY, HuyangBody_MAX_ACCELERATION);
+	_tiltSidewaysServo->setProfile(EASING_PROFILE_TRAPEZOID, HuyangBody_MAX_VELOCITY, HuyangBody_MAX_ACCELERATION);
 }
 
 void HuyangBody::setup()
@@ -34,29 +41,31 @@ void HuyangBody::setup()
 	// Initialize NeoPixel library (already in constructor, but safe to call again or move here)
 	_neoPixelLights->begin();
 
-	// Initial centering of all body servos
+	// Hold the servos at their start position, then ease them to the calibrated center
+	_rotateServo->rotateServo(_rotateServo->currentDegree());
+	_tiltForwardServo->rotateServo(_tiltForwardServo->currentDegree());
+	_tiltSidewaysServo->rotateServo(_tiltSidewaysServo->currentDegree());
 	centerAll();
 	_neoPixelLights->show(); // Ensure NeoPixels are off or at their default state
 	updateChestLights(); // Set initial light mode
     Serial.println("HuyangBody: Setup complete.");
 }
 
-// Maps a degree value to a PWM pulselength and sends it to the specified servo pin
-void HuyangBody::rotateServo(uint8_t servo, uint16_t degree)
+// Converts a user degree (-90 to 90) plus calibration to the 0-180 servo range
+int16_t HuyangBody::mapDegree(int16_t degree, int16_t calibration)
 {
-    Serial.printf("HuyangBody::rotateServo - Servo: %d, Degree (0-180 for PWM): %d\n", servo, degree);
-	// Map the input degree (0-180 for standard servos) to the PCA9685 pulse length range
-	uint16_t pulselength = map(degree, 0, 180, HuyangBody_SERVOMIN, HuyangBody_SERVOMAX);
+	int16_t mappedDegree = degree + 90 + calibration;
 
-	// Set the PWM output for the specified servo pin
-	_pwm->setPWM(servo, 0, pulselength);
-    Serial.printf("HuyangBody::rotateServo - Set PWM for servo %d to pulselength %d\n", servo, pulselength);
+	// Clamp to 0-180
+	if (mappedDegree < 0) mappedDegree = 0;
+	if (mappedDegree > 180) mappedDegree = 180;
+	return mappedDegree;
 }
 
 // Main loop for HuyangBody, called repeatedly from system.h
 void HuyangBody::loop()
 {
-	_currentMillis = millis(); // Get current time
+	_currentMillis = halMillis(); // Get current time
 
 	// Reset previousMillis if system time rolls over
 	if (_previousMillis > _currentMillis)
@@ -64,89 +73,84 @@ void HuyangBody::loop()
 		_previousMillis = _currentMillis;
 	}
 
+	// Move the servos along their easing curves and continue a running centering
+	_rotateServo->updatePosition();
+	_tiltForwardServo->updatePosition();
+	_tiltSidewaysServo->updatePosition();
+	updateCentering();
+
 	// If in automatic mode, trigger random movements
-	if (automatic == true)
+	if (automatic == true && _centerStep == CENTER_DONE)
 	{
 		doRandomRotate();
 		doRandomTiltForward();
 		doRandomTiltSideways();
 	}
-
-	updateChestLights(); // Continuously update chest lights based on current mode
+	// The chest lights are updated by their own scheduler task, see updateChestLights()
 }
 
 // --- Body Movement Control Functions ---
 
 // Controls body sideways tilt
-void HuyangBody::tiltBodySideways(int16_t degree)
+void HuyangBody::tiltBodySideways(int16_t degree, double duration)
 {
-    Serial.printf("HuyangBody::tiltBodySideways: Input degree (User -90 to 90): %d\n", degree);
-	// Convert -90 to 90 degree range to 0 to 180 range, then apply calibration
-    // Also, apply specific physical mapping if required for sideways servos
-	int16_t mappedDegree = degree + 90 + calibrationTiltSideways;
-
-    // Apply specific offsets/inversions for physical setup if necessary, e.g.,
-    // if left and right servos need opposite degree inputs from the same mappedDegree.
-    // Example from original code had specific shifts and different mapping for left/right:
-    // int16_t calibrationShift = -22; // max 0 to -60
-    // int16_t calibratedDegree = map(degree, -100, 100, -60 + calibrationShift, 60 + calibrationShift);
-    // uint16_t rotateDegree = map(calibratedDegree, -100, 100, 0, 170);
-
-    // Assuming a symmetrical setup where +ve degree maps to one side, -ve to other.
-    // The incoming `degree` is already -90 to 90.
-    // Let's use `mappedDegree` (0-180) for rotateServo directly.
-    
-    // Clamp to 0-180
-    if (mappedDegree < 0) mappedDegree = 0;
-    if (mappedDegree > 180) mappedDegree = 180;
-
-	rotateServo(pwm_pin_sideway_left, mappedDegree);
-	rotateServo(pwm_pin_sideway_right, 180 - mappedDegree); // Invert for opposing motion
-    Serial.printf("HuyangBody::tiltBodySideways: Mapped to 0-180 range (with cal): %d, Sending to servos.\n", mappedDegree);
+	// Convert -90 to 90 degree range to 0 to 180 range, then apply calibration.
+	// The right servo follows mirrored (180 - degree), see the constructor.
+	_tiltSidewaysServo->moveServoTo(mapDegree(degree, calibrationTiltSideways), duration);
 }
 
 // Controls body forward/backward tilt
-void HuyangBody::tiltBodyForward(int16_t degree)
+void HuyangBody::tiltBodyForward(int16_t degree, double duration)
 {
-    Serial.printf("HuyangBody::tiltBodyForward: Input degree (User -90 to 90): %d\n", degree);
-	// Convert -90 to 90 degree range to 0 to 180 range, then apply calibration
-	int16_t mappedDegree = degree + 90 + calibrationTiltForward;
-    
-    // Clamp to 0-180
-    if (mappedDegree < 0) mappedDegree = 0;
-    if (mappedDegree > 180) mappedDegree = 180;
-
-	rotateServo(pwm_pin_forward_left, mappedDegree);
-	rotateServo(pwm_pin_forward_right, 180 - mappedDegree); // Invert for opposing motion
-    Serial.printf("HuyangBody::tiltBodyForward: Mapped to 0-180 range (with cal): %d, Sending to servos.\n", mappedDegree);
+	_tiltForwardServo->moveServoTo(mapDegree(degree, calibrationTiltForward), duration);
 }
 
 // Controls body rotation (hip/torso rotation)
-void HuyangBody::rotateBody(int16_t degree)
+void HuyangBody::rotateBody(int16_t degree, double duration)
 {
-    Serial.printf("HuyangBody::rotateBody: Input degree (User -90 to 90): %d\n", degree);
-	// Convert -90 to 90 degree range to 0 to 180 range, then apply calibration
-	int16_t mappedDegree = degree + 90 + calibrationRotate;
-    
-    // Clamp to 0-180
-    if (mappedDegree < 0) mappedDegree = 0;
-    if (mappedDegree > 180) mappedDegree = 180;
-
-	rotateServo(pwm_pin_body_rotate, mappedDegree);
-    Serial.printf("HuyangBody::rotateBody: Mapped to 0-180 range (with cal): %d, Sending to servos.\n", mappedDegree);
+	_rotateServo->moveServoTo(mapDegree(degree, calibrationRotate), duration);
 }
 
-// Sets all body servos to their predefined center positions
+// Sets all body servos to their predefined center positions.
+// Only the first axis is started here, loop() starts the next one once the previous arrived,
+// so the big servos never draw their peak current at the same time.
 void HuyangBody::centerAll()
 {
     Serial.println("HuyangBody::centerAll called.");
 	// These values (0) now correspond to the center of the -90 to 90 range.
-	tiltBodySideways(0);
-	delay(500); // Small delay to allow servos to reach position
-	tiltBodyForward(0);
-	delay(500);
-	rotateBody(0);
-    Serial.println("HuyangBody: All body servos commanded to center.");
+	tiltBodySideways(0, HuyangBody_CENTER_MILLIS);
+	_centerStep = CENTER_SIDEWAYS;
+}
+
+// Advances the centering sequence started by centerAll()
+void HuyangBody::updateCentering()
+{
+	switch (_centerStep)
+	{
+	case CENTER_SIDEWAYS:
+		if (!_tiltSidewaysServo->isMoving())
+		{
+			tiltBodyForward(0, HuyangBody_CENTER_MILLIS);
+			_centerStep = CENTER_FORWARD;
+		}
+		break;
+	case CENTER_FORWARD:
+		if (!_tiltForwardServo->isMoving())
+		{
+			rotateBody(0, HuyangBody_CENTER_MILLIS);
+			_centerStep = CENTER_ROTATE;
+		}
+		break;
+	case CENTER_ROTATE:
+		if (!_rotateServo->isMoving())
+		{
+			_centerStep = CENTER_DONE;
+			Serial.println("HuyangBody: All body servos centered.");
+		}
+		break;
+	default:
+		break;
+	}
 }
 
 // --- Random Movement Functions (for automatic mode) ---
@@ -155,7 +159,7 @@ void HuyangBody::doRandomRotate()
 {
 	if (_randomDoRotate == 0)
 	{
-		_randomDoRotate = _currentMillis + 2000 + (random(6, 12 + 1) * 1000);
+		_randomDoRotate = _currentMillis + 2000 + (halRandom(6, 12 + 1) * 1000);
 	}
 
 	if (_currentMillis > _randomDoRotate)
@@ -163,16 +167,16 @@ void HuyangBody::doRandomRotate()
 		_randomDoRotate = 0;
 
 		int16_t randomDegree;
-		if (random(0, 2) == 0) // Randomly choose direction
+		if (halRandom(0, 2) == 0) // Randomly choose direction
 		{
-			randomDegree = -(random(10, 80 + 1)); // Rotate left within -90 range
+			randomDegree = -(halRandom(10, 80 + 1)); // Rotate left within -90 range
 		}
 		else
 		{
-			randomDegree = random(10, 80 + 1); // Rotate right within 90 range
+			randomDegree = halRandom(10, 80 + 1); // Rotate right within 90 range
 		}
-		rotateBody(randomDegree);
-        Serial.printf("HuyangBody::doRandomRotate - New random rotation triggered to %d\n", randomDegree);
+		rotateBody(randomDegree, halRandom(2, 5 + 1) * 1000);
+        LOG_INFO("HuyangBody::doRandomRotate - New random rotation triggered to %d", randomDegree);
 	}
 }
 
@@ -180,7 +184,7 @@ void HuyangBody::doRandomTiltForward()
 {
 	if (_randomDoTiltForward == 0)
 	{
-		_randomDoTiltForward = _currentMillis + 2500 + (random(6, 12 + 1) * 1050);
+		_randomDoTiltForward = _currentMillis + 2500 + (halRandom(6, 12 + 1) * 1050);
 	}
 
 	if (_currentMillis > _randomDoTiltForward)
@@ -188,16 +192,16 @@ void HuyangBody::doRandomTiltForward()
 		_randomDoTiltForward = 0;
 
 		int16_t randomDegree;
-		if (random(0, 2) == 0) // Randomly choose direction
+		if (halRandom(0, 2) == 0) // Randomly choose direction
 		{
-			randomDegree = -(random(10, 80 + 1)); // Tilt forward within -90 range
+			randomDegree = -(halRandom(10, 80 + 1)); // Tilt forward within -90 range
 		}
 		else
 		{
-			randomDegree = random(10, 80 + 1); // Tilt backward within 90 range
+			randomDegree = halRandom(10, 80 + 1); // Tilt backward within 90 range
 		}
-		tiltBodyForward(randomDegree);
-        Serial.printf("HuyangBody::doRandomTiltForward - New random tilt forward triggered to %d\n", randomDegree);
+		tiltBodyForward(randomDegree, halRandom(2, 5 + 1) * 1000);
+        LOG_INFO("HuyangBody::doRandomTiltForward - New random tilt forward triggered to %d", randomDegree);
 	}
 }
 
@@ -205,7 +209,7 @@ void HuyangBody::doRandomTiltSideways()
 {
 	if (_randomDoTiltSideways == 0)
 	{
-		_randomDoTiltSideways = _currentMillis + 3000 + (random(5, 10 + 1) * 1100);
+		_randomDoTiltSideways = _currentMillis + 3000 + (halRandom(5, 10 + 1) * 1100);
 	}
 
 	if (_currentMillis > _randomDoTiltSideways)
@@ -213,16 +217,16 @@ void HuyangBody::doRandomTiltSideways()
 		_randomDoTiltSideways = 0;
 
 		int16_t randomDegree;
-		if (random(0, 2) == 0) // Randomly choose direction
+		if (halRandom(0, 2) == 0) // Randomly choose direction
 		{
-			randomDegree = -(random(10, 80 + 1)); // Tilt left within -90 range
+			randomDegree = -(halRandom(10, 80 + 1)); // Tilt left within -90 range
 		}
 		else
 		{
-			randomDegree = random(10, 80 + 1); // Tilt right within 90 range
+			randomDegree = halRandom(10, 80 + 1); // Tilt right within 90 range
 		}
-		tiltBodySideways(randomDegree);
-        Serial.printf("HuyangBody::doRandomTiltSideways - New random tilt sideways triggered to %d\n", randomDegree);
+		tiltBodySideways(randomDegree, halRandom(2, 5 + 1) * 1000);
+        LOG_INFO("HuyangBody::doRandomTiltSideways - New random tilt sideways triggered to %d", randomDegree);
 	}
 }
 
@@ -231,38 +235,40 @@ void HuyangBody::doRandomTiltSideways()
 // Main function to update chest light behavior based on currentLightMode
 void HuyangBody::updateChestLights()
 {
+	unsigned long now = halMillis(); // Runs independent of loop(), so it keeps its own time
+
 	switch (currentLightMode)
 	{
 	case LIGHT_OFF:
 		setAllLights(0); // Turn all pixels off (black color)
 		break;
 	case LIGHT_STATIC_BLUE: // New case for static blue
-		setAllLights(_neoPixelLights->Color(0, 0, 255)); // Blue color
+		setAllLights(LedStrip::color(0, 0, 255)); // Blue color
 		break;
 	case LIGHT_WARNING_BLINK: // New case for warning blink (Red/Blue alternating)
-		if (_currentMillis - _lastLightToggleMillis > _blinkInterval)
+		if (now - _lastLightToggleMillis > _blinkInterval)
 		{
-			_lastLightToggleMillis = _currentMillis;
-			if (_neoPixelLights->getPixelColor(0) == _neoPixelLights->Color(255, 0, 0)) // If red
+			_lastLightToggleMillis = now;
+			if (_neoPixelLights->getPixelColor(0) == LedStrip::color(255, 0, 0)) // If red
 			{
-				setAllLights(_neoPixelLights->Color(0, 0, 255)); // Set to blue
+				setAllLights(LedStrip::color(0, 0, 255)); // Set to blue
 			}
 			else
 			{
-				setAllLights(_neoPixelLights->Color(255, 0, 0)); // Set to red
+				setAllLights(LedStrip::color(255, 0, 0)); // Set to red
 			}
 		}
 		break;
 	case LIGHT_PROCESSING_FADE: // Placeholder for more complex fade animation
 		// Implement fading logic here
 		// For now, a simple pulse or static color
-		setAllLights(_neoPixelLights->Color(0, 255, 255)); // Cyan for processing
+		setAllLights(LedStrip::color(0, 255, 255)); // Cyan for processing
 		break;
 	case LIGHT_DROID_MODE_1: // Placeholder for Droid Mode 1
-		setAllLights(_neoPixelLights->Color(255, 128, 0)); // Orange
+		setAllLights(LedStrip::color(255, 128, 0)); // Orange
 		break;
 	case LIGHT_DROID_MODE_2: // Placeholder for Droid Mode 2
-		setAllLights(_neoPixelLights->Color(128, 0, 255)); // Purple
+		setAllLights(LedStrip::color(128, 0, 255)); // Purple
 		break;
 	default:
 		setAllLights(0); // Default to off
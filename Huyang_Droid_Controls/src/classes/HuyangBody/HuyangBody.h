@@ -2,14 +2,23 @@
 #define HuyangBody_h
 
 #include "Arduino.h"
-#include <Adafruit_PWMServoDriver.h> // For servo motor control
-#include <Adafruit_NeoPixel.h>       // For NeoPixel (chest lights) control
+#include "../../submodules/Hal/PwmOutput.h" // Servo outputs (PCA9685)
+#include "../../submodules/Hal/LedStrip.h"  // Chest lights (NeoPixel)
+#include "../ServoFrame/ServoFrame.h"        // Buffered servo outputs
+#include "../EasingServo/EasingServo.h"      // Eased servo movements, same as the neck
 #include "../../submodules/WebServer/WebServer.h" // NEW: Include WebServer.h for LightMode enum
 
 // Servo Parameters for PCA9685 PWM Driver
 #define HuyangBody_SERVOMIN 150   // This is the 'minimum' pulse length count (out of 4096)
 #define HuyangBody_SERVOMAX 595   // This is the 'maximum' pulse length count (out of 4096)
 #define HuyangBody_SERVO_FREQ 60 // Analog servos typically run at ~50 Hz updates
+#define HuyangBody_MOVE_MILLIS 1000   // Default duration of a body movement
+#define HuyangBody_CENTER_MILLIS 1500 // Duration of each centering step
+
+// Motion limits of the body axes (trapezoid profile), bounding the peak current of the 60kg/80kg servos.
+// With a limited profile the durations above are not used.
+#define HuyangBody_MAX_VELOCITY 45       // degrees per second
+#define HuyangBody_MAX_ACCELERATION 90   // degrees per second^2
 
 // PWM channel pins for body servos on the PCA9685 board
 #define pwm_pin_sideway_left (uint8_t)14  // Left body sideways tilt servo
@@ -26,13 +35,14 @@
 class HuyangBody
 {
 public:
-    // Constructor: Takes a pointer to the PWM driver instance
-    HuyangBody(Adafruit_PWMServoDriver *pwm);
+    // Constructor: Takes a pointer to the PWM driver instance (setup), the buffered outputs (movements)
+    // and the chest light strip
+    HuyangBody(PwmOutput *pwm, ServoFrame *frame, LedStrip *lights);
 
     // Setup function: Initializes servos to center and NeoPixels
     void setup();
 
-    // Main loop function: Called repeatedly to update body state and animations
+    // Main loop function: Called repeatedly to update the body movements
     void loop();
 
     // Flag to enable/disable automatic body movements
@@ -44,22 +54,23 @@ public:
     int16_t calibrationTiltSideways = 0;
 
     // --- Body Movement Control Functions ---
-    // These functions take a degree value (e.g., -90 to 90) and move the corresponding servo(s)
-    void tiltBodySideways(int16_t degree);
-    void tiltBodyForward(int16_t degree);
-    void rotateBody(int16_t degree);
+    // These functions take a degree value (e.g., -90 to 90) and ease the corresponding servo(s) there
+    void tiltBodySideways(int16_t degree, double duration = HuyangBody_MOVE_MILLIS);
+    void tiltBodyForward(int16_t degree, double duration = HuyangBody_MOVE_MILLIS);
+    void rotateBody(int16_t degree, double duration = HuyangBody_MOVE_MILLIS);
 
-    // Function to center all body servos
+    // Function to center all body servos, one axis after the other (continued by loop())
     void centerAll();
 
     // --- NEW: Chest Light Control ---
     // The LightMode enum is now defined in WebServer.h and included above.
     LightMode currentLightMode = LIGHT_STATIC_BLUE; // Current operating mode for chest lights
-    void updateChestLights(); // Function to manage chest light behavior
+    void updateChestLights(); // Function to manage chest light behavior, called periodically by the sketch
 
 private:
-    Adafruit_PWMServoDriver *_pwm;      // Pointer to the PWM driver instance
-    Adafruit_NeoPixel *_neoPixelLights; // Pointer to the NeoPixel object
+    PwmOutput *_pwm;                    // Pointer to the PWM driver instance
+    ServoFrame *_frame;                 // Servo outputs, written by the sketch once per loop() pass
+    LedStrip *_neoPixelLights;          // Pointer to the NeoPixel strip
 
     unsigned long _currentMillis = 0;   // Current time in milliseconds
     unsigned long _previousMillis = 0;  // Previous time for general timing
@@ -73,12 +84,25 @@ private:
     unsigned long _lastLightToggleMillis = 0;
     uint16_t _blinkInterval = 500; // Milliseconds for blink interval
 
-    // Private helper methods
-    // Maps a degree value to a PWM pulselength and sends it to the specified servo pin
-    void rotateServo(uint8_t servo, uint16_t degree);
+    // EasingServo instances for smooth movements.
+    // The forward and sideways axes each have two opposing servos, the second one is driven mirrored.
+    EasingServo *_rotateServo;
+    EasingServo *_tiltForwardServo;
+    EasingServo *_tiltSidewaysServo;
+
+    // Centering sequence started by centerAll(): sideways, then forward, then rotation
+    enum CenterStep {
+        CENTER_DONE = 0,
+        CENTER_SIDEWAYS = 1,
+        CENTER_FORWARD = 2,
+        CENTER_ROTATE = 3
+    };
+    CenterStep _centerStep = CENTER_DONE;
 
-    // Internal update functions for easing (if applicable, current body movements are direct)
-    // Add similar easing variables and functions here if smoothing is desired for body movements.
+    // Private helper methods
+    // Converts a user degree (-90 to 90) plus calibration to the 0-180 servo range
+    int16_t mapDegree(int16_t degree, int16_t calibration);
+    void updateCentering();
 
     // Functions for generating random movements
     void doRandomRotate();
@@ -2,7 +2,9 @@
 #define HuyangFace_h
 
 #include "Arduino.h"
-#include <Arduino_GFX_Library.h> // For TFT displays (eyes)
+#include "../../submodules/Hal/PixelDisplay.h" // For TFT displays (eyes)
+#include "../EyeCompositor/EyeCompositor.h" // Only changed pixel spans are pushed to the displays
+#include "../EyeAnimator/EyeAnimator.h" // Keyframe tweening of the eye geometry
 
 // Define eye states (enum)
 enum EyeState {
@@ -15,11 +17,18 @@ enum EyeState {
     EYE_STATE_ANGRY = 6
 };
 
+// Eye transitions are keyframe animations, rendered incrementally by loop()
+#define HuyangFace_ANIMATION_FRAME_MILLIS 20     // min. time between two animation frames (50 fps)
+#define HuyangFace_MOOD_MILLIS 400               // Time to ease from one mood to the next
+#define HuyangFace_BLINK_CLOSE_MILLIS 90         // Blink: lids closing
+#define HuyangFace_BLINK_HOLD_MILLIS 60          // Blink: lids staying closed
+#define HuyangFace_BLINK_OPEN_MILLIS 140         // Blink: lids opening again
+
 class HuyangFace
 {
 public:
     // Constructor: Takes pointers to the left and right eye display instances
-    HuyangFace(Arduino_GFX *left, Arduino_GFX *right);
+    HuyangFace(PixelDisplay *left, PixelDisplay *right);
 
     // Setup function: Initializes eye displays
     void setup();
@@ -40,15 +49,19 @@ public:
     EyeState getStateFrom(uint16_t stateValue);
 
 private:
-    Arduino_GFX *_leftEye;  // Pointer to the left eye display instance
-    Arduino_GFX *_rightEye; // Pointer to the right eye display instance
+    PixelDisplay *_leftEye;  // Pointer to the left eye display instance
+    PixelDisplay *_rightEye; // Pointer to the right eye display instance
+
+    // Push only the changed parts of each eye's scene to its display
+    EyeCompositor *_leftCompositor = nullptr;
+    EyeCompositor *_rightCompositor = nullptr;
 
     unsigned long _currentMillis = 0;  // Current time in milliseconds
     unsigned long _previousMillis = 0; // Previous time for general timing
 
     // Eye animation state variables
-    EyeState _currentLeftEyeState = EYE_STATE_OPEN;  // Current actual state of the left eye
-    EyeState _currentRightEyeState = EYE_STATE_OPEN; // Current actual state of the right eye
+    EyeState _currentLeftEyeState = EYE_STATE_NONE;  // Mood the left eye shows or is easing towards
+    EyeState _currentRightEyeState = EYE_STATE_NONE; // Mood the right eye shows or is easing towards
 
     // Target states for easing/transitions (what the eye *should* be doing)
     EyeState _leftEyeTargetState = EYE_STATE_OPEN;
@@ -58,6 +71,11 @@ private:
     EyeState _leftEyeLastSelectedState = EYE_STATE_OPEN;
     EyeState _rightEyeLastSelectedState = EYE_STATE_OPEN;
 
+    // Eye geometry, tweened between mood poses and through blinks
+    EyeAnimator _leftAnimator;
+    EyeAnimator _rightAnimator;
+    unsigned long _lastAnimationMillis = 0;
+
     // Timers for blinking and other animations
     unsigned long _lastBlinkMillis = 0;
     uint16_t _blinkInterval = 5000; // Default blink every 5 seconds
@@ -74,35 +92,17 @@ private:
     // Default eye color (used for open eyes, etc.)
     uint16_t _huyangEyeColor = 0x07E0; // A green color (RGB565 format)
 
-    // Private helper functions for drawing eye states (declared here, defined in HuyangFace.cpp or HuyangFace_moods.cpp)
-    void drawEye(Arduino_GFX *eye, EyeState state); // Generic drawing function
-    
-    // Specific drawing functions (defined in HuyangFace.cpp)
-    void drawOpenEye(Arduino_GFX *eye);
-    void drawClosedEye(Arduino_GFX *eye);
-    void drawFocusEye(Arduino_GFX *eye);
-    void drawSadEye(Arduino_GFX *eye);
-    void drawAngryEye(Arduino_GFX *eye);
-    void drawBlinkAnimation(Arduino_GFX *eye); // Handles the animation steps for blinking
-
-    // Loop functions for specific moods (defined in HuyangFace_moods.cpp)
-    void openEyesLoop();
-    void closeEyesLoop();
-    void focusEyesLoop();
-    void sadEyesLoop();
-    void angryEyesLoop();
-
-    // Direct drawing functions (defined in HuyangFace_moods.cpp)
-    void openEyes(uint16_t color);
-    void openEye(Arduino_GFX *eye, uint16_t color);
-    void closeEyes(uint16_t color);
-    void closeEye(Arduino_GFX *eye, uint16_t color);
-    void focusEyes(uint16_t color);
-    void focusEye(Arduino_GFX *eye, uint16_t color);
-    void sadEyes(uint16_t color);
-    void sadEye(Arduino_GFX *eye, bool inner, uint16_t color); // Added 'inner' parameter
-    void angryEyes(uint16_t color);
-    void angryEye(Arduino_GFX *eye, bool inner, uint16_t color); // Added 'inner' parameter
+    // Private helper functions describing eye states (defined in HuyangFace.cpp)
+    EyeScene sceneFor(const EyePose &pose); // Scene showing a pose in the eye colors
+    EyeScene composeEye(PixelDisplay *eye);  // Scene an eye should show right now
+    void presentEye(PixelDisplay *eye);      // Pushes the changes of composeEye() to the display
+
+    // Mood poses and transitions (defined in HuyangFace_moods.cpp)
+    EyePose poseFor(EyeState state);        // Resting pose of a mood, scaled to the display
+    EyeAnimator &animatorFor(PixelDisplay *eye);
+    void updateEyeMood(PixelDisplay *eye, EyeState targetState, EyeState &currentState);
+    void blinkEye(PixelDisplay *eye);
+    void advanceEyeAnimations();
     
     // Private functions for random eye movements/animations
     void doRandomBlink();
@@ -1,22 +1,28 @@
 #include "HuyangNeck.h" // In the same folder
-#include <Adafruit_PWMServoDriver.h>
 #include "../EasingServo/EasingServo.h" // Corrected: Path to EasingServo.h from HuyangNeck.cpp
 #include <Arduino.h> // For Serial.println
+#include "../../submodules/Log/Log.h" // Serial messages of the servo task
 
-HuyangNeck::HuyangNeck(Adafruit_PWMServoDriver *pwm)
+HuyangNeck::HuyangNeck(PwmOutput *pwm, ServoFrame *frame)
 {
 	_pwm = pwm;
+	_frame = frame;
 
     // Initialize EasingServo instances for neck movements
     // Parameters: pwm driver, servo pin, min degree, max degree, start degree
     // EasingServo is designed to work with a 0-180 range internally for standard servos.
     // The mapping from -90 to 90 degrees will be handled *before* passing to moveServoTo.
-    _neckRotateServo = new EasingServo(_pwm, pwm_pin_head_rotate, 0, 180, 90); // 0-180 degrees, start at 90 (center)
-    _neckTiltForwardServo = new EasingServo(_pwm, pwm_pin_head_neck, 0, 180, 90); // 0-180 degrees, start at 90 (center)
-    _neckTiltSidewaysServo = new EasingServo(_pwm, pwm_pin_head_left, 0, 180, 90); // 0-180 degrees, start at 90 (center)
+    _neckRotateServo = new EasingServo(_frame, pwm_pin_head_rotate, 0, 180, 90); // 0-180 degrees, start at 90 (center)
+    _neckTiltForwardServo = new EasingServo(_frame, pwm_pin_head_neck, 0, 180, 90); // 0-180 degrees, start at 90 (center)
+    _neckTiltSidewaysServo = new EasingServo(_frame, pwm_pin_head_left, 0, 180, 90); // 0-180 degrees, start at 90 (center)
+
+    // Rotation and tilt follow their targets velocity and acceleration limited instead of in a fixed time
+    _neckRotateServo->setProfile(EASING_PROFILE_SCURVE, HuyangNeck_MAX_VELOCITY, HuyangNeck_MAX_ACCELERATION, HuyangNeck_MAX_JERK);
+    _neckTiltForwardServo->setProfile(EASING_PROFILE_SCURVE, HuyangNeck_MAX_VELOCITY, HuyangNeck_MAX_ACCELERATION, HuyangNeck_MAX_JERK);
+    _neckTiltSidewaysServo->setProfile(EASING_PROFILE_SCURVE, HuyangNeck_MAX_VELOCITY, HuyangNeck_MAX_ACCELERATION, HuyangNeck_MAX_JERK);
 
     // NEW: Initialize EasingServo for monocle
-    _monocleServo = new EasingServo(_pwm, pwm_pin_head_monocle, 0, 180, 0); // Example: 0-180 degrees, start at 0 (retracted)
+    _monocleServo = new EasingServo(_frame, pwm_pin_head_monocle, 0, 180, 0); // Example: 0-180 degrees, start at 0 (retracted)
 }
 
 void HuyangNeck::setup()
@@ -29,10 +35,10 @@ void HuyangNeck::setup()
     
     // Set initial positions for all servos using their public rotateServo method
     // These will be relative to their 0-180 range, with 90 being mechanical center for neck.
-    _neckRotateServo->rotateServo(_neckRotateServo->currentDegree);
-    _neckTiltForwardServo->rotateServo(_neckTiltForwardServo->currentDegree);
-    _neckTiltSidewaysServo->rotateServo(_neckTiltSidewaysServo->currentDegree);
-    _monocleServo->rotateServo(_monocleServo->currentDegree); // Set initial monocle position
+    _neckRotateServo->rotateServo(_neckRotateServo->currentDegree());
+    _neckTiltForwardServo->rotateServo(_neckTiltForwardServo->currentDegree());
+    _neckTiltSidewaysServo->rotateServo(_neckTiltSidewaysServo->currentDegree());
+    _monocleServo->rotateServo(_monocleServo->currentDegree()); // Set initial monocle position
     Serial.println("HuyangNeck: Servos initialized to default positions.");
 }
 
@@ -83,56 +89,56 @@ double HuyangNeck::easeInAndOut(double start, double current, double target, dou
 // Public method to set target rotation for the head
 void HuyangNeck::rotateHead(double degree, double duration)
 {
-    Serial.printf("HuyangNeck::rotateHead: Input degree (User -90 to 90): %.2f\n", degree);
+    LOG_DEBUG("HuyangNeck::rotateHead: Input degree (User -90 to 90): %.2f", degree);
     // Convert -90 to 90 degree range to 0 to 180 range for EasingServo, then apply calibration
     double mappedDegree = degree + 90.0 + calibrationRotate;
     // Clamp to 0-180 to prevent issues with servo limits
     if (mappedDegree < 0) mappedDegree = 0;
     if (mappedDegree > 180) mappedDegree = 180;
     
-    Serial.printf("HuyangNeck::rotateHead: Mapped to 0-180 range (with cal): %.2f, Duration: %.0f\n", mappedDegree, duration);
+    LOG_DEBUG("HuyangNeck::rotateHead: Mapped to 0-180 range (with cal): %.2f, Duration: %.0f", mappedDegree, duration);
     _neckRotateServo->moveServoTo(mappedDegree, duration);
 }
 
 // Public method to set target forward tilt for the neck
 void HuyangNeck::tiltNeckForward(double degree, double duration)
 {
-    Serial.printf("HuyangNeck::tiltNeckForward: Input degree (User -90 to 90): %.2f\n", degree);
+    LOG_DEBUG("HuyangNeck::tiltNeckForward: Input degree (User -90 to 90): %.2f", degree);
     // Convert -90 to 90 degree range to 0 to 180 range for EasingServo, then apply calibration
     double mappedDegree = degree + 90.0 + calibrationTiltForward;
     // Clamp to 0-180
     if (mappedDegree < 0) mappedDegree = 0;
     if (mappedDegree > 180) mappedDegree = 180;
 
-    Serial.printf("HuyangNeck::tiltNeckForward: Mapped to 0-180 range (with cal): %.2f, Duration: %.0f\n", mappedDegree, duration);
+    LOG_DEBUG("HuyangNeck::tiltNeckForward: Mapped to 0-180 range (with cal): %.2f, Duration: %.0f", mappedDegree, duration);
     _neckTiltForwardServo->moveServoTo(mappedDegree, duration);
 }
 
 // Public method to set target sideways tilt for the neck
 void HuyangNeck::tiltNeckSideways(double degree, double duration)
 {
-    Serial.printf("HuyangNeck::tiltNeckSideways: Input degree (User -90 to 90): %.2f\n", degree);
+    LOG_DEBUG("HuyangNeck::tiltNeckSideways: Input degree (User -90 to 90): %.2f", degree);
     // Convert -90 to 90 degree range to 0 to 180 range for EasingServo, then apply calibration
     double mappedDegree = degree + 90.0 + calibrationTiltSideways;
     // Clamp to 0-180
     if (mappedDegree < 0) mappedDegree = 0;
     if (mappedDegree > 180) mappedDegree = 180;
 
-    Serial.printf("HuyangNeck::tiltNeckSideways: Mapped to 0-180 range (with cal): %.2f, Duration: %.0f\n", mappedDegree, duration);
+    LOG_DEBUG("HuyangNeck::tiltNeckSideways: Mapped to 0-180 range (with cal): %.2f, Duration: %.0f", mappedDegree, duration);
     _neckTiltSidewaysServo->moveServoTo(mappedDegree, duration);
 }
 
 // NEW: Public method to set target position for the monocle
 void HuyangNeck::setMonoclePosition(int16_t position, double duration)
 {
-    Serial.printf("HuyangNeck::setMonoclePosition: Input position (raw, e.g., 0-180): %d\n", position);
+    LOG_DEBUG("HuyangNeck::setMonoclePosition: Input position (raw, e.g., 0-180): %d", position);
     // Monocle position is assumed to be in the 0-180 range already from the UI or fixed values
     double finalPosition = position + calibrationMonocle;
     // Clamp to 0-180
     if (finalPosition < 0) finalPosition = 0;
     if (finalPosition > 180) finalPosition = 180;
 
-    Serial.printf("HuyangNeck::setMonoclePosition: Final position (with cal): %.2f, Duration: %.0f\n", finalPosition, duration);
+    LOG_DEBUG("HuyangNeck::setMonoclePosition: Final position (with cal): %.2f, Duration: %.0f", finalPosition, duration);
     _monocleServo->moveServoTo(finalPosition, duration);
 }
 
@@ -149,9 +155,9 @@ void HuyangNeck::updateNeckPosition()
 
 void HuyangNeck::loop()
 {
-	_currentMillis = millis();
+	_currentMillis = halMillis();
 
-	// Handle millis() rollover
+	// Handle halMillis() rollover
 	if (_previousMillis > _currentMillis)
 	{
 		_previousMillis = _currentMillis;
@@ -175,7 +181,7 @@ void HuyangNeck::doRandomRotate()
 	if (_randomDoRotate == 0) // If no random rotation is scheduled
 	{
 		// Schedule next random rotation after an initial delay + random interval
-		_randomDoRotate = _currentMillis + 2000 + (random(5, 10 + 1) * 1000);
+		_randomDoRotate = _currentMillis + 2000 + (halRandom(5, 10 + 1) * 1000);
 	}
 
 	if (_currentMillis > _randomDoRotate) // If scheduled time has passed
@@ -183,9 +189,9 @@ void HuyangNeck::doRandomRotate()
 		_randomDoRotate = 0; // Reset schedule
 
 		// Generate random degree in -90 to 90 range
-		double randomDegree = random(-90, 90 + 1); // +1 to include max
-		rotateHead(randomDegree, random(2, 5 + 1) * 1000);
-        Serial.printf("HuyangNeck::doRandomRotate - New random rotation triggered to %.2f\n", randomDegree);
+		double randomDegree = halRandom(-90, 90 + 1); // +1 to include max
+		rotateHead(randomDegree, halRandom(2, 5 + 1) * 1000);
+        LOG_INFO("HuyangNeck::doRandomRotate - New random rotation triggered to %.2f", randomDegree);
 	}
 }
 
@@ -194,7 +200,7 @@ void HuyangNeck::doRandomTiltForward()
 	if (_randomDoTiltForward == 0) // If no random forward tilt is scheduled
 	{
 		// Schedule next random tilt after an initial delay + random interval
-		_randomDoTiltForward = _currentMillis + 2500 + (random(6, 12 + 1) * 1050);
+		_randomDoTiltForward = _currentMillis + 2500 + (halRandom(6, 12 + 1) * 1050);
 	}
 
 	if (_currentMillis > _randomDoTiltForward) // If scheduled time has passed
@@ -202,9 +208,9 @@ void HuyangNeck::doRandomTiltForward()
 		_randomDoTiltForward = 0; // Reset schedule
 
 		// Generate random degree in -90 to 90 range
-		double randomDegree = random(-90, 90 + 1);
-		tiltNeckForward(randomDegree, random(3, 6 + 1) * 1000);
-        Serial.printf("HuyangNeck::doRandomTiltForward - New random tilt forward triggered to %.2f\n", randomDegree);
+		double randomDegree = halRandom(-90, 90 + 1);
+		tiltNeckForward(randomDegree, halRandom(3, 6 + 1) * 1000);
+        LOG_INFO("HuyangNeck::doRandomTiltForward - New random tilt forward triggered to %.2f", randomDegree);
 	}
 }
 
@@ -214,7 +220,7 @@ void HuyangNeck::doRandomTiltSideways()
 	if (_randomDoTiltSideways == 0) // If no random sideways tilt is scheduled
 	{
 		// Schedule next random tilt after an initial delay + random interval
-		_randomDoTiltSideways = _currentMillis + 3000 + (random(5, 10 + 1) * 1100);
+		_randomDoTiltSideways = _currentMillis + 3000 + (halRandom(5, 10 + 1) * 1100);
 	}
 
 	if (_currentMillis > _randomDoTiltSideways) // If scheduled time has passed
@@ -222,8 +228,8 @@ void HuyangNeck::doRandomTiltSideways()
 		_randomDoTiltSideways = 0; // Reset schedule
 
 		// Generate random degree in -90 to 90 range
-		double randomDegree = random(-90, 90 + 1);
-		tiltNeckSideways(randomDegree, random(2, 5 + 1) * 1000);
-        Serial.printf("HuyangNeck::doRandomTiltSideways - New random tilt sideways triggered to %.2f\n", randomDegree);
+		double randomDegree = halRandom(-90, 90 + 1);
+		tiltNeckSideways(randomDegree, halRandom(2, 5 + 1) * 1000);
+        LOG_INFO("HuyangNeck::doRandomTiltSideways - New random tilt sideways triggered to %.2f", randomDegree);
 	}
 }
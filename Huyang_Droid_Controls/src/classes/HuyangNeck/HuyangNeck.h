@@ -2,14 +2,20 @@
 #define HuyangNeck_h
 
 #include "Arduino.h"
-#include <Adafruit_PWMServoDriver.h>
 #include "../EasingServo/EasingServo.h" // Corrected: Now directly in 'src' folder
+#include "../ServoFrame/ServoFrame.h"
+#include "../../submodules/Hal/PwmOutput.h" // Servo outputs (PCA9685)
 
 // Servo Parameters for PCA9685 PWM Driver
 #define HuyangNeck_SERVOMIN 150  // This is the 'minimum' pulse length count (out of 4096)
 #define HuyangNeck_SERVOMAX 595  // This is the 'maximum' pulse length count (out of 4096)
 #define HuyangNeck_SERVO_FREQ 60 // Analog servos typically run at ~50 Hz updates, 60 is fine for PCA9685
 
+// Motion limits of the neck servos (S-curve profile), so joystick targets are tracked without stutter
+#define HuyangNeck_MAX_VELOCITY 120      // degrees per second
+#define HuyangNeck_MAX_ACCELERATION 360  // degrees per second^2
+#define HuyangNeck_MAX_JERK 2400         // degrees per second^3
+
 // PWM channel pins for neck servos on the PCA9685 board
 #define pwm_pin_head_monocle (uint8_t)4 // Servo for monacle movement
 #define pwm_pin_head_left (uint8_t)5    // Left neck servo for tilt
@@ -20,8 +26,8 @@
 class HuyangNeck
 {
 public:
-    // Constructor: takes a pointer to the PWM driver
-    HuyangNeck(Adafruit_PWMServoDriver *pwm);
+    // Constructor: takes a pointer to the PWM driver (setup) and the buffered outputs (movements)
+    HuyangNeck(PwmOutput *pwm, ServoFrame *frame);
 
     // Setup function: performs initial servo centering or setup
     void setup();
@@ -45,7 +51,8 @@ public:
     int16_t calibrationMonocle = 0; // NEW: Calibration for monocle
 
 private:
-    Adafruit_PWMServoDriver *_pwm; // Pointer to the PWM driver instance
+    PwmOutput *_pwm;               // Pointer to the PWM driver instance
+    ServoFrame *_frame;            // Servo outputs, written by the sketch once per loop() pass
 
     unsigned long _currentMillis = 0;  // Current time in milliseconds
     unsigned long _previousMillis = 0; // Previous time for general timing
@@ -0,0 +1,56 @@
+#include "ServoFrame.h" // In the same folder
+#include <Arduino.h>
+
+ServoFrame::ServoFrame(PwmOutput *output)
+{
+    _output = output;
+    memset(_on, 0, sizeof(_on));
+    memset(_off, 0, sizeof(_off));
+    memset(_writtenOn, 0, sizeof(_writtenOn));
+    memset(_writtenOff, 0, sizeof(_writtenOff));
+}
+
+void ServoFrame::setPWM(uint8_t channel, uint16_t on, uint16_t off)
+{
+    if (channel >= ServoFrame_CHANNELS) return;
+
+    _on[channel] = on;
+    _off[channel] = off;
+
+    uint16_t bit = 1 << channel;
+    if ((_written & bit) && _writtenOn[channel] == on && _writtenOff[channel] == off)
+    {
+        // The output already shows this value (this also drops a pending change that was reverted)
+        _dirty &= ~bit;
+        suppressedWrites++;
+        return;
+    }
+    _dirty |= bit;
+}
+
+void ServoFrame::flush()
+{
+    uint8_t channel = 0;
+    while (_dirty != 0 && channel < ServoFrame_CHANNELS)
+    {
+        if (!(_dirty & (1 << channel)))
+        {
+            channel++;
+            continue;
+        }
+
+        // Burst the whole run of changed channels starting here
+        uint8_t first = channel;
+        while (channel < ServoFrame_CHANNELS && (_dirty & (1 << channel)))
+        {
+            _writtenOn[channel] = _on[channel];
+            _writtenOff[channel] = _off[channel];
+            _written |= (1 << channel);
+            _dirty &= ~(1 << channel);
+            issuedWrites++;
+            channel++;
+        }
+        _output->writeChannels(first, &_on[first], &_off[first], channel - first);
+        transactions++;
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef ServoFrame_h
+#define ServoFrame_h
+
+#include "Arduino.h"
+#include "../../submodules/Hal/PwmOutput.h" // The PCA9685, or a recording stand-in on the host
+
+#define ServoFrame_CHANNELS PwmOutput_CHANNELS
+
+// Collects the PWM values of all 16 PCA9685 channels during a loop() pass and writes them in flush().
+// Each run of neighbouring changed channels is one PwmOutput::writeChannels() call, which is one
+// I2C transaction on the robot.
+// The last value written to every channel is remembered, so setting a channel to the value it
+// already has costs no I2C traffic at all.
+class ServoFrame
+{
+public:
+    ServoFrame(PwmOutput *output);
+
+    // Same parameters as Adafruit_PWMServoDriver::setPWM(), but only buffered until flush()
+    void setPWM(uint8_t channel, uint16_t on, uint16_t off);
+
+    // Writes all channels changed since the last flush
+    void flush();
+
+    // Statistics for tuning
+    uint32_t transactions = 0;     // Bus transactions issued by flush()
+    uint32_t issuedWrites = 0;     // Channels written by flush()
+    uint32_t suppressedWrites = 0; // setPWM() calls that matched the value the channel already has
+
+private:
+    PwmOutput *_output;
+
+    uint16_t _on[ServoFrame_CHANNELS];
+    uint16_t _off[ServoFrame_CHANNELS];
+    uint16_t _dirty = 0; // One bit per channel that differs from what was written
+
+    // Last values written to the PCA9685
+    uint16_t _writtenOn[ServoFrame_CHANNELS];
+    uint16_t _writtenOff[ServoFrame_CHANNELS];
+    uint16_t _written = 0; // One bit per channel whose written value is known
+};
+
+#endif
@@ -16,6 +16,10 @@
 #include "classes/HuyangAudio/HuyangAudio.h"      // For audio playback
 #include "submodules/WebServer/WebServer.h"       // Corrected path for the web interface (from src/submodules/WebServer/)
 #include "classes/EasingServo/EasingServo.h"      // For easing servo (from src/classes/EasingServo/)
+#include "classes/ServoFrame/ServoFrame.h"        // For batched PCA9685 writes
+#include "submodules/Scheduler/Scheduler.h"       // For the periodic subsystem tasks
+#include "submodules/LoopMetrics/LoopMetrics.h"   // For the loop section timings
+#include "submodules/Hal/Hal.h"                   // Driver interfaces of the subsystems
 
 
 // Global variables for time tracking (extern declarations)
@@ -37,6 +41,13 @@ extern Arduino_GFX *rightEye;
 // PWM Servo Driver (PCA9685) instance (extern declaration)
 extern Adafruit_PWMServoDriver *pwm;
 
+// Driver interfaces handed to the subsystems (see src/submodules/Hal)
+extern PixelDisplay *leftEyeDisplay;
+extern PixelDisplay *rightEyeDisplay;
+extern PwmOutput *pwmOutput;
+extern LedStrip *chestLights;
+extern ServoFrame *servoFrame; // Buffered servo outputs, flushed once per servo task run
+
 // Huyang Robot Subsystem Instances (extern declarations)
 extern HuyangFace *huyangFace;
 extern HuyangBody *huyangBody;
@@ -46,9 +57,15 @@ extern HuyangAudio *huyangAudio; // Uncomment if you are using audio features
 // WebServer instance (extern declaration)
 extern WebServer *webserver;
 
+// Scheduler running the subsystem tasks (extern declaration)
+extern Scheduler *scheduler;
+
+// Timings of loop() and the subsystem loops (extern declaration)
+extern LoopMetrics *loopMetrics;
+
 // --- Global variables for robot state (extern declarations) ---
 // These are the same variables defined and updated in WebServer.cpp and used in system.h
-extern bool automaticAnimations;
+extern std::atomic<bool> automaticAnimations;
 extern uint16_t allEyes;
 extern uint16_t faceLeftEyeState;
 extern uint16_t faceRightEyeState;
@@ -80,4 +97,10 @@ extern String firmwareVersion;
 // Chest light mode (matches HuyangBody::LightMode enum)
 extern LightMode chestLightMode; // Use the enum type directly
 
+// Eye commands from the network handlers, drained by the face task
+extern SpscRing<FaceCommand, 8> faceCommands;
+
+// Neck, body, monocle and automatic mode commands from the network handlers, drained by the servo task
+extern MotionCommands motionCommands;
+
 #endif
@@ -8,6 +8,19 @@
 #include "classes/HuyangAudio/HuyangAudio.h"
 #include "submodules/JxWifiManager/JxWifiManager.h"
 #include "submodules/WebServer/WebServer.h"
+#include "submodules/AssetHandler/AssetHandler.h" // Compressed web interface files with ETag and Cache-Control
+#include "submodules/ConfigStore/ConfigStore.h" // Calibration and settings, written to flash debounced and atomically
+#include "submodules/Scheduler/Scheduler.h" // Cooperative scheduler running the subsystems from loop()
+#include "submodules/LoopMetrics/LoopMetrics.h" // Cycle counter timings of loop() and the subsystem loops
+#include "submodules/Log/Log.h" // Leveled, rate limited serial messages, printed from loop() when the port has room
+#include "submodules/SpscRing/SpscRing.h" // Lock-free queue between the network handlers and the control tasks
+#include "submodules/MotionCommands/MotionCommands.h" // Latest servo targets from the network handlers
+#include "submodules/Tasks/Tasks.h" // Face, servo and light tasks run by the Scheduler, shared with host/replay
 #include "classes/EasingServo/EasingServo.h" // Include EasingServo.h as it's a utility class
+#include "submodules/Hal/Hal.h" // Driver interfaces (PWM, eye displays, LED strip), recording versions on the host
+#include "classes/ServoFrame/ServoFrame.h" // Batched PCA9685 writes used by EasingServo, HuyangNeck and HuyangBody
+#include "classes/EyePipeline/EyePipeline.h" // Per-eye band queue, DMA driven on ESP32
+#include "classes/EyeCompositor/EyeCompositor.h" // Scene compositor used by HuyangFace
+#include "classes/EyeAnimator/EyeAnimator.h" // Keyframe tweening of the eye geometry
 
 #endif
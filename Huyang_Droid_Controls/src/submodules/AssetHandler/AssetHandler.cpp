@@ -0,0 +1,137 @@
+#include "AssetHandler.h"
+
+uint8_t AssetHandler::begin(FS &fs)
+{
+    _fs = &fs;
+    _count = 0;
+
+    File manifest = fs.open(AssetHandler_MANIFEST, "r");
+    if (!manifest)
+    {
+        Serial.println("AssetHandler: No " AssetHandler_MANIFEST ", run tools/compress_assets.py. Serving plain files.");
+        return 0;
+    }
+
+    // One line per asset: <path> <hash> <size of the original> <gz|->
+    char line[AssetHandler_MAX_PATH + AssetHandler_HASH_LENGTH + 24];
+    while (manifest.available() && _count < AssetHandler_MAX_ASSETS)
+    {
+        size_t length = manifest.readBytesUntil('\n', line, sizeof(line) - 1);
+        line[length] = '\0';
+
+        Asset &asset = _assets[_count];
+        char hash[AssetHandler_HASH_LENGTH + 1];
+        char encoding[3];
+        unsigned long size;
+        if (sscanf(line, "%47s %16s %lu %2s", asset.path, hash, &size, encoding) != 4) continue;
+        asset.gzip = strcmp(encoding, "gz") == 0;
+        snprintf(asset.etag, sizeof(asset.etag), "\"%s\"", hash);
+
+        // An original edited after the script ran would otherwise be shadowed by its stale copy
+        if (fs.exists(asset.path))
+        {
+            File original = fs.open(asset.path, "r");
+            bool changed = original.size() != size;
+            original.close();
+            if (changed)
+            {
+                Serial.printf("AssetHandler: %s changed since the manifest was written, serving it plain.\n", asset.path);
+                continue;
+            }
+        }
+        if (asset.gzip && !fs.exists(String(asset.path) + ".gz"))
+        {
+            Serial.printf("AssetHandler: %s.gz is missing, serving it plain.\n", asset.path);
+            continue;
+        }
+        _count++;
+    }
+    manifest.close();
+
+    Serial.printf("AssetHandler: %d assets in the manifest.\n", _count);
+    return _count;
+}
+
+bool AssetHandler::canHandle(AsyncWebServerRequest *request)
+{
+    if (request->method() != HTTP_GET && request->method() != HTTP_HEAD) return false;
+
+    const Asset *asset = find(request);
+    // The few clients without gzip support get the plain file from the static handler
+    if (asset == nullptr || (asset->gzip && !acceptsGzip(request))) return false;
+
+    // The server drops every header no handler asked for before handleRequest() runs
+    request->addInterestingHeader("If-None-Match");
+    return true;
+}
+
+void AssetHandler::handleRequest(AsyncWebServerRequest *request)
+{
+    const Asset *asset = find(request);
+    if (!asset)
+    {
+        request->send(404);
+        return;
+    }
+
+    // The hash in ?v= only matches while the asset has this content
+    bool versioned = request->hasParam("v") && strncmp(request->getParam("v")->value().c_str(), asset->etag + 1, AssetHandler_HASH_LENGTH) == 0;
+    const char *cacheControl = versioned ? AssetHandler_CACHE_VERSIONED : AssetHandler_CACHE_DEFAULT;
+
+    AsyncWebServerResponse *response;
+    if (request->hasHeader("If-None-Match") && request->getHeader("If-None-Match")->value() == asset->etag)
+    {
+        response = request->beginResponse(304);
+        notModified++;
+    }
+    else if (asset->gzip)
+    {
+        response = request->beginResponse(*_fs, String(asset->path) + ".gz", contentType(asset->path));
+        response->addHeader("Content-Encoding", "gzip");
+        served++;
+    }
+    else
+    {
+        response = request->beginResponse(*_fs, asset->path, contentType(asset->path));
+        served++;
+    }
+    response->addHeader("ETag", asset->etag);
+    response->addHeader("Cache-Control", cacheControl);
+    if (asset->gzip) response->addHeader("Vary", "Accept-Encoding");
+    request->send(response);
+}
+
+const AssetHandler::Asset *AssetHandler::find(AsyncWebServerRequest *request)
+{
+    const char *path = request->url().c_str();
+    if (strcmp(path, "/") == 0) path = "/index.html";
+
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        if (strcmp(_assets[i].path, path) == 0) return &_assets[i];
+    }
+    return nullptr;
+}
+
+bool AssetHandler::acceptsGzip(AsyncWebServerRequest *request)
+{
+    return request->hasHeader("Accept-Encoding") && request->getHeader("Accept-Encoding")->value().indexOf("gzip") >= 0;
+}
+
+const char *AssetHandler::contentType(const char *path)
+{
+    const char *extension = strrchr(path, '.');
+    if (!extension) return "application/octet-stream";
+    if (strcmp(extension, ".html") == 0) return "text/html";
+    if (strcmp(extension, ".js") == 0) return "application/javascript";
+    if (strcmp(extension, ".css") == 0) return "text/css";
+    if (strcmp(extension, ".json") == 0) return "application/json";
+    if (strcmp(extension, ".svg") == 0) return "image/svg+xml";
+    if (strcmp(extension, ".png") == 0) return "image/png";
+    if (strcmp(extension, ".ico") == 0) return "image/x-icon";
+    if (strcmp(extension, ".woff2") == 0) return "font/woff2";
+    if (strcmp(extension, ".woff") == 0) return "font/woff";
+    if (strcmp(extension, ".ttf") == 0) return "font/ttf";
+    if (strcmp(extension, ".txt") == 0) return "text/plain";
+    return "application/octet-stream";
+}
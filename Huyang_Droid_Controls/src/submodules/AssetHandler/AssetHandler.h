@@ -0,0 +1,51 @@
+#ifndef AssetHandler_h
+#define AssetHandler_h
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "FS.h"
+
+#define AssetHandler_MANIFEST "/assets.manifest" // Written by tools/compress_assets.py
+#define AssetHandler_MAX_ASSETS 24               // Same limits as in tools/compress_assets.py
+#define AssetHandler_MAX_PATH 47
+#define AssetHandler_HASH_LENGTH 16
+
+// Unversioned requests are revalidated every time, which the ETag turns into a 304 without flash access.
+// Links carrying the content hash (?v=<hash>, added to the compressed pages) never change their content.
+#define AssetHandler_CACHE_DEFAULT "no-cache"
+#define AssetHandler_CACHE_VERSIONED "public, max-age=31536000, immutable"
+
+// Serves the web interface from LittleFS as prepared by tools/compress_assets.py:
+// the gzip compressed copy of each asset, with the content hash from the manifest as strong ETag.
+// The manifest is kept in RAM, so a matching If-None-Match is answered with 304 without touching
+// the flash. Files missing from the manifest are left to the static file handler registered after it.
+class AssetHandler : public AsyncWebHandler
+{
+public:
+    // Loads the manifest, returns the number of assets served by this handler
+    uint8_t begin(FS &fs);
+
+    bool canHandle(AsyncWebServerRequest *request) override;
+    void handleRequest(AsyncWebServerRequest *request) override;
+
+    // Statistics for /api/system
+    uint32_t served = 0;      // Responses with content
+    uint32_t notModified = 0; // 304 responses
+
+private:
+    struct Asset {
+        char path[AssetHandler_MAX_PATH + 1];
+        char etag[AssetHandler_HASH_LENGTH + 3]; // Quoted, as sent in the header
+        bool gzip;                               // Served from path + ".gz"
+    };
+
+    FS *_fs = nullptr;
+    Asset _assets[AssetHandler_MAX_ASSETS];
+    uint8_t _count = 0;
+
+    const Asset *find(AsyncWebServerRequest *request);
+    bool acceptsGzip(AsyncWebServerRequest *request);
+    const char *contentType(const char *path);
+};
+
+#endif
@@ -0,0 +1,144 @@
+#include "ConfigStore.h"
+
+void ConfigStore::begin(FS &fs)
+{
+    _fs = &fs;
+}
+
+void ConfigStore::lock()
+{
+#if defined(ESP32)
+    portENTER_CRITICAL(&_lock);
+#endif
+}
+
+void ConfigStore::unlock()
+{
+#if defined(ESP32)
+    portEXIT_CRITICAL(&_lock);
+#endif
+}
+
+bool ConfigStore::load(ConfigData &data)
+{
+    if (!_fs || !_fs->exists(ConfigStore_FILE)) return false;
+
+    File file = _fs->open(ConfigStore_FILE, "r");
+    if (!file) return false;
+
+    Header header;
+    uint8_t payload[ConfigStore_MAX_PAYLOAD];
+    bool valid = file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+                 header.magic == ConfigStore_MAGIC &&
+                 header.length <= sizeof(payload) &&
+                 file.read(payload, header.length) == header.length &&
+                 crc32(payload, header.length) == header.crc;
+    file.close();
+
+    if (!valid)
+    {
+        Serial.println("ConfigStore: " ConfigStore_FILE " is damaged, ignoring it.");
+        return false;
+    }
+
+    // Older versions store a prefix of ConfigData, newer ones may have appended fields we skip
+    memcpy(&data, payload, header.length < sizeof(data) ? header.length : sizeof(data));
+    data.robotName[ConfigStore_NAME_LENGTH - 1] = '\0';
+
+    lock();
+    _data = data;
+    _dirty = false;
+    unlock();
+
+    Serial.printf("ConfigStore: Loaded version %u, %u bytes.\n", header.version, header.length);
+    return true;
+}
+
+void ConfigStore::update(const ConfigData &data)
+{
+    unsigned long now = halMillis();
+    lock();
+    if (memcmp(&_data, &data, sizeof(data)) != 0)
+    {
+        _data = data;
+        if (!_dirty) _firstChange = now;
+        _lastChange = now;
+        _dirty = true;
+        updates++;
+    }
+    unlock();
+}
+
+void ConfigStore::loop()
+{
+    if (!_dirty) return;
+
+    unsigned long now = halMillis();
+    if (now - _lastChange >= ConfigStore_FLUSH_DELAY || now - _firstChange >= ConfigStore_MAX_DELAY)
+    {
+        flush();
+    }
+}
+
+bool ConfigStore::flush()
+{
+    if (!_fs || !_dirty || _writing) return true;
+    _writing = true;
+
+    ConfigData data;
+    lock();
+    data = _data;
+    _dirty = false; // Changes arriving while writing mark it dirty again
+    unlock();
+
+    Header header = {ConfigStore_MAGIC, ConfigStore_VERSION, sizeof(data), crc32((const uint8_t *)&data, sizeof(data))};
+
+    bool written = false;
+    File file = _fs->open(ConfigStore_TEMP_FILE, "w");
+    if (file)
+    {
+        written = file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+                  file.write((const uint8_t *)&data, sizeof(data)) == sizeof(data);
+        file.close();
+    }
+    // LittleFS renames atomically, the old file stays valid until the new one is complete
+    written = written && _fs->rename(ConfigStore_TEMP_FILE, ConfigStore_FILE);
+
+    if (written)
+    {
+        writes++;
+        Serial.println("ConfigStore: Configuration saved.");
+    }
+    else
+    {
+        Serial.println("ConfigStore: Writing " ConfigStore_FILE " failed, retrying later.");
+        lock();
+        if (!_dirty) _firstChange = halMillis();
+        _lastChange = halMillis();
+        _dirty = true;
+        unlock();
+    }
+    _writing = false;
+    return written;
+}
+
+void ConfigStore::snapshot(ConfigData &data)
+{
+    lock();
+    data = _data;
+    unlock();
+}
+
+uint32_t ConfigStore::crc32(const uint8_t *data, size_t length)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
@@ -0,0 +1,90 @@
+#ifndef ConfigStore_h
+#define ConfigStore_h
+
+#include <Arduino.h>
+#include "FS.h"
+#include "../Hal/HalClock.h" // Debounce time, simulated on the host
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#endif
+
+#define ConfigStore_FILE "/config.bin"
+#define ConfigStore_TEMP_FILE "/config.tmp"
+#define ConfigStore_MAGIC 0x46435948UL   // "HYCF"
+#define ConfigStore_VERSION 1            // Increase when ConfigData changes, fields are only ever appended
+#define ConfigStore_MAX_PAYLOAD 128      // Largest payload accepted from the file
+#define ConfigStore_FLUSH_DELAY 2000     // Written once the values did not change for this long (ms)
+#define ConfigStore_MAX_DELAY 10000      // ... but no later than this after the first change (ms)
+#define ConfigStore_NAME_LENGTH 32       // Including the terminating 0
+
+// Calibration and settings as kept in RAM and stored in ConfigStore_FILE
+struct ConfigData {
+    int16_t neckRotation;
+    int16_t neckTiltForward;
+    int16_t neckTiltSideways;
+    int16_t bodyRotation;
+    int16_t bodyTiltForward;
+    int16_t bodyTiltSideways;
+    int16_t monoclePosition;
+    int16_t masterMovementSpeed;
+    char robotName[ConfigStore_NAME_LENGTH];
+};
+
+// Persists the ConfigData snapshot handed over by the web handlers.
+// update() only copies the snapshot and marks it dirty, loop() writes it once the values settled,
+// so a slider sending dozens of requests per second costs one flash write. Writes go to a
+// temporary file that is then renamed over the old one, so a reset in the middle of a write
+// leaves the previous configuration intact. The file is a small header (magic, version, length,
+// CRC32) followed by the raw ConfigData, which loads without any parsing at boot.
+class ConfigStore
+{
+public:
+    void begin(FS &fs);
+
+    // Reads the stored configuration into data, returns false if there is none or it is damaged.
+    // Fields missing in files of older versions keep the values data had before.
+    bool load(ConfigData &data);
+
+    // Hands over the current values, called from the web handlers
+    void update(const ConfigData &data);
+
+    // Writes pending changes once they settled, called periodically
+    void loop();
+
+    // Writes pending changes right away, e.g. before a reboot. Returns false if writing failed.
+    bool flush();
+
+    // Copy of the latest values, written or not
+    void snapshot(ConfigData &data);
+    bool dirty() { return _dirty; }
+
+    // Statistics
+    uint32_t updates = 0; // Snapshots that changed a value
+    uint32_t writes = 0;  // Files written
+
+private:
+    struct Header {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t length; // Bytes of ConfigData following the header
+        uint32_t crc;    // CRC32 of these bytes
+    };
+
+    FS *_fs = nullptr;
+    ConfigData _data = {};
+    volatile bool _dirty = false;
+    volatile bool _writing = false;
+    unsigned long _firstChange = 0;
+    unsigned long _lastChange = 0;
+
+#if defined(ESP32)
+    portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED; // Handlers and loop() run on different tasks
+#endif
+    void lock();
+    void unlock();
+
+    static uint32_t crc32(const uint8_t *data, size_t length);
+};
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef Hal_h
+#define Hal_h
+
+// Thin driver interfaces between the control logic and the hardware.
+// On the robot they wrap the Adafruit and Arduino_GFX drivers. Native builds (no ARDUINO define)
+// get recording implementations instead, which keep every register write, pixel push and LED
+// update with a timestamp, so bus traffic, frame times and motion can be measured on a workstation.
+// Time and random numbers of the subsystems go through HalClock.h for the same reason.
+
+#include "HalClock.h"
+#include "PwmOutput.h"
+#include "PixelDisplay.h"
+#include "LedStrip.h"
+
+#endif
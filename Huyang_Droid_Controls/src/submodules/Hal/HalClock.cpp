@@ -0,0 +1,119 @@
+#include "HalClock.h" // In the same folder
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+static ArduinoClock _defaultClock;
+static ArduinoRandom _defaultRandom;
+
+uint32_t ArduinoClock::millis()
+{
+    return ::millis();
+}
+
+uint32_t ArduinoClock::micros()
+{
+    return ::micros();
+}
+
+void ArduinoClock::wait(uint32_t micros)
+{
+    delay(micros / 1000);
+    delayMicroseconds(micros % 1000);
+}
+
+long ArduinoRandom::random(long min, long max)
+{
+    return ::random(min, max);
+}
+
+void ArduinoRandom::seed(uint32_t seed)
+{
+    randomSeed(seed);
+}
+
+#else
+#include <chrono>
+#include <thread>
+
+static SteadyClock _defaultClock;
+static SeededRandom _defaultRandom;
+
+static std::chrono::steady_clock::time_point steadyStart()
+{
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return start;
+}
+
+uint32_t SteadyClock::millis()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - steadyStart()).count();
+}
+
+uint32_t SteadyClock::micros()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - steadyStart()).count();
+}
+
+void SteadyClock::wait(uint32_t micros)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(micros));
+}
+
+long SeededRandom::random(long min, long max)
+{
+    if (min >= max) return min;
+    _state = (uint32_t)((uint64_t)_state * 48271 % 2147483647);
+    return min + (long)(_state % (unsigned long)(max - min));
+}
+
+void SeededRandom::seed(uint32_t seed)
+{
+    _state = seed % 2147483647;
+    if (_state == 0) _state = 1; // 0 would stay 0 forever
+}
+
+#endif
+
+static Clock *_clock = &_defaultClock;
+static RandomSource *_random = &_defaultRandom;
+
+void halUseClock(Clock *clock)
+{
+    _clock = clock ? clock : &_defaultClock;
+}
+
+void halUseRandom(RandomSource *random)
+{
+    _random = random ? random : &_defaultRandom;
+}
+
+uint32_t halMillis()
+{
+    return _clock->millis();
+}
+
+uint32_t halMicros()
+{
+    return _clock->micros();
+}
+
+void halWait(uint32_t micros)
+{
+    _clock->wait(micros);
+}
+
+long halRandom(long max)
+{
+    return _random->random(0, max);
+}
+
+long halRandom(long min, long max)
+{
+    return _random->random(min, max);
+}
+
+void halRandomSeed(uint32_t seed)
+{
+    _random->seed(seed);
+}
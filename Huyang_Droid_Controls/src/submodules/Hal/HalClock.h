@@ -0,0 +1,107 @@
+#ifndef HalClock_h
+#define HalClock_h
+
+#include <stdint.h>
+
+// Time and random numbers of the control code.
+// The subsystems ask halMillis(), halMicros() and halRandom() instead of millis(), micros() and
+// random(). On the robot these are the Arduino functions. The host builds can swap in a simulated
+// clock and a seeded generator, which lets a whole session run faster than real time and come out
+// the same on every run (see host/replay).
+
+class Clock
+{
+public:
+    virtual ~Clock() {}
+
+    virtual uint32_t millis() = 0;
+    virtual uint32_t micros() = 0;
+
+    // Blocks for the given time, a simulated clock just moves on
+    virtual void wait(uint32_t micros) = 0;
+};
+
+class RandomSource
+{
+public:
+    virtual ~RandomSource() {}
+
+    // Same contract as Arduino's random(min, max): min <= value < max, min if the range is empty
+    virtual long random(long min, long max) = 0;
+    virtual void seed(uint32_t seed) = 0;
+};
+
+// Replace the clock or random source of all subsystems, nullptr restores the default.
+// Only meant to be called before the subsystems run, the pointers are not synchronized.
+void halUseClock(Clock *clock);
+void halUseRandom(RandomSource *random);
+
+uint32_t halMillis();
+uint32_t halMicros();
+void halWait(uint32_t micros);
+long halRandom(long max);
+long halRandom(long min, long max);
+void halRandomSeed(uint32_t seed);
+
+#ifdef ARDUINO
+
+// The default on the robot, the Arduino core functions
+class ArduinoClock : public Clock
+{
+public:
+    uint32_t millis() override;
+    uint32_t micros() override;
+    void wait(uint32_t micros) override;
+};
+
+class ArduinoRandom : public RandomSource
+{
+public:
+    long random(long min, long max) override;
+    void seed(uint32_t seed) override;
+};
+
+#else
+
+// Native default, real time since the first call
+class SteadyClock : public Clock
+{
+public:
+    uint32_t millis() override;
+    uint32_t micros() override;
+    void wait(uint32_t micros) override;
+};
+
+// Time that only moves when told to. Counts in 64 bit, so millis() and micros() roll over like on
+// the robot (after about 49 days and 71 minutes).
+class SimulatedClock : public Clock
+{
+public:
+    uint32_t millis() override { return (uint32_t)(_micros / 1000); }
+    uint32_t micros() override { return (uint32_t)_micros; }
+    void wait(uint32_t micros) override { _micros += micros; }
+
+    void set(uint64_t micros) { _micros = micros; }
+    void advance(uint64_t micros) { _micros += micros; }
+    uint64_t now() { return _micros; }
+
+private:
+    uint64_t _micros = 0;
+};
+
+// Park-Miller generator (the same sequence as std::minstd_rand), also the native default with seed 1
+class SeededRandom : public RandomSource
+{
+public:
+    SeededRandom(uint32_t seed = 1) { this->seed(seed); }
+
+    long random(long min, long max) override;
+    void seed(uint32_t seed) override;
+
+private:
+    uint32_t _state;
+};
+
+#endif
+
+#endif
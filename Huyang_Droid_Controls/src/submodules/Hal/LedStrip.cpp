@@ -0,0 +1,76 @@
+#include "LedStrip.h" // In the same folder
+
+#ifdef ARDUINO
+
+NeoPixelStrip::NeoPixelStrip(uint16_t count, int16_t pin, neoPixelType type)
+    : _pixels(count, pin, type)
+{
+}
+
+void NeoPixelStrip::begin()
+{
+    _pixels.begin();
+}
+
+void NeoPixelStrip::setBrightness(uint8_t brightness)
+{
+    _pixels.setBrightness(brightness);
+}
+
+void NeoPixelStrip::setPixelColor(uint16_t pixel, uint32_t color)
+{
+    _pixels.setPixelColor(pixel, color);
+}
+
+uint32_t NeoPixelStrip::getPixelColor(uint16_t pixel)
+{
+    return _pixels.getPixelColor(pixel);
+}
+
+void NeoPixelStrip::show()
+{
+    _pixels.show();
+}
+
+#else
+
+RecordingLedStrip::RecordingLedStrip(uint16_t count)
+{
+    _colors.assign(count, 0);
+}
+
+void RecordingLedStrip::begin()
+{
+    started = true;
+}
+
+void RecordingLedStrip::setBrightness(uint8_t value)
+{
+    brightness = value;
+}
+
+void RecordingLedStrip::setPixelColor(uint16_t pixel, uint32_t color)
+{
+    if (pixel < _colors.size()) _colors[pixel] = color;
+}
+
+uint32_t RecordingLedStrip::getPixelColor(uint16_t pixel)
+{
+    return pixel < _colors.size() ? _colors[pixel] : 0;
+}
+
+void RecordingLedStrip::show()
+{
+    shows++;
+    busBytes += 3 * _colors.size();
+    if (recording) frames.push_back({halMicros(), brightness, _colors});
+}
+
+void RecordingLedStrip::clear()
+{
+    frames.clear();
+    shows = 0;
+    busBytes = 0;
+}
+
+#endif
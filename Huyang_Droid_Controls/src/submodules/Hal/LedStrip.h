@@ -0,0 +1,80 @@
+#ifndef LedStrip_h
+#define LedStrip_h
+
+#include <stdint.h>
+#include "HalClock.h"
+
+// Addressable LED strip, colors packed as 0x00RRGGBB like Adafruit_NeoPixel::Color()
+class LedStrip
+{
+public:
+    virtual ~LedStrip() {}
+
+    virtual void begin() = 0;
+    virtual void setBrightness(uint8_t brightness) = 0;
+    virtual void setPixelColor(uint16_t pixel, uint32_t color) = 0;
+    virtual uint32_t getPixelColor(uint16_t pixel) = 0;
+    virtual void show() = 0;
+
+    static uint32_t color(uint8_t r, uint8_t g, uint8_t b)
+    {
+        return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+    }
+};
+
+#ifdef ARDUINO
+#include <Adafruit_NeoPixel.h>
+
+class NeoPixelStrip : public LedStrip
+{
+public:
+    NeoPixelStrip(uint16_t count, int16_t pin, neoPixelType type);
+
+    void begin() override;
+    void setBrightness(uint8_t brightness) override;
+    void setPixelColor(uint16_t pixel, uint32_t color) override;
+    uint32_t getPixelColor(uint16_t pixel) override;
+    void show() override;
+
+private:
+    Adafruit_NeoPixel _pixels;
+};
+
+#else
+#include <vector>
+
+// One show() with the colors it sent
+struct LedFrame {
+    uint32_t micros;
+    uint8_t brightness;
+    std::vector<uint32_t> colors;
+};
+
+// Native strip recording every show()
+class RecordingLedStrip : public LedStrip
+{
+public:
+    RecordingLedStrip(uint16_t count);
+
+    void begin() override;
+    void setBrightness(uint8_t brightness) override;
+    void setPixelColor(uint16_t pixel, uint32_t color) override;
+    uint32_t getPixelColor(uint16_t pixel) override;
+    void show() override;
+
+    // Forgets the recorded frames, the colors stay
+    void clear();
+
+    std::vector<LedFrame> frames;
+    bool recording = true;  // false only counts, e.g. for the benchmarks in host/
+    uint32_t shows = 0;
+    uint32_t busBytes = 0;  // Bytes a WS2812 strip would have received (3 per pixel and show())
+    uint8_t brightness = 255;
+    bool started = false;
+
+private:
+    std::vector<uint32_t> _colors;
+};
+#endif
+
+#endif
@@ -0,0 +1,110 @@
+#include "PixelDisplay.h" // In the same folder
+
+#ifdef ARDUINO
+
+GfxDisplay::GfxDisplay(Arduino_GFX *gfx)
+{
+    _gfx = gfx;
+}
+
+bool GfxDisplay::begin()
+{
+    return _gfx->begin();
+}
+
+void GfxDisplay::setRotation(uint8_t rotation)
+{
+    _gfx->setRotation(rotation);
+}
+
+int16_t GfxDisplay::width()
+{
+    return _gfx->width();
+}
+
+int16_t GfxDisplay::height()
+{
+    return _gfx->height();
+}
+
+void GfxDisplay::fillScreen(uint16_t color)
+{
+    _gfx->fillScreen(color);
+}
+
+void GfxDisplay::draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t *pixels, int16_t w, int16_t h)
+{
+    _gfx->draw16bitRGBBitmap(x, y, pixels, w, h);
+}
+
+#else
+
+RecordingPixelDisplay::RecordingPixelDisplay(int16_t width, int16_t height)
+{
+    _width = width;
+    _height = height;
+    _frame.assign((size_t)width * height, 0);
+}
+
+bool RecordingPixelDisplay::begin()
+{
+    started = true;
+    return true;
+}
+
+void RecordingPixelDisplay::setRotation(uint8_t value)
+{
+    // The eyes are square, so the rotation is only recorded
+    rotation = value;
+}
+
+int16_t RecordingPixelDisplay::width()
+{
+    return _width;
+}
+
+int16_t RecordingPixelDisplay::height()
+{
+    return _height;
+}
+
+void RecordingPixelDisplay::plot(int16_t x, int16_t y, uint16_t color)
+{
+    if (x >= 0 && y >= 0 && x < _width && y < _height) _frame[(size_t)y * _width + x] = color;
+}
+
+uint16_t RecordingPixelDisplay::pixel(int16_t x, int16_t y)
+{
+    if (x < 0 || y < 0 || x >= _width || y >= _height) return 0;
+    return _frame[(size_t)y * _width + x];
+}
+
+void RecordingPixelDisplay::fillScreen(uint16_t color)
+{
+    uint32_t start = halMicros();
+    _frame.assign(_frame.size(), color);
+    pixelsWritten += _frame.size();
+    if (recording) pushes.push_back({start, halMicros() - start, PIXEL_PUSH_FILL, 0, 0, (uint16_t)_width, (uint16_t)_height, (uint32_t)_frame.size()});
+}
+
+void RecordingPixelDisplay::draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t *pixels, int16_t w, int16_t h)
+{
+    uint32_t start = halMicros();
+    for (int16_t row = 0; row < h; row++)
+    {
+        for (int16_t column = 0; column < w; column++)
+        {
+            plot(x + column, y + row, pixels[(size_t)row * w + column]);
+        }
+    }
+    pixelsWritten += (uint32_t)w * h;
+    if (recording) pushes.push_back({start, halMicros() - start, PIXEL_PUSH_BITMAP, x, y, (uint16_t)w, (uint16_t)h, (uint32_t)w * h});
+}
+
+void RecordingPixelDisplay::clear()
+{
+    pushes.clear();
+    pixelsWritten = 0;
+}
+
+#endif
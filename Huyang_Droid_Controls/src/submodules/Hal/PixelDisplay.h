@@ -0,0 +1,98 @@
+#ifndef PixelDisplay_h
+#define PixelDisplay_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include "HalClock.h"
+
+// RGB565 display as used for the eyes. The names follow Arduino_GFX / Arduino_TFT.
+class PixelDisplay
+{
+public:
+    virtual ~PixelDisplay() {}
+
+    virtual bool begin() = 0;
+    virtual void setRotation(uint8_t rotation) = 0;
+    virtual int16_t width() = 0;
+    virtual int16_t height() = 0;
+    virtual void fillScreen(uint16_t color) = 0;
+
+    // Pushes a w x h block of pixels packed with a stride of w
+    virtual void draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t *pixels, int16_t w, int16_t h) = 0;
+};
+
+#ifdef ARDUINO
+#include <Arduino_GFX_Library.h>
+
+// Arduino_GFX panel
+class GfxDisplay : public PixelDisplay
+{
+public:
+    GfxDisplay(Arduino_GFX *gfx);
+
+    bool begin() override;
+    void setRotation(uint8_t rotation) override;
+    int16_t width() override;
+    int16_t height() override;
+    void fillScreen(uint16_t color) override;
+    void draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t *pixels, int16_t w, int16_t h) override;
+
+private:
+    Arduino_GFX *_gfx;
+};
+
+#else
+#include <vector>
+
+enum PixelPushType : uint8_t {
+    PIXEL_PUSH_FILL = 0,   // fillScreen()
+    PIXEL_PUSH_BITMAP = 1  // draw16bitRGBBitmap()
+};
+
+// One transfer to the panel
+struct PixelPush {
+    uint32_t micros;    // Start
+    uint32_t duration;  // Until the transfer call returned
+    PixelPushType type;
+    int16_t x;
+    int16_t y;
+    uint16_t w;
+    uint16_t h;
+    uint32_t pixels;
+};
+
+// Native panel keeping a frame buffer of what the real one would show, and every transfer
+class RecordingPixelDisplay : public PixelDisplay
+{
+public:
+    RecordingPixelDisplay(int16_t width = 240, int16_t height = 240);
+
+    bool begin() override;
+    void setRotation(uint8_t rotation) override;
+    int16_t width() override;
+    int16_t height() override;
+    void fillScreen(uint16_t color) override;
+    void draw16bitRGBBitmap(int16_t x, int16_t y, uint16_t *pixels, int16_t w, int16_t h) override;
+
+    uint16_t pixel(int16_t x, int16_t y);
+    const uint16_t *frame() { return _frame.data(); } // width() * height() pixels, row by row
+
+    // Forgets the recorded transfers, the frame buffer stays
+    void clear();
+
+    std::vector<PixelPush> pushes;
+    bool recording = true;  // false only counts and keeps the frame buffer, e.g. for the benchmarks in host/
+    uint64_t pixelsWritten = 0;
+    uint8_t rotation = 0;
+    bool started = false;
+
+private:
+    int16_t _width;
+    int16_t _height;
+    std::vector<uint16_t> _frame;
+
+    void plot(int16_t x, int16_t y, uint16_t color);
+};
+#endif
+
+#endif
@@ -0,0 +1,71 @@
+#include "PwmOutput.h" // In the same folder
+
+#ifdef ARDUINO
+
+Pca9685Output::Pca9685Output(Adafruit_PWMServoDriver *driver, uint8_t address, TwoWire *wire)
+{
+    _driver = driver;
+    _address = address;
+    _wire = wire;
+}
+
+bool Pca9685Output::begin()
+{
+    return _driver->begin();
+}
+
+void Pca9685Output::setPWMFreq(float frequency)
+{
+    _driver->setPWMFreq(frequency);
+}
+
+void Pca9685Output::writeChannels(uint8_t first, const uint16_t *on, const uint16_t *off, uint8_t count)
+{
+    // 16 channels are 65 bytes, which fits the Wire buffer of both ESP8266 and ESP32
+    _wire->beginTransmission(_address);
+    _wire->write(Pca9685Output_LED0_ON_L + 4 * first);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        _wire->write(on[i] & 0xFF);
+        _wire->write(on[i] >> 8);
+        _wire->write(off[i] & 0xFF);
+        _wire->write(off[i] >> 8);
+    }
+    _wire->endTransmission();
+}
+
+#else
+
+bool RecordingPwmOutput::begin()
+{
+    started = true;
+    return true;
+}
+
+void RecordingPwmOutput::setPWMFreq(float value)
+{
+    frequency = value;
+}
+
+void RecordingPwmOutput::writeChannels(uint8_t first, const uint16_t *onValues, const uint16_t *offValues, uint8_t count)
+{
+    uint32_t now = recording ? halMicros() : 0;
+    for (uint8_t i = 0; i < count && first + i < PwmOutput_CHANNELS; i++)
+    {
+        uint8_t channel = first + i;
+        on[channel] = onValues[i];
+        off[channel] = offValues[i];
+        if (recording) records.push_back({now, transactions, channel, onValues[i], offValues[i]});
+    }
+    transactions++;
+    busBytes += 2 + 4 * count;
+}
+
+void RecordingPwmOutput::clear()
+{
+    records.clear();
+    transactions = 0;
+    busBytes = 0;
+}
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef PwmOutput_h
+#define PwmOutput_h
+
+#include <stdint.h>
+#include "HalClock.h"
+
+#define PwmOutput_CHANNELS 16 // Outputs of one PCA9685
+
+// 16 channel PWM output, as provided by the PCA9685
+class PwmOutput
+{
+public:
+    virtual ~PwmOutput() {}
+
+    virtual bool begin() = 0;
+    virtual void setPWMFreq(float frequency) = 0;
+
+    // Writes count neighbouring channels starting at first in one bus transaction
+    virtual void writeChannels(uint8_t first, const uint16_t *on, const uint16_t *off, uint8_t count) = 0;
+};
+
+#ifdef ARDUINO
+#include <Adafruit_PWMServoDriver.h>
+#include <Wire.h>
+
+#define Pca9685Output_LED0_ON_L 0x06 // First output register, each channel has 4 (ON_L, ON_H, OFF_L, OFF_H)
+
+// PCA9685 on I2C. Setup goes through Adafruit_PWMServoDriver, the channel writes are bursts using
+// the register auto-increment that Adafruit_PWMServoDriver::setPWMFreq() enables in MODE1.
+class Pca9685Output : public PwmOutput
+{
+public:
+    Pca9685Output(Adafruit_PWMServoDriver *driver, uint8_t address = 0x40, TwoWire *wire = &Wire);
+
+    bool begin() override;
+    void setPWMFreq(float frequency) override;
+    void writeChannels(uint8_t first, const uint16_t *on, const uint16_t *off, uint8_t count) override;
+
+private:
+    Adafruit_PWMServoDriver *_driver;
+    uint8_t _address;
+    TwoWire *_wire;
+};
+
+#else
+#include <vector>
+
+// One channel write seen on the bus
+struct PwmRecord {
+    uint32_t micros;
+    uint32_t transaction; // Channels written in the same burst share the number
+    uint8_t channel;
+    uint16_t on;
+    uint16_t off;
+};
+
+// Native PCA9685 stand-in, recording every channel write
+class RecordingPwmOutput : public PwmOutput
+{
+public:
+    bool begin() override;
+    void setPWMFreq(float frequency) override;
+    void writeChannels(uint8_t first, const uint16_t *on, const uint16_t *off, uint8_t count) override;
+
+    // Forgets the recorded writes, the channel values stay
+    void clear();
+
+    std::vector<PwmRecord> records;
+    bool recording = true;  // false only counts, e.g. for the benchmarks in host/
+    uint32_t transactions = 0;
+    uint32_t busBytes = 0;  // I2C bytes a PCA9685 would have received (address, register, data)
+    float frequency = 0;
+    bool started = false;
+    uint16_t on[PwmOutput_CHANNELS] = {};
+    uint16_t off[PwmOutput_CHANNELS] = {};
+};
+#endif
+
+#endif
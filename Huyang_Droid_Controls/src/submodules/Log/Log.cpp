@@ -0,0 +1,229 @@
+#include "Log.h" // In the same folder
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#endif
+
+LogEntry Log::_entries[Log_ENTRIES];
+uint8_t Log::_head = 0;
+uint8_t Log::_count = 0;
+uint32_t Log::_logged = 0;
+uint32_t Log::_dropped = 0;
+uint32_t Log::_droppedReported = 0;
+char Log::_line[Log_LINE_CAPACITY];
+size_t Log::_lineLength = 0;
+size_t Log::_lineSent = 0;
+
+#if defined(ESP32)
+static portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED; // Messages come from every task
+#endif
+
+static const char _levelLetters[] = "-EWID"; // Indexed by LOG_LEVEL_
+
+void Log::lock()
+{
+#if defined(ESP32)
+    portENTER_CRITICAL(&_lock);
+#endif
+}
+
+void Log::unlock()
+{
+#if defined(ESP32)
+    portEXIT_CRITICAL(&_lock);
+#endif
+}
+
+void Log::begin(LogEntry &entry, LogSite &site, uint8_t level, const char *format)
+{
+    entry.format = format;
+    entry.millis = halMillis();
+    entry.level = level;
+    entry.count = 0;
+    entry.types = 0;
+    entry.textLength = 0;
+    entry.text[Log_TEXT_CAPACITY - 1] = 0; // Cut copies point here
+    entry.suppressed = site.suppressed;
+    site.suppressed = 0;
+}
+
+void Log::push(const LogEntry &entry)
+{
+    lock();
+    if (_count < Log_ENTRIES)
+    {
+        _entries[(_head + _count) % Log_ENTRIES] = entry;
+        _count++;
+        _logged++;
+    }
+    else
+    {
+        _dropped++;
+    }
+    unlock();
+}
+
+bool Log::pop(LogEntry &entry)
+{
+    lock();
+    bool found = _count > 0;
+    if (found)
+    {
+        entry = _entries[_head];
+        _head = (_head + 1) % Log_ENTRIES;
+        _count--;
+    }
+    unlock();
+    return found;
+}
+
+void Log::add(LogEntry &entry, long value)
+{
+    entry.values[entry.count].i = value;
+    entry.types |= LOG_ARGUMENT_INT << (entry.count++ * 2);
+}
+
+void Log::add(LogEntry &entry, unsigned long value)
+{
+    entry.values[entry.count].u = value;
+    entry.types |= LOG_ARGUMENT_UNSIGNED << (entry.count++ * 2);
+}
+
+void Log::add(LogEntry &entry, double value)
+{
+    entry.values[entry.count].d = value;
+    entry.types |= LOG_ARGUMENT_DOUBLE << (entry.count++ * 2);
+}
+
+void Log::add(LogEntry &entry, const char *value)
+{
+    // Copied, the string may be gone when the message is printed. The last byte always stays 0.
+    if (!value) value = "";
+    size_t room = Log_TEXT_CAPACITY - 1 - entry.textLength;
+    size_t length = strnlen(value, room);
+    if (room > 0)
+    {
+        memcpy(entry.text + entry.textLength, value, length);
+        entry.text[entry.textLength + length] = 0;
+    }
+    entry.values[entry.count].text = entry.textLength;
+    entry.textLength += room > 0 ? length + 1 : 0;
+    if (entry.textLength > Log_TEXT_CAPACITY - 1) entry.textLength = Log_TEXT_CAPACITY - 1;
+    entry.types |= LOG_ARGUMENT_STRING << (entry.count++ * 2);
+}
+
+size_t Log::format(const LogEntry &entry, char *line, size_t capacity)
+{
+    if (capacity == 0) return 0;
+    size_t length = 0;
+    uint8_t argument = 0;
+    line[0] = 0;
+
+    for (const char *p = entry.format; *p && length + 1 < capacity; p++)
+    {
+        if (*p != '%' || p[1] == '%')
+        {
+            line[length++] = *p;
+            if (*p == '%') p++;
+            continue;
+        }
+
+        // One conversion: flags, width and precision are kept, the length modifier is replaced
+        // by the one of the stored value
+        const char *start = p++;
+        p += strspn(p, "-+ #0123456789.");
+        size_t flags = p - start;
+        p += strspn(p, "hlLqjzt");
+        char conversion = *p;
+        if (!conversion) break;
+
+        char spec[16];
+        if (flags > sizeof(spec) - 3) flags = sizeof(spec) - 3;
+        memcpy(spec, start, flags);
+        size_t specLength = flags;
+        if (strchr("diuoxX", conversion)) spec[specLength++] = 'l';
+        spec[specLength++] = conversion;
+        spec[specLength] = 0;
+
+        char *out = line + length;
+        size_t room = capacity - length;
+        int written;
+        if (argument >= entry.count)
+        {
+            written = snprintf(out, room, "?");
+        }
+        else
+        {
+            uint8_t type = (entry.types >> (argument * 2)) & 3;
+            const auto &value = entry.values[argument++];
+            double number = type == LOG_ARGUMENT_DOUBLE ? value.d
+                          : type == LOG_ARGUMENT_UNSIGNED ? (double)value.u
+                          : (double)value.i;
+            long integer = type == LOG_ARGUMENT_DOUBLE ? (long)value.d : value.i;
+
+            if (type == LOG_ARGUMENT_STRING)
+                written = conversion == 's' ? snprintf(out, room, spec, entry.text + value.text) : snprintf(out, room, "?");
+            else if (strchr("di", conversion))
+                written = snprintf(out, room, spec, integer);
+            else if (strchr("uoxX", conversion))
+                written = snprintf(out, room, spec, (unsigned long)integer);
+            else if (conversion == 'c')
+                written = snprintf(out, room, spec, (int)integer);
+            else if (strchr("fFeEgGaA", conversion))
+                written = snprintf(out, room, spec, number);
+            else
+                written = snprintf(out, room, "?");
+        }
+        if (written < 0) break;
+        length += (size_t)written < room ? (size_t)written : room - 1;
+    }
+    line[length] = 0;
+    return length;
+}
+
+// Formats the next queued message into _line, false when there is none
+bool Log::nextLine()
+{
+    _lineLength = 0;
+    _lineSent = 0;
+    const size_t capacity = sizeof(_line) - 1; // Room for the newline
+    int written;
+
+    if (_dropped != _droppedReported)
+    {
+        uint32_t dropped = _dropped - _droppedReported;
+        _droppedReported += dropped;
+        written = snprintf(_line, capacity, "Log: %lu messages dropped, the serial port is too slow.", (unsigned long)dropped);
+        _lineLength = written < 0 ? 0 : ((size_t)written < capacity ? (size_t)written : capacity - 1);
+    }
+    else
+    {
+        LogEntry entry;
+        if (!pop(entry)) return false;
+
+        written = snprintf(_line, capacity, "%lu.%03lu %c ", (unsigned long)(entry.millis / 1000), (unsigned long)(entry.millis % 1000),
+                           _levelLetters[entry.level < sizeof(_levelLetters) - 1 ? entry.level : 0]);
+        _lineLength = written < 0 ? 0 : ((size_t)written < capacity ? (size_t)written : capacity - 1);
+        _lineLength += format(entry, _line + _lineLength, capacity - _lineLength);
+        if (entry.suppressed > 0 && _lineLength + 1 < capacity)
+        {
+            written = snprintf(_line + _lineLength, capacity - _lineLength, " (+%u similar left out)", (unsigned)entry.suppressed);
+            if (written > 0) _lineLength += (size_t)written < capacity - _lineLength ? (size_t)written : capacity - _lineLength - 1;
+        }
+    }
+    _line[_lineLength++] = '\n';
+    return true;
+}
+
+void Log::drain(Print &out, size_t budget)
+{
+    while (budget > 0)
+    {
+        if (_lineSent == _lineLength && !nextLine()) return;
+        size_t chunk = _lineLength - _lineSent;
+        if (chunk > budget) chunk = budget;
+        out.write((const uint8_t *)_line + _lineSent, chunk);
+        _lineSent += chunk;
+        budget -= chunk;
+    }
+}
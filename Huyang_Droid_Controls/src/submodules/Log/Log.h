@@ -0,0 +1,190 @@
+#ifndef Log_h
+#define Log_h
+
+#include <Arduino.h>
+#include "../Hal/HalClock.h" // Time of a message and the rate limit window
+
+// Log levels, a message is kept when its level is at most LOG_LEVEL
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#include "../../../config.h" // LOG_LEVEL, the same for every file of the sketch
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define Log_ENTRIES 16         // Messages waiting for the serial port, further ones are dropped
+#define Log_MAX_ARGUMENTS 4    // Arguments per message
+#define Log_TEXT_CAPACITY 24   // Room per message for copies of its %s arguments, longer ones are cut
+#define Log_LINE_CAPACITY 160  // Longest line, longer ones are cut
+#define Log_SITE_BURST 5       // Messages a call site may log per window, further ones are only counted
+#define Log_SITE_WINDOW 1000   // Rate limit window in ms
+
+// Leveled logging to the serial port.
+//
+//   LOG_INFO("HuyangNeck: Rotation triggered to %.2f", degree);
+//
+// Messages below LOG_LEVEL (config.h) are removed by the preprocessor, their arguments are not even
+// evaluated. The others are not formatted where they are logged: the format string pointer and the
+// raw arguments are copied into a ring of Log_ENTRIES entries, and Log::drain() turns them into text
+// from loop() as far as the serial transmit buffer has room, so logging never waits for the UART.
+// A line gets the time it was logged and the level, the newline is added.
+//
+// Every call site logs at most Log_SITE_BURST messages per Log_SITE_WINDOW ms, the ones in between
+// are counted and the next message of the site says how many were left out. When the ring is full,
+// messages are dropped and counted too.
+//
+// The format string must be a literal, it is read when the line is printed. %s arguments are copied.
+// Supported: integers and enums, float / double and strings, up to Log_MAX_ARGUMENTS of them,
+// with the usual printf conversions except * widths. Messages can be logged from any task, only
+// drain() has to stay on one. Direct Serial prints are not ordered with the logged lines.
+#define LOG_AT(level, format, ...)                                     \
+    do                                                                 \
+    {                                                                  \
+        static LogSite _logSite;                                       \
+        if (_logSite.allow()) Log::write(_logSite, level, format, ##__VA_ARGS__); \
+    } while (0)
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(format, ...) LOG_AT(LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(format, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(format, ...) LOG_AT(LOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#else
+#define LOG_WARN(format, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(format, ...) LOG_AT(LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#else
+#define LOG_INFO(format, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(format, ...) LOG_AT(LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(format, ...) do {} while (0)
+#endif
+
+// Rate limit of one call site. Sites hit from two tasks at once may count a message too many or too few.
+struct LogSite {
+    uint32_t windowStart = 0;
+    uint16_t count = 0;      // Messages in the current window
+    uint16_t suppressed = 0; // Left out since the last message that went out
+
+    bool allow()
+    {
+        uint32_t now = halMillis();
+        if (now - windowStart >= Log_SITE_WINDOW)
+        {
+            windowStart = now;
+            count = 0;
+        }
+        if (count >= Log_SITE_BURST)
+        {
+            if (suppressed < UINT16_MAX) suppressed++;
+            return false;
+        }
+        count++;
+        return true;
+    }
+};
+
+// One message as it waits in the ring
+struct LogEntry {
+    const char *format;
+    uint32_t millis;
+    uint8_t level;
+    uint8_t count;       // Arguments
+    uint8_t types;       // LogArgumentType of every argument, 2 bits each
+    uint8_t textLength;  // Used part of text
+    uint16_t suppressed; // Messages of the call site left out before this one
+    union {
+        long i;
+        unsigned long u;
+        double d;
+        uint8_t text; // Start of the copy in text
+    } values[Log_MAX_ARGUMENTS];
+    char text[Log_TEXT_CAPACITY];
+};
+
+enum LogArgumentType : uint8_t {
+    LOG_ARGUMENT_INT = 0,
+    LOG_ARGUMENT_UNSIGNED = 1,
+    LOG_ARGUMENT_DOUBLE = 2,
+    LOG_ARGUMENT_STRING = 3
+};
+
+class Log
+{
+public:
+    // Queues a message, use the LOG_ macros instead
+    template <typename... Arguments>
+    static void write(LogSite &site, uint8_t level, const char *format, const Arguments &...arguments)
+    {
+        static_assert(sizeof...(Arguments) <= Log_MAX_ARGUMENTS, "Too many arguments for a log message");
+        LogEntry entry;
+        begin(entry, site, level, format);
+        capture(entry, arguments...);
+        push(entry);
+    }
+
+    // Prints queued messages, at most budget bytes. With Serial.availableForWrite() as the budget
+    // it never waits for the UART, a line that does not fit is continued on the next call.
+    static void drain(Print &out, size_t budget);
+
+    // Prints everything queued, waiting for the port. Before a restart, for example.
+    static void flush(Print &out) { drain(out, SIZE_MAX); }
+
+    // Statistics
+    static uint32_t logged() { return _logged; }
+    static uint32_t dropped() { return _dropped; }
+
+    // Formats a message the way drain() prints it, without the newline. Returns the length.
+    static size_t format(const LogEntry &entry, char *line, size_t capacity);
+
+private:
+    static LogEntry _entries[Log_ENTRIES];
+    static uint8_t _head;  // Oldest entry
+    static uint8_t _count;
+    static uint32_t _logged;
+    static uint32_t _dropped;
+    static uint32_t _droppedReported;
+
+    // Line being printed by drain()
+    static char _line[Log_LINE_CAPACITY];
+    static size_t _lineLength;
+    static size_t _lineSent;
+
+    static void begin(LogEntry &entry, LogSite &site, uint8_t level, const char *format);
+    static void push(const LogEntry &entry);
+    static bool pop(LogEntry &entry);
+    static bool nextLine();
+    static void lock();
+    static void unlock();
+
+    static void capture(LogEntry &) {}
+    template <typename First, typename... Rest>
+    static void capture(LogEntry &entry, const First &first, const Rest &...rest)
+    {
+        add(entry, first);
+        capture(entry, rest...);
+    }
+
+    // Smaller integers, bool, char and enums are promoted to int, float to double
+    static void add(LogEntry &entry, int value) { add(entry, (long)value); }
+    static void add(LogEntry &entry, unsigned int value) { add(entry, (unsigned long)value); }
+    static void add(LogEntry &entry, long value);
+    static void add(LogEntry &entry, unsigned long value);
+    static void add(LogEntry &entry, double value);
+    static void add(LogEntry &entry, const char *value);
+    static void add(LogEntry &entry, const String &value) { add(entry, value.c_str()); }
+};
+
+#endif
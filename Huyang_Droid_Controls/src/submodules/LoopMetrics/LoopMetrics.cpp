@@ -0,0 +1,105 @@
+#include "LoopMetrics.h" // In the same folder
+#include <algorithm>
+
+static const char *const _names[METRICS_SECTIONS] = {"loop", "wifi", "face", "neck", "body", "lights"};
+
+LoopMetrics::LoopMetrics()
+{
+    memset(_sections, 0, sizeof(_sections));
+    reset();
+}
+
+void LoopMetrics::reset()
+{
+    for (uint8_t i = 0; i < METRICS_SECTIONS; i++)
+    {
+        Section &section = _sections[i];
+        bool lapping = section.lapping;
+        uint32_t lapStart = section.lapStart;
+        memset(&section, 0, sizeof(section));
+        section.minCycles = UINT32_MAX;
+        // A running lap continues, so loop() does not lose the pass the reset happened in
+        section.lapping = lapping;
+        section.lapStart = lapStart;
+    }
+    _resetMillis = halMillis();
+}
+
+void LoopMetrics::record(MetricsSection section, uint32_t start)
+{
+    add(_sections[section], now() - start);
+}
+
+void LoopMetrics::lap(MetricsSection section)
+{
+    Section &s = _sections[section];
+    uint32_t time = now();
+    if (s.lapping) add(s, time - s.lapStart);
+    s.lapStart = time;
+    s.lapping = true;
+}
+
+void LoopMetrics::add(Section &section, uint32_t cycles)
+{
+    section.count++;
+    section.totalCycles += cycles;
+    if (cycles < section.minCycles) section.minCycles = cycles;
+    if (cycles > section.maxCycles) section.maxCycles = cycles;
+
+    section.window[section.next] = cycles;
+    section.next = (section.next + 1) % LoopMetrics_WINDOW;
+
+    // log2 of the microseconds, 0 for anything below 2^LoopMetrics_FIRST_BUCKET_SHIFT
+    uint32_t micros = cycles / ESP.getCpuFreqMHz();
+    uint32_t bits = micros > 0 ? 32 - __builtin_clz(micros) : 0;
+    int32_t bucket = (int32_t)bits - LoopMetrics_FIRST_BUCKET_SHIFT;
+    if (bucket < 0) bucket = 0;
+    if (bucket >= LoopMetrics_BUCKETS) bucket = LoopMetrics_BUCKETS - 1;
+    section.histogram[bucket]++;
+}
+
+MetricsSummary LoopMetrics::summary(MetricsSection section)
+{
+    const Section &s = _sections[section];
+    uint32_t mhz = ESP.getCpuFreqMHz();
+    MetricsSummary summary;
+    memset(&summary, 0, sizeof(summary));
+    summary.name = name(section);
+    summary.count = s.count;
+    memcpy(summary.histogram, s.histogram, sizeof(summary.histogram));
+    if (s.count == 0) return summary;
+
+    summary.min = s.minCycles / mhz;
+    summary.max = s.maxCycles / mhz;
+    summary.avg = (uint32_t)(s.totalCycles / s.count / mhz);
+    summary.totalMillis = (uint32_t)(s.totalCycles / mhz / 1000);
+    uint32_t elapsed = halMillis() - _resetMillis;
+    summary.share = elapsed > 0 ? 100.0f * summary.totalMillis / elapsed : 0;
+
+    // p99 of the window, on a copy so recording is never held up
+    uint32_t window[LoopMetrics_WINDOW];
+    uint16_t length = s.count < LoopMetrics_WINDOW ? s.count : LoopMetrics_WINDOW;
+    memcpy(window, s.window, sizeof(window));
+    uint16_t rank = (length * 99 + 99) / 100 - 1; // Nearest rank
+    std::nth_element(window, window + rank, window + length);
+    summary.p99 = window[rank] / mhz;
+    return summary;
+}
+
+const char *LoopMetrics::name(MetricsSection section)
+{
+    return section < METRICS_SECTIONS ? _names[section] : "";
+}
+
+void LoopMetrics::print(Print &out)
+{
+    for (uint8_t i = 0; i < METRICS_SECTIONS; i++)
+    {
+        MetricsSummary s = summary((MetricsSection)i);
+        if (s.count == 0) continue;
+        uint32_t tenths = (uint32_t)(s.share * 10 + 0.5f); // Integers only, not every printf has %f
+        out.printf("Metrics: %-6s n %7lu, min %6lu avg %6lu p99 %6lu max %7lu us, %3lu.%lu%%\n", s.name, (unsigned long)s.count,
+                   (unsigned long)s.min, (unsigned long)s.avg, (unsigned long)s.p99, (unsigned long)s.max,
+                   (unsigned long)(tenths / 10), (unsigned long)(tenths % 10));
+    }
+}
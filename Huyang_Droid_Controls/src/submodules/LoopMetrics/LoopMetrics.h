@@ -0,0 +1,89 @@
+#ifndef LoopMetrics_h
+#define LoopMetrics_h
+
+#include <Arduino.h>
+#include "../Hal/HalClock.h" // Time since the last reset, for the share of each section
+
+#define LoopMetrics_WINDOW 128  // Latest durations kept per section, the p99 is taken over them
+#define LoopMetrics_BUCKETS 16  // Histogram: bucket 0 below 64 us, then doubling, the last from ~1 s up
+#define LoopMetrics_FIRST_BUCKET_SHIFT 6 // Upper end of bucket 0 is 2^6 us
+
+// Timed parts of the main loop and the control tasks
+enum MetricsSection : uint8_t {
+    METRICS_LOOP = 0,   // From one loop() pass to the next, including what the core does in between
+    METRICS_WIFI = 1,   // wifi->loop() and the WebSocket housekeeping
+    METRICS_FACE = 2,   // huyangFace->loop()
+    METRICS_NECK = 3,   // huyangNeck->loop()
+    METRICS_BODY = 4,   // huyangBody->loop()
+    METRICS_LIGHTS = 5, // huyangBody->updateChestLights()
+    METRICS_SECTIONS = 6
+};
+
+// Statistics of one section in microseconds
+struct MetricsSummary {
+    const char *name;
+    uint32_t count;
+    uint32_t min;
+    uint32_t avg;
+    uint32_t p99;    // Over the last LoopMetrics_WINDOW durations
+    uint32_t max;
+    uint32_t totalMillis;
+    float share;     // Percent of the time since the last reset
+    uint32_t histogram[LoopMetrics_BUCKETS];
+};
+
+// Duration statistics of the loop sections, measured with the CPU cycle counter.
+// Each section keeps count, min, max and total since the last reset, a log2 histogram and a ring
+// of its latest durations for the p99. Everything is preallocated, recording is a few additions.
+//
+//   uint32_t start = LoopMetrics::now();
+//   huyangFace->loop();
+//   loopMetrics->record(METRICS_FACE, start);
+//
+// Every section must only be recorded from one task. Readers (the web handler, the serial dump)
+// do not lock, so a summary taken while a section is being recorded may miss its latest duration.
+// The cycle counter wraps after 2^32 cycles (27 s at 160 MHz), longer sections are not measurable.
+// On ESP32 the sections run on both cores, so the shares may add up to more than 100%.
+class LoopMetrics
+{
+public:
+    LoopMetrics();
+
+    static uint32_t now() { return ESP.getCycleCount(); }
+
+    // Duration from start (a now() value) until now
+    void record(MetricsSection section, uint32_t start);
+
+    // Time since the previous lap of the section, for periodic things like loop() itself.
+    // The first lap only starts the measurement.
+    void lap(MetricsSection section);
+
+    MetricsSummary summary(MetricsSection section);
+    static const char *name(MetricsSection section);
+
+    // Clears all statistics
+    void reset();
+
+    // One line per section with count, min / avg / p99 / max and share
+    void print(Print &out);
+
+private:
+    struct Section {
+        uint32_t count;
+        uint32_t minCycles;
+        uint32_t maxCycles;
+        uint64_t totalCycles;
+        uint32_t lapStart;
+        bool lapping;
+        uint16_t next;       // Ring position the next duration is written to
+        uint32_t window[LoopMetrics_WINDOW];
+        uint32_t histogram[LoopMetrics_BUCKETS];
+    };
+
+    Section _sections[METRICS_SECTIONS];
+    uint32_t _resetMillis = 0;
+
+    void add(Section &section, uint32_t cycles);
+};
+
+#endif
@@ -0,0 +1,61 @@
+#include "MotionCommands.h" // In the same folder
+
+MotionCommands::MotionCommands()
+{
+    for (uint8_t i = 0; i < MotionCommands_SLOTS; i++)
+    {
+        _slots[i].store(0, std::memory_order_relaxed);
+    }
+    memset(_generations, 0, sizeof(_generations));
+    memset(_seen, 0, sizeof(_seen));
+    memset(_targets, 0, sizeof(_targets));
+}
+
+void MotionCommands::write(uint8_t slot, int16_t value)
+{
+    uint16_t generation = ++_generations[slot];
+    _slots[slot].store(((uint32_t)generation << 16) | (uint16_t)value, std::memory_order_release);
+    received++;
+}
+
+void MotionCommands::setAxis(MotionAxis axis, int16_t value)
+{
+    if (axis >= AXIS_COUNT) return;
+    write(axis, value);
+}
+
+void MotionCommands::setAutomatic(bool automatic)
+{
+    write(MotionCommands_AUTOMATIC, automatic ? 1 : 0);
+}
+
+uint16_t MotionCommands::drain()
+{
+    uint16_t changed = 0;
+    _automaticChanged = false;
+
+    for (uint8_t i = 0; i < MotionCommands_SLOTS; i++)
+    {
+        uint32_t slot = _slots[i].load(std::memory_order_acquire);
+        uint16_t generation = slot >> 16;
+        if (generation == _seen[i]) continue;
+
+        // Every generation between the last applied one and this one was overwritten unseen
+        superseded += (uint16_t)(generation - _seen[i] - 1);
+        _seen[i] = generation;
+        applied++;
+
+        int16_t value = (int16_t)(slot & 0xFFFF);
+        if (i == MotionCommands_AUTOMATIC)
+        {
+            _automatic = value != 0;
+            _automaticChanged = true;
+        }
+        else
+        {
+            _targets[i] = value;
+            changed |= 1 << i;
+        }
+    }
+    return changed;
+}
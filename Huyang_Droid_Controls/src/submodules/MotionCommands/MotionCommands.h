@@ -0,0 +1,63 @@
+#ifndef MotionCommands_h
+#define MotionCommands_h
+
+#include <Arduino.h>
+#include <atomic>
+
+// Everything the web interface can move
+enum MotionAxis : uint8_t {
+    AXIS_NECK_ROTATE = 0,
+    AXIS_NECK_TILT_FORWARD = 1,
+    AXIS_NECK_TILT_SIDEWAYS = 2,
+    AXIS_BODY_ROTATE = 3,
+    AXIS_BODY_TILT_FORWARD = 4,
+    AXIS_BODY_TILT_SIDEWAYS = 5,
+    AXIS_MONOCLE = 6,
+    AXIS_COUNT = 7
+};
+
+#define MotionCommands_AUTOMATIC AXIS_COUNT      // Slot of the automatic mode switch
+#define MotionCommands_SLOTS (AXIS_COUNT + 1)
+
+// Input stage between the network handlers and the motion task.
+// Every axis has one slot holding only the latest target. The handlers (AsyncTCP task) overwrite
+// it, the motion task takes whatever changed once per tick. Targets superseded before the tick are
+// never applied, so a burst of joystick updates costs a single servo retarget and nothing can queue
+// up or overflow, however fast the input arrives.
+// Value and a generation counter share one 32 bit word, so a slot is always read consistently
+// without locks (one producer, one consumer).
+class MotionCommands
+{
+public:
+    MotionCommands();
+
+    // Producer side (network handlers)
+    void setAxis(MotionAxis axis, int16_t value);
+    void setAutomatic(bool automatic);
+
+    // Consumer side (motion task): returns one bit per axis that received a new target since the
+    // last drain. target()/automatic() then hold the latest values.
+    uint16_t drain();
+    bool automaticChanged() { return _automaticChanged; }
+
+    int16_t target(MotionAxis axis) { return _targets[axis]; }
+    bool automatic() { return _automatic; }
+
+    // Statistics for tuning
+    uint32_t received = 0;   // Targets written by the handlers (written by the producer only)
+    uint32_t applied = 0;    // Targets taken over by the motion task
+    uint32_t superseded = 0; // Targets overwritten before the motion task saw them
+
+private:
+    std::atomic<uint32_t> _slots[MotionCommands_SLOTS]; // generation << 16 | (uint16_t)value
+    uint16_t _generations[MotionCommands_SLOTS];        // Producer: last generation written
+    uint16_t _seen[MotionCommands_SLOTS];               // Consumer: last generation applied
+
+    int16_t _targets[AXIS_COUNT];
+    bool _automatic = true;
+    bool _automaticChanged = false;
+
+    void write(uint8_t slot, int16_t value);
+};
+
+#endif
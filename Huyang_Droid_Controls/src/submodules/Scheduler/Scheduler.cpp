@@ -0,0 +1,189 @@
+#include "Scheduler.h" // In the same folder
+
+Scheduler::Scheduler()
+{
+    memset(_tasks, 0, sizeof(_tasks));
+}
+
+int8_t Scheduler::addTask(const char *name, SchedulerCallback callback, uint32_t periodMicros, uint32_t deadlineMicros)
+{
+    if (_count >= Scheduler_MAX_TASKS || callback == nullptr || periodMicros == 0)
+    {
+        Serial.printf("Scheduler: Task %s not added.\n", name);
+        return -1;
+    }
+
+    SchedulerTask &task = _tasks[_count];
+    memset(&task, 0, sizeof(task));
+    task.name = name;
+    task.callback = callback;
+    task.period = periodMicros;
+    task.deadline = deadlineMicros == 0 ? periodMicros : deadlineMicros;
+    task.release = halMicros(); // Due right away
+    Serial.printf("Scheduler: Task %s every %lu us, deadline %lu us.\n", name, (unsigned long)task.period, (unsigned long)task.deadline);
+    return _count++;
+}
+
+// Due task with the earliest deadline, optionally only among deadlines before 'before'
+int8_t Scheduler::nextDue(uint32_t now, uint32_t before, bool limited)
+{
+    int8_t next = -1;
+    uint32_t nextDeadline = 0;
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        SchedulerTask &task = _tasks[i];
+        if (i == _running || task.realtime) continue;
+        if ((int32_t)(now - task.release) < 0) continue; // Not due yet
+
+        uint32_t deadline = task.release + task.deadline;
+        if (limited && (int32_t)(deadline - before) >= 0) continue;
+        if (next < 0 || (int32_t)(deadline - nextDeadline) < 0)
+        {
+            next = i;
+            nextDeadline = deadline;
+        }
+    }
+    return next;
+}
+
+// Runs one task, updates its statistics and schedules its next release. Returns the time it took.
+// The runtime statistics only count the task itself, tasks started by yield() in between have
+// their own. The deadline check uses the wall clock time, that is what the task had to meet.
+uint32_t Scheduler::execute(uint8_t index, uint32_t now)
+{
+    SchedulerTask &task = _tasks[index];
+    uint32_t yielded = _yieldedMicros;
+    task.callback();
+    uint32_t end = halMicros();
+
+    account(task, now, end, end - now - (_yieldedMicros - yielded));
+    return end - now;
+}
+
+// Updates the statistics of a run from start to end and moves the task to its next release.
+// Returns the number of releases dropped because the task fell more than a period behind.
+uint32_t Scheduler::account(SchedulerTask &task, uint32_t start, uint32_t end, uint32_t runtime)
+{
+    uint32_t lateness = (int32_t)(start - task.release) > 0 ? start - task.release : 0;
+    task.runs++;
+    task.lastRuntime = runtime;
+    task.totalRuntime += runtime;
+    if (runtime > task.maxRuntime) task.maxRuntime = runtime;
+    if (lateness > task.maxLateness) task.maxLateness = lateness;
+    if (lateness + (end - start) > task.deadline) task.overruns++;
+
+    // Next release on the grid. A task that fell more than a period behind drops the missed
+    // releases instead of running several times back to back.
+    uint32_t missed = 0;
+    task.release += task.period;
+    if ((int32_t)(end - task.release) >= (int32_t)task.period)
+    {
+        missed = (end - task.release) / task.period;
+        task.skipped += missed;
+        task.release += missed * task.period;
+    }
+    return missed;
+}
+
+#if defined(ESP32)
+int8_t Scheduler::addRealtimeTask(const char *name, SchedulerCallback callback, uint32_t periodMicros, uint32_t deadlineMicros,
+                                  uint8_t core, uint8_t priority)
+{
+    TickType_t ticks = pdMS_TO_TICKS(periodMicros / 1000);
+    if (ticks == 0) ticks = 1;
+    uint32_t period = ticks * portTICK_PERIOD_MS * 1000;
+
+    int8_t index = addTask(name, callback, period, deadlineMicros);
+    if (index < 0) return -1;
+
+    _tasks[index].realtime = true;
+    _realtime[index].scheduler = this;
+    _realtime[index].index = index;
+    if (xTaskCreatePinnedToCore(realtimeTask, name, Scheduler_REALTIME_STACK, &_realtime[index], priority, nullptr, core) != pdPASS)
+    {
+        Serial.printf("Scheduler: Realtime task %s could not be started.\n", name);
+        _tasks[index].realtime = false; // Still runs, cooperatively from run()
+        return index;
+    }
+    Serial.printf("Scheduler: Task %s runs on core %d with priority %d.\n", name, core, priority);
+    return index;
+}
+
+void Scheduler::realtimeTask(void *parameter)
+{
+    Realtime *realtime = (Realtime *)parameter;
+    SchedulerTask &task = realtime->scheduler->_tasks[realtime->index];
+    TickType_t periodTicks = pdMS_TO_TICKS(task.period / 1000);
+
+    TickType_t wake = xTaskGetTickCount();
+    task.release = halMicros();
+    for (;;)
+    {
+        uint32_t start = halMicros();
+        task.callback();
+        uint32_t end = halMicros();
+        uint32_t missed = realtime->scheduler->account(task, start, end, end - start);
+
+        // Sleeps until the next release, dropped releases included
+        vTaskDelayUntil(&wake, periodTicks * (1 + missed));
+    }
+}
+#endif
+
+void Scheduler::run()
+{
+    uint32_t now = halMicros();
+
+    // Earliest deadline first among the tasks already released
+    int8_t next = nextDue(now, 0, false);
+    if (next < 0) return;
+
+    _running = next;
+    execute(next, now);
+    _running = -1;
+}
+
+void Scheduler::yield()
+{
+    if (_running < 0 || _yielding) return;
+
+    uint32_t now = halMicros();
+    SchedulerTask &running = _tasks[_running];
+    uint32_t before = running.release + running.deadline; // Absolute deadline of the running task
+
+    _yielding = true;
+    int8_t next;
+    while ((next = nextDue(now, before, true)) >= 0)
+    {
+        _yieldedMicros += execute(next, now);
+        now = halMicros();
+    }
+    _yielding = false;
+}
+
+void Scheduler::resetStats()
+{
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        SchedulerTask &task = _tasks[i];
+        task.runs = 0;
+        task.overruns = 0;
+        task.skipped = 0;
+        task.lastRuntime = 0;
+        task.maxRuntime = 0;
+        task.totalRuntime = 0;
+        task.maxLateness = 0;
+    }
+}
+
+void Scheduler::printStats(Print &out)
+{
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        SchedulerTask &task = _tasks[i];
+        uint32_t average = task.runs > 0 ? (uint32_t)(task.totalRuntime / task.runs) : 0;
+        out.printf("Scheduler: %-8s period %6lu us, runtime avg %6lu max %6lu us, late max %6lu us, runs %lu, overruns %lu, skipped %lu\n",
+                   task.name, (unsigned long)task.period, (unsigned long)average, (unsigned long)task.maxRuntime,
+                   (unsigned long)task.maxLateness, (unsigned long)task.runs, (unsigned long)task.overruns, (unsigned long)task.skipped);
+    }
+}
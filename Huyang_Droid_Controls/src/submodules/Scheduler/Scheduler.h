@@ -0,0 +1,100 @@
+#ifndef Scheduler_h
+#define Scheduler_h
+
+#include <Arduino.h>
+#include "../Hal/HalClock.h" // Release times, simulated on the host
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#define Scheduler_REALTIME_STACK 4096 // Stack of a realtime task in bytes
+#endif
+
+#define Scheduler_MAX_TASKS 8
+
+typedef void (*SchedulerCallback)();
+
+// One periodic job of the sketch, with its timing statistics (all times in microseconds)
+struct SchedulerTask {
+    const char *name;
+    SchedulerCallback callback;
+    uint32_t period;    // Time between two releases
+    uint32_t deadline;  // Time after the release by which the run has to be finished
+    uint32_t release;   // Time the next run becomes due
+
+    uint32_t runs;      // Completed runs
+    uint32_t overruns;  // Runs that finished after their deadline
+    uint32_t skipped;   // Releases dropped because the task fell more than a period behind
+    uint32_t lastRuntime;
+    uint32_t maxRuntime;
+    uint64_t totalRuntime;
+    uint32_t maxLateness; // Largest delay between release and start (jitter)
+
+    bool realtime;        // Runs on its own FreeRTOS task instead of from run() (ESP32 only)
+};
+
+// Cooperative scheduler replacing the back-to-back calls in loop().
+// Every subsystem registers a task with a period and a deadline. run() starts the due task
+// with the earliest deadline, so a short servo task never waits behind more than one run of the
+// face task, no matter how often the face is due. Tasks are not interrupted, but may call yield()
+// to let more urgent tasks run in between. Releases follow a fixed grid (release += period), so a late start
+// does not shift the following runs.
+// On ESP32 tasks may instead be realtime tasks on their own core and priority.
+class Scheduler
+{
+public:
+    Scheduler();
+
+    // Registers a task, deadline 0 means "by the next release". Returns the task index or -1 if full.
+    int8_t addTask(const char *name, SchedulerCallback callback, uint32_t periodMicros, uint32_t deadlineMicros = 0);
+
+#if defined(ESP32)
+    // Registers a task that runs on its own FreeRTOS task pinned to a core, released by
+    // vTaskDelayUntil() so it keeps its rate no matter what the loop() or the network are doing.
+    // The period is rounded to whole RTOS ticks. The statistics are kept like for every other task.
+    int8_t addRealtimeTask(const char *name, SchedulerCallback callback, uint32_t periodMicros, uint32_t deadlineMicros,
+                           uint8_t core, uint8_t priority);
+#endif
+
+    // Runs at most one due task, called from loop()
+    void run();
+
+    // Called by long running tasks at convenient points (e.g. between display bands).
+    // Runs the due tasks whose deadline is earlier than the one of the running task,
+    // so their timing does not depend on how long the running task takes.
+    void yield();
+
+    uint8_t taskCount() { return _count; }
+    const SchedulerTask &task(uint8_t index) { return _tasks[index]; }
+
+    // Clears the statistics of all tasks
+    void resetStats();
+
+    // One line per task with period, runtime (avg/max), lateness and overruns
+    void printStats(Print &out);
+
+private:
+    SchedulerTask _tasks[Scheduler_MAX_TASKS];
+    uint8_t _count = 0;
+
+    int8_t _running = -1;        // Task started by run(), -1 outside of a task
+    bool _yielding = false;      // A task started by yield() is running, no further nesting
+    uint32_t _yieldedMicros = 0; // Time spent in tasks started by yield(), not counted for the running task
+
+    int8_t nextDue(uint32_t now, uint32_t before, bool limited);
+    uint32_t execute(uint8_t index, uint32_t now);
+    uint32_t account(SchedulerTask &task, uint32_t start, uint32_t end, uint32_t runtime);
+
+#if defined(ESP32)
+    struct Realtime {
+        Scheduler *scheduler;
+        uint8_t index;
+    };
+    Realtime _realtime[Scheduler_MAX_TASKS];
+
+    static void realtimeTask(void *parameter);
+#endif
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef SpscRing_h
+#define SpscRing_h
+
+#include <Arduino.h>
+#include <atomic>
+
+// Lock-free ring buffer for exactly one producer and one consumer, e.g. the network handlers
+// (AsyncTCP task) handing commands to a control task. Neither side ever blocks or disables
+// interrupts: the producer only writes _head, the consumer only writes _tail.
+// N has to be a power of two, one slot stays empty to tell a full ring from an empty one.
+template <typename T, uint16_t N>
+class SpscRing
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing size has to be a power of two");
+
+public:
+    // Producer side. Returns false (and counts the item as dropped) if the ring is full.
+    bool push(const T &item)
+    {
+        uint16_t head = _head.load(std::memory_order_relaxed);
+        uint16_t next = (head + 1) & (N - 1);
+        if (next == _tail.load(std::memory_order_acquire))
+        {
+            dropped++;
+            return false;
+        }
+        _items[head] = item;
+        _head.store(next, std::memory_order_release); // Publishes the item
+        return true;
+    }
+
+    // Consumer side. Returns false if the ring is empty.
+    bool pop(T &item)
+    {
+        uint16_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) return false;
+        item = _items[tail];
+        _tail.store((tail + 1) & (N - 1), std::memory_order_release); // Frees the slot
+        return true;
+    }
+
+    bool empty() const
+    {
+        return _tail.load(std::memory_order_acquire) == _head.load(std::memory_order_acquire);
+    }
+
+    uint16_t capacity() const { return N - 1; }
+
+    uint32_t dropped = 0; // Items refused because the ring was full (written by the producer only)
+
+private:
+    T _items[N];
+    std::atomic<uint16_t> _head{0}; // Next slot the producer writes
+    std::atomic<uint16_t> _tail{0}; // Next slot the consumer reads
+};
+
+#endif
@@ -0,0 +1,127 @@
+#include "Tasks.h" // In the same folder
+
+// Face (Eyes)
+// The HuyangFace class handles its own loop and state transitions based on faceLeftEyeState/faceRightEyeState
+// and automaticAnimations.
+void faceTask()
+{
+    // Eye commands queued by the network handlers. The manual states below keep them.
+    FaceCommand command;
+    while (faceCommands.pop(command))
+    {
+        if (command.target != FACE_RIGHT) faceLeftEyeState = command.state;
+        if (command.target != FACE_LEFT) faceRightEyeState = command.state;
+        if (!enableEyes) continue;
+
+        EyeState state = huyangFace->getStateFrom(command.state);
+        if (command.target == FACE_ALL) huyangFace->setEyesTo(state);
+        else if (command.target == FACE_LEFT) huyangFace->setLeftEyeTo(state);
+        else huyangFace->setRightEyeTo(state);
+    }
+
+    if (!enableEyes) return;
+
+    // Automatic mode is switched by the servo task on the other core, read it once per run
+    bool automatic = automaticAnimations;
+    if (huyangFace->automatic != automatic) huyangFace->setAutomatic(automatic);
+
+    // If automatic animations are off, manually set eye states from global variables
+    if (automatic == false)
+    {
+        if (allEyes != 0) { // If an "all eyes" command is active
+            huyangFace->setEyesTo(huyangFace->getStateFrom(allEyes));
+            allEyes = 0; // Reset after setting to prevent continuous re-setting
+        } else { // Otherwise, apply individual eye states
+            huyangFace->setLeftEyeTo(huyangFace->getStateFrom(faceLeftEyeState));
+            huyangFace->setRightEyeTo(huyangFace->getStateFrom(faceRightEyeState));
+        }
+    }
+    uint32_t start = LoopMetrics::now();
+    huyangFace->loop(); // Run the eye animation loop
+    loopMetrics->record(METRICS_FACE, start);
+}
+
+// Takes the motion targets the network handlers set since the last run.
+// Only the latest target per axis is applied, this task is the only writer of the manual targets.
+void applyMotionCommands()
+{
+    uint16_t changed = motionCommands.drain();
+    if (changed & (1 << AXIS_NECK_ROTATE)) neckRotate = motionCommands.target(AXIS_NECK_ROTATE);
+    if (changed & (1 << AXIS_NECK_TILT_FORWARD)) neckTiltForward = motionCommands.target(AXIS_NECK_TILT_FORWARD);
+    if (changed & (1 << AXIS_NECK_TILT_SIDEWAYS)) neckTiltSideways = motionCommands.target(AXIS_NECK_TILT_SIDEWAYS);
+    if (changed & (1 << AXIS_BODY_ROTATE)) bodyRotate = motionCommands.target(AXIS_BODY_ROTATE);
+    if (changed & (1 << AXIS_BODY_TILT_FORWARD)) bodyTiltForward = motionCommands.target(AXIS_BODY_TILT_FORWARD);
+    if (changed & (1 << AXIS_BODY_TILT_SIDEWAYS)) bodyTiltSideways = motionCommands.target(AXIS_BODY_TILT_SIDEWAYS);
+    if (changed & (1 << AXIS_MONOCLE)) monoclePosition = motionCommands.target(AXIS_MONOCLE);
+    if (motionCommands.automaticChanged()) automaticAnimations = motionCommands.automatic();
+}
+
+// Monocle, neck and body servos, written to the PCA9685 at the end of every run
+void servoTask()
+{
+    currentMillis = halMillis();
+    applyMotionCommands();
+
+    // --- Control Monocle ---
+    if (enableMonacle && automaticAnimations == false)
+    {
+        // The monocle position is directly set via monoclePosition global variable
+        // and handled by HuyangNeck (assuming setMonoclePosition exists and is public)
+        huyangNeck->setMonoclePosition(monoclePosition + calMonoclePosition); // Apply calibration
+    }
+
+    // --- Control Neck ---
+    // The HuyangNeck class handles its own loop and state transitions.
+    // If automatic animations are off, manual control values are passed.
+    huyangNeck->automatic = automaticAnimations; // Pass automatic flag to neck
+    if (automaticAnimations == false) // If manual control
+    {
+        // Apply calibration to the manual control values
+        double calibratedNeckRotate = neckRotate + calNeckRotation;
+        double calibratedNeckTiltForward = neckTiltForward + calNeckTiltForward;
+        double calibratedNeckTiltSideways = neckTiltSideways + calNeckTiltSideways;
+
+        huyangNeck->rotateHead(calibratedNeckRotate);
+        huyangNeck->tiltNeckForward(calibratedNeckTiltForward);
+        huyangNeck->tiltNeckSideways(calibratedNeckTiltSideways);
+    }
+    uint32_t start = LoopMetrics::now();
+    huyangNeck->loop(); // Run the neck control loop
+    loopMetrics->record(METRICS_NECK, start);
+
+    // --- Control Body ---
+    // The HuyangBody class handles its own loop and state transitions.
+    // If automatic animations are off, manual control values are passed.
+    huyangBody->automatic = automaticAnimations;
+
+    if (automaticAnimations == false) // If manual control
+    {
+        // Apply calibration to the manual control values
+        int16_t calibratedBodyRotate = bodyRotate + calBodyRotation;
+        int16_t calibratedBodyTiltForward = bodyTiltForward + calBodyTiltForward;
+        int16_t calibratedBodyTiltSideways = bodyTiltSideways + calBodyTiltSideways;
+
+        huyangBody->rotateBody(calibratedBodyRotate);
+        huyangBody->tiltBodyForward(calibratedBodyTiltForward);
+        huyangBody->tiltBodySideways(calibratedBodyTiltSideways);
+    }
+    start = LoopMetrics::now();
+    huyangBody->loop(); // Run the body control loop
+    loopMetrics->record(METRICS_BODY, start);
+
+    // --- Servo Outputs ---
+    // Neck and body only buffered their servo values, write the changed channels in I2C bursts
+    servoFrame->flush();
+}
+
+// Chest lights, based on the global chest light mode
+void lightsTask()
+{
+    if (!enableTorsoLights) return;
+
+    // Set by the /api/lights handler
+    huyangBody->currentLightMode = (LightMode)chestLightMode;
+    uint32_t start = LoopMetrics::now();
+    huyangBody->updateChestLights();
+    loopMetrics->record(METRICS_LIGHTS, start);
+}
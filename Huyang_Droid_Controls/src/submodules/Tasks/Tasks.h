@@ -0,0 +1,39 @@
+#ifndef Tasks_h
+#define Tasks_h
+
+#include <Arduino.h>
+#include "../WebServer/WebServer.h" // Robot state and the command queues of the network handlers
+#include "../LoopMetrics/LoopMetrics.h" // Subsystem loop timings
+#include "../../classes/HuyangFace/HuyangFace.h"
+#include "../../classes/HuyangNeck/HuyangNeck.h"
+#include "../../classes/HuyangBody/HuyangBody.h"
+#include "../../classes/ServoFrame/ServoFrame.h"
+
+// Control tasks of the robot, registered with the Scheduler by Huyang_Droid_Controls.ino.
+// They live here instead of in the sketch, so host/replay runs exactly the code of the robot.
+// The objects and flags below are defined by the sketch (and by host/replay on the PC).
+
+extern HuyangFace *huyangFace;
+extern HuyangNeck *huyangNeck;
+extern HuyangBody *huyangBody;
+extern ServoFrame *servoFrame;
+extern LoopMetrics *loopMetrics;
+extern unsigned long currentMillis;
+
+extern bool enableEyes;
+extern bool enableMonacle;
+extern bool enableTorsoLights;
+
+// Face (Eyes): applies the queued eye commands and runs the eye animations
+void faceTask();
+
+// Monocle, neck and body servos, written to the PCA9685 at the end of every run
+void servoTask();
+
+// Chest lights, based on the global chest light mode
+void lightsTask();
+
+// Takes the motion targets the network handlers set since the last run, called by servoTask()
+void applyMotionCommands();
+
+#endif
@@ -1,5 +1,5 @@
 #include "WebServer.h" // Include the corresponding header file for WebServer class declaration
-#include "../../config.h"    // For WebServerPort and other config defines (relative path)
+#include "../../../config.h" // For WebServerPort and other config defines (relative path)
 #include <ESPAsyncWebServer.h> // For AsyncWebServerRequest
 #include <ArduinoJson.h> // For JSON parsing
 #include "FS.h" // For File System
@@ -14,6 +14,10 @@
 #include "../../classes/HuyangBody/HuyangBody.h"   // Corrected relative path
 #include "../../classes/HuyangNeck/HuyangNeck.h"   // Corrected relative path
 #include "../../classes/HuyangAudio/HuyangAudio.h" // Corrected relative path (uncomment if used)
+#include "../../classes/ServoFrame/ServoFrame.h"   // For the servo write statistics
+#include "../Scheduler/Scheduler.h"                // For the task timing statistics
+#include "../LoopMetrics/LoopMetrics.h"            // For the loop section timings
+#include "../Log/Log.h"                            // Serial messages of the control handlers
 
 // Define the file path for calibration data on LittleFS
 #define CALIBRATION_FILE "/calibrations.json" 
@@ -24,7 +28,7 @@
 // to control the robot's hardware.
 
 // Control flags
-bool automaticAnimations = true; // Default to automatic
+std::atomic<bool> automaticAnimations(true); // Default to automatic
 uint16_t allEyes = 0; // No specific "all eyes" command active by default
 uint16_t faceLeftEyeState = 3;  // Default to blink (state 3)
 uint16_t faceRightEyeState = 3; // Default to blink (state 3)
@@ -53,6 +57,12 @@ int16_t calMonoclePosition = 0; // Corrected definition to calMonoclePosition
 // Chest light mode (default to LIGHT_STATIC_BLUE) - Defined here as it's a global state
 LightMode chestLightMode = LIGHT_STATIC_BLUE; // Changed type to LightMode and initialized with enum value
 
+// Eye commands. The face runs in its own task on ESP32, so the handlers never call HuyangFace directly.
+SpscRing<FaceCommand, 8> faceCommands;
+
+// Servo commands. Only the servo task moves the servos and writes the manual targets above.
+MotionCommands motionCommands;
+
 // Settings values (defaults, loaded from file if present)
 String robotName = "Huyang Robot";
 int16_t masterMovementSpeed = 100; // Type now matches header (int16_t)
@@ -64,6 +74,9 @@ extern HuyangFace *huyangFace;
 extern HuyangBody *huyangBody;
 extern HuyangNeck *huyangNeck;
 extern HuyangAudio *huyangAudio; // Assuming HuyangAudio exists and is extern
+extern ServoFrame *servoFrame;
+extern Scheduler *scheduler;
+extern LoopMetrics *loopMetrics;
 
 // --- WebServer Class Implementation ---
 
@@ -77,6 +90,8 @@ WebServer::WebServer() : WebServer(80)
 WebServer::WebServer(uint32_t port)
 {
     _server = new AsyncWebServer(port);
+    _socket = new AsyncWebSocket(WebServer_SOCKET_PATH);
+    memset(_socketClients, 0, sizeof(_socketClients));
 }
 
 
@@ -113,11 +128,30 @@ void WebServer::setup(bool enableEyes,
     }
     Serial.println("LittleFS mounted successfully.");
 
+    // Identifies this run in the ETags of /api/calibration
+    _bootId = (uint32_t)random(0x7FFFFFFF);
+
     // Load calibration and settings data on startup
+    _config.begin(LittleFS);
     loadCalibration();
     // loadSettings(); // Settings are now loaded as part of loadCalibration
 
+    // --- WebSocket control channel ---
+    // Registered before the static files, so the upgrade request never reaches the file handler
+    _socket->onEvent([this](AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len) {
+        this->onSocketEvent(server, client, type, arg, data, len);
+    });
+    _server->addHandler(_socket);
+    Serial.println("WebSocket " WebServer_SOCKET_PATH " configured.");
+
+    // --- Serve compressed files ---
+    // Files listed in the manifest of tools/compress_assets.py, with ETag and Cache-Control
+    _assets.begin(LittleFS);
+    _server->addHandler(&_assets);
+    Serial.println("Asset handler configured.");
+
     // --- Serve static files ---
+    // Everything not served by the asset handler
     // This line serves all files from the root of LittleFS.
     // Ensure your HTML, CSS, JS files are uploaded to the LittleFS root.
     _server->serveStatic("/", LittleFS, "/"); //.setDefaultAuthentication("user", "password"); // Optional authentication
@@ -131,38 +165,69 @@ void WebServer::setup(bool enableEyes,
     });
     Serial.println("GET /api/calibration route configured.");
 
+    // GET /api/servos - Returns how many PCA9685 writes were issued and how many were suppressed,
+    // and how many motion targets were received, applied and superseded before being applied
+    _server->on("/api/servos", HTTP_GET, [&](AsyncWebServerRequest *request) {
+        this->apiGetServoStats(request);
+    });
+    Serial.println("GET /api/servos route configured.");
+
+    // GET /api/scheduler - Returns period, runtime, lateness and overruns of every scheduler task
+    _server->on("/api/scheduler", HTTP_GET, [&](AsyncWebServerRequest *request) {
+        this->apiGetSchedulerStats(request);
+    });
+    Serial.println("GET /api/scheduler route configured.");
+
+    // GET /api/metrics - Returns min/avg/p99/max and a histogram of the loop() and subsystem loop durations
+    _server->on("/api/metrics", HTTP_GET, [&](AsyncWebServerRequest *request) {
+        this->apiGetMetrics(request);
+    });
+    Serial.println("GET /api/metrics route configured.");
+
+    // GET /api/config - Returns the stored calibration and settings as JSON
+    _server->on("/api/config", HTTP_GET, [&](AsyncWebServerRequest *request) {
+        this->apiGetConfig(request);
+    });
+    Serial.println("GET /api/config route configured.");
+
+    // GET /api/system - Returns free heap, largest free block and heap fragmentation
+    _server->on("/api/system", HTTP_GET, [&](AsyncWebServerRequest *request) {
+        this->apiGetSystem(request);
+    });
+    Serial.println("GET /api/system route configured.");
+
     // POST /api/action - For general robot control commands (eyes, neck, body, monocle, automatic)
     _server->on("/api/action", HTTP_POST, [&](AsyncWebServerRequest *request){}, NULL,
                 [&](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-        this->apiPostAction(request, data, len, index, total);
+        this->onBody(request, data, len, index, total, &WebServer::apiPostAction);
     });
     Serial.println("POST /api/action route configured.");
 
     // POST /api/calibrate - For calibration specific actions (update, save, reset)
     _server->on("/api/calibrate", HTTP_POST, [&](AsyncWebServerRequest *request){}, NULL,
                 [&](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-        this->apiCalibratePostAction(request, data, len, index, total);
+        this->onBody(request, data, len, index, total, &WebServer::apiCalibratePostAction);
     });
     Serial.println("POST /api/calibrate route configured.");
 
     // POST /api/lights - For chest light control
     _server->on("/api/lights", HTTP_POST, [&](AsyncWebServerRequest *request){}, NULL,
                 [&](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-        this->apiLightsPostAction(request, data, len, index, total);
+        this->onBody(request, data, len, index, total, &WebServer::apiLightsPostAction);
     });
     Serial.println("POST /api/lights route configured.");
 
     // POST /api/settings - For general robot settings (name, speed)
     _server->on("/api/settings", HTTP_POST, [&](AsyncWebServerRequest *request){}, NULL,
                 [&](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-        this->apiSettingsPostAction(request, data, len, index, total);
+        this->onBody(request, data, len, index, total, &WebServer::apiSettingsPostAction);
     });
     Serial.println("POST /api/settings route configured.");
 
     // POST /api/system - For system commands (reboot, factory reset)
     _server->on("/api/system", HTTP_POST, [&](AsyncWebServerRequest *request){}, NULL,
                 [&](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
-        this->apiSystemPostAction(request, data, len, index, total);
+        this->onBody(request, data, len, index, total, &WebServer::apiSystemPostAction);
     });
     Serial.println("POST /api/system route configured.");
 
@@ -183,6 +248,138 @@ void WebServer::start()
     // For now, it doesn't need explicit code here.
 }
 
+void WebServer::loop()
+{
+    // Frees closed connections and closes the oldest ones beyond the limit
+    _socket->cleanupClients(WebServer_SOCKET_CLIENTS);
+
+    // Writes calibration changes once they settled
+    _config.loop();
+
+    // Sampled here as well, so minFreeHeap also covers the time between /api/system requests
+    updateHeapStats();
+}
+
+// --- WebSocket control channel ---
+
+void WebServer::onSocketEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len)
+{
+    switch (type)
+    {
+    case WS_EVT_CONNECT:
+    {
+        Serial.printf("WebSocket: Client %lu connected.\n", (unsigned long)client->id());
+        SocketClient *slot = socketClient(0); // Free slot, without one the client works without stale frame checks
+        if (slot)
+        {
+            slot->id = client->id();
+            slot->sequence = 0;
+        }
+        break;
+    }
+    case WS_EVT_DISCONNECT:
+    {
+        Serial.printf("WebSocket: Client %lu disconnected.\n", (unsigned long)client->id());
+        SocketClient *slot = socketClient(client->id());
+        if (slot) slot->id = 0;
+        break;
+    }
+    case WS_EVT_DATA:
+    {
+        // Control frames are a few bytes, they always arrive as one complete binary message
+        AwsFrameInfo *info = (AwsFrameInfo *)arg;
+        if (!info->final || info->index != 0 || info->len != len || info->opcode != WS_BINARY)
+        {
+            socketRejected++;
+            return;
+        }
+        handleSocketFrame(client, data, len);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// Hands the axis values of one control frame to the servo task, no response is sent
+void WebServer::handleSocketFrame(AsyncWebSocketClient *client, const uint8_t *data, size_t len)
+{
+    if (len < WebServer_SOCKET_HEADER)
+    {
+        socketRejected++;
+        return;
+    }
+
+    uint16_t sequence = data[0] | (data[1] << 8);
+    uint8_t axis = data[2];
+    uint8_t count = data[3];
+    if (count == 0 || axis + count > AXIS_COUNT || len != WebServer_SOCKET_HEADER + 2 * (size_t)count)
+    {
+        socketRejected++;
+        return;
+    }
+
+    // A frame with a sequence number at or before the last applied one is outdated
+    SocketClient *slot = socketClient(client->id());
+    if (slot)
+    {
+        if (slot->sequence != 0 && (int16_t)(sequence - slot->sequence) <= 0)
+        {
+            socketStale++;
+            return;
+        }
+        slot->sequence = sequence == 0 ? 1 : sequence; // 0 marks "nothing received yet"
+    }
+
+    socketFrames++;
+    const uint8_t *value = data + WebServer_SOCKET_HEADER;
+    for (uint8_t i = 0; i < count; i++, value += 2)
+    {
+        uint8_t current = axis + i;
+        if (!axisEnabled(current)) continue;
+
+        int16_t raw = (int16_t)(value[0] | (value[1] << 8));
+        if (current == AXIS_MONOCLE)
+        {
+            motionCommands.setAxis(AXIS_MONOCLE, raw);
+        }
+        else
+        {
+            // Same mapping as /api/action: -100..100 to -90..90 degrees
+            motionCommands.setAxis((MotionAxis)current, map(constrain((long)raw, -100L, 100L), -100, 100, -90, 90));
+        }
+    }
+}
+
+// Slot of a connected client, or a free slot for id 0
+WebServer::SocketClient *WebServer::socketClient(uint32_t id)
+{
+    for (uint8_t i = 0; i < WebServer_SOCKET_CLIENTS; i++)
+    {
+        if (_socketClients[i].id == id) return &_socketClients[i];
+    }
+    return nullptr;
+}
+
+bool WebServer::axisEnabled(uint8_t axis)
+{
+    switch (axis)
+    {
+    case AXIS_NECK_ROTATE:
+    case AXIS_NECK_TILT_FORWARD:
+    case AXIS_NECK_TILT_SIDEWAYS:
+        return _enableNeckMovement || _enableHeadRotation;
+    case AXIS_BODY_ROTATE:
+    case AXIS_BODY_TILT_FORWARD:
+    case AXIS_BODY_TILT_SIDEWAYS:
+        return _enableBodyMovement || _enableBodyRotation;
+    case AXIS_MONOCLE:
+        return _enableMonacle;
+    default:
+        return false;
+    }
+}
+
 // Helper function to read file from LittleFS
 String WebServer::readFile(const char *path)
 {
@@ -204,36 +401,155 @@ String WebServer::readFile(const char *path)
     return content;
 }
 
-// Helper function to write file to LittleFS
-void WebServer::writeFile(const char *path, const char *message)
+// --- Request bodies ---
+
+// Collects a POST body that may arrive in several chunks and hands it to the handler once complete.
+// A body that arrives in one chunk, the usual case for the small API requests, is passed on as is.
+// Larger ones are copied once into a slot of the body pool, and parsed in place from there.
+void WebServer::onBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total, BodyHandler handler)
 {
-    Serial.printf("Writing file: %s\n", path);
-    File file = LittleFS.open(path, "w");
-    if (!file)
+    if (index == 0 && len == total)
     {
-        Serial.printf("Failed to open file for writing: %s\n", path);
+        (this->*handler)(request, data, len);
         return;
     }
-    if (file.print(message))
+
+    BodySlot *slot = bodySlot(request);
+    if (index == 0)
     {
-        Serial.println("File written successfully.");
+        if (total > WebServer_BODY_CAPACITY)
+        {
+            Serial.printf("%s: Body of %u bytes exceeds %u bytes.\n", request->url().c_str(), (unsigned)total, (unsigned)WebServer_BODY_CAPACITY);
+            request->send(413, "application/json", "{\"status\":\"error\", \"message\":\"Request body too large\"}");
+            return;
+        }
+        slot = bodySlot(nullptr);
+        if (!slot)
+        {
+            Serial.printf("%s: No free body buffer.\n", request->url().c_str());
+            request->send(503, "application/json", "{\"status\":\"error\", \"message\":\"Server busy\"}");
+            return;
+        }
+        slot->request = request;
+        slot->length = 0;
+        // A client that goes away in the middle of the body must not keep the slot
+        request->onDisconnect([this, request]() { releaseBody(request); });
     }
-    else
+
+    // Chunks of a rejected body have no slot and are dropped, the response was already sent
+    if (!slot || index != slot->length || index + len > WebServer_BODY_CAPACITY) return;
+
+    memcpy(slot->data + index, data, len);
+    slot->length += len;
+    if (slot->length == total)
     {
-        Serial.println("File write failed.");
+        (this->*handler)(request, slot->data, slot->length);
+        releaseBody(request);
     }
-    file.close();
+}
+
+// Slot assembling the body of the request, or a free slot for nullptr
+WebServer::BodySlot *WebServer::bodySlot(AsyncWebServerRequest *request)
+{
+    for (uint8_t i = 0; i < WebServer_BODY_SLOTS; i++)
+    {
+        if (_bodySlots[i].request == request) return &_bodySlots[i];
+    }
+    return nullptr;
+}
+
+void WebServer::releaseBody(AsyncWebServerRequest *request)
+{
+    BodySlot *slot = bodySlot(request);
+    if (slot) slot->request = nullptr;
+}
+
+// --- JSON helpers ---
+
+// The document shared by all API handlers. AsyncTCP runs the handlers one after another, so a
+// single preallocated document replaces the heap allocation every request used to make.
+JsonDocument &WebServer::json()
+{
+    _json.clear();
+    return _json;
+}
+
+// Parses a request body into _json, answering 400 itself when that fails.
+// The body is parsed in place (zero-copy), strings read from the document point into data and stay
+// valid until the handler returns, even when the handler reuses the document.
+bool WebServer::parseBody(AsyncWebServerRequest *request, uint8_t *data, size_t len)
+{
+    if (len == 0) {
+        Serial.printf("%s: Empty request body.\n", request->url().c_str());
+        request->send(400, "text/plain", "Bad Request: Empty body.");
+        return false;
+    }
+
+    DeserializationError error = deserializeJson(json(), (char *)data, len);
+    if (error)
+    {
+        Serial.print(F("deserializeJson() failed: "));
+        Serial.println(error.f_str());
+        request->send(400, "application/json", "{\"status\":\"error\", \"message\":\"Invalid JSON\"}");
+        return false;
+    }
+    return true;
+}
+
+// Serializes the document straight into the response buffer, without a String in between
+void WebServer::sendJson(AsyncWebServerRequest *request, JsonDocument &doc)
+{
+    AsyncResponseStream *response = request->beginResponseStream("application/json");
+    serializeJson(doc, *response);
+    request->send(response);
+}
+
+// Copies the calibration and settings globals into a ConfigData
+void WebServer::fillConfig(ConfigData &data)
+{
+    memset(&data, 0, sizeof(data)); // Unused bytes of robotName take part in the change detection
+    data.neckRotation = calNeckRotation;
+    data.neckTiltForward = calNeckTiltForward;
+    data.neckTiltSideways = calNeckTiltSideways;
+    data.bodyRotation = calBodyRotation;
+    data.bodyTiltForward = calBodyTiltForward;
+    data.bodyTiltSideways = calBodyTiltSideways;
+    data.monoclePosition = calMonoclePosition;
+    data.masterMovementSpeed = masterMovementSpeed;
+    strlcpy(data.robotName, robotName.c_str(), sizeof(data.robotName));
 }
 
 // Load calibration data from file
 void WebServer::loadCalibration()
 {
     Serial.println("Loading calibration data...");
-    String jsonString = readFile(CALIBRATION_FILE);
-    if (jsonString.length() > 0)
+
+    // Fields missing in an older file keep the defaults of the globals
+    ConfigData data;
+    fillConfig(data);
+    if (_config.load(data))
     {
-        DynamicJsonDocument doc(512); // Adjust size as needed
-        DeserializationError error = deserializeJson(doc, jsonString);
+        calNeckRotation = data.neckRotation;
+        calNeckTiltForward = data.neckTiltForward;
+        calNeckTiltSideways = data.neckTiltSideways;
+        calBodyRotation = data.bodyRotation;
+        calBodyTiltForward = data.bodyTiltForward;
+        calBodyTiltSideways = data.bodyTiltSideways;
+        calMonoclePosition = data.monoclePosition;
+        masterMovementSpeed = data.masterMovementSpeed;
+        robotName = data.robotName;
+        Serial.println("Calibration and settings data loaded.");
+        return;
+    }
+
+    // Calibration saved as JSON by earlier firmware, imported once into the config store
+    if (LittleFS.exists(CALIBRATION_FILE))
+    {
+        // Parsed straight from the file instead of reading it into a String first
+        File file = LittleFS.open(CALIBRATION_FILE, "r");
+        JsonDocument &doc = json();
+        DeserializationError error = deserializeJson(doc, file);
+        file.close();
         if (error)
         {
             Serial.print(F("deserializeJson for calibration failed: "));
@@ -251,7 +567,8 @@ void WebServer::loadCalibration()
             // Load settings from calibration file as well (if they are stored there)
             robotName = doc["settings"]["robotName"] | "Huyang Robot";
             masterMovementSpeed = doc["settings"]["masterMovementSpeed"] | 100;
-            Serial.println("Calibration and settings data loaded.");
+            saveCalibration();
+            Serial.println("Calibration and settings data imported from " CALIBRATION_FILE ".");
             return; // Return if successful
         }
     }
@@ -259,28 +576,13 @@ void WebServer::loadCalibration()
     resetCalibrationToDefaults(); // Ensure defaults are applied and saved if file is missing/empty/corrupt
 }
 
-// Save calibration data to file
+// Hands the calibration and settings to the config store, which writes them to flash once they
+// stopped changing for ConfigStore_FLUSH_DELAY
 void WebServer::saveCalibration()
 {
-    Serial.println("Saving calibration data...");
-    DynamicJsonDocument doc(512); // Adjust size as needed
-
-    doc["neck"]["rotation"] = calNeckRotation;
-    doc["neck"]["tiltForward"] = calNeckTiltForward;
-    doc["neck"]["tiltSideways"] = calNeckTiltSideways;
-    doc["body"]["rotation"] = calBodyRotation;
-    doc["body"]["tiltForward"] = calBodyTiltForward;
-    doc["body"]["tiltSideways"] = calBodyTiltSideways;
-    doc["monocle"]["position"] = calMonoclePosition; // Save monocle calibration
-
-    // Save settings along with calibration
-    doc["settings"]["robotName"] = robotName;
-    doc["settings"]["masterMovementSpeed"] = masterMovementSpeed;
-
-    String jsonString;
-    serializeJson(doc, jsonString);
-    writeFile(CALIBRATION_FILE, jsonString.c_str());
-    Serial.println("Calibration and settings data saved.");
+    ConfigData data;
+    fillConfig(data);
+    _config.update(data);
 }
 
 // Reset calibration to defaults (0) and save
@@ -299,60 +601,48 @@ void WebServer::resetCalibrationToDefaults()
     robotName = "Huyang Robot";
     masterMovementSpeed = 100;
 
-    saveCalibration(); // Save the reset values
+    saveCalibration(); // Store the reset values
     Serial.println("Calibration reset to defaults and saved.");
 }
 
 // --- API Action Handlers ---
 
 // Handles POST requests to /api/action for robot control
-void WebServer::apiPostAction(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+void WebServer::apiPostAction(AsyncWebServerRequest *request, uint8_t *data, size_t len)
 {
-    Serial.println("apiPostAction received.");
-    if (len == 0) {
-        Serial.println("apiPostAction: Empty request body.");
-        request->send(400, "text/plain", "Bad Request: Empty body.");
-        return;
-    }
-
-    DynamicJsonDocument doc(1024); // Adjust size as needed
-    DeserializationError error = deserializeJson(doc, data, len);
-
-    if (error)
-    {
-        Serial.print(F("deserializeJson() failed: "));
-        Serial.println(error.f_str());
-        request->send(400, "application/json", "{\"status\":\"error\", \"message\":\"Invalid JSON\"}");
-        return;
-    }
+    LOG_DEBUG("apiPostAction received.");
+    if (!parseBody(request, data, len)) return;
+    JsonDocument &doc = _json;
 
-    String type = doc["type"];
-    Serial.printf("apiPostAction: Type received: %s\n", type.c_str());
+    const char *type = doc["type"] | "";
+    LOG_DEBUG("apiPostAction: Type received: %s", type);
 
     // --- Handle EYE commands ---
-    if (type == "eye" && _enableEyes)
+    if (strcmp(type, "eye") == 0 && _enableEyes)
     {
-        String target = doc["target"];
+        const char *target = doc["target"] | "";
         uint16_t state = doc["state"];
-        Serial.printf("apiPostAction: Eye command - Target: %s, State: %d\n", target.c_str(), state);
+        LOG_DEBUG("apiPostAction: Eye command - Target: %s, State: %d", target, state);
 
-        if (target == "all")
-        {
-            // Ensure huyangFace is initialized before calling its methods
-            if (huyangFace) huyangFace->setEyesTo(huyangFace->getStateFrom(state));
-        }
-        else if (target == "left")
+        FaceCommand command = {FACE_ALL, state};
+        if (strcmp(target, "left") == 0) command.target = FACE_LEFT;
+        else if (strcmp(target, "right") == 0) command.target = FACE_RIGHT;
+        else if (strcmp(target, "all") != 0)
         {
-            if (huyangFace) huyangFace->setLeftEyeTo(huyangFace->getStateFrom(state));
+            request->send(400, "application/json", "{\"status\":\"error\", \"message\":\"Unknown eye target\"}");
+            return;
         }
-        else if (target == "right")
+
+        // Applied by the face task on its next run
+        if (!faceCommands.push(command))
         {
-            if (huyangFace) huyangFace->setRightEyeTo(huyangFace->getStateFrom(state));
+            request->send(503, "application/json", "{\"status\":\"error\", \"message\":\"Eye command queue full\"}");
+            return;
         }
         request->send(200, "application/json", "{\"status\":\"success\", \"message\":\"Eye command received\"}");
     }
     // --- Handle NECK commands ---
-    else if (type == "neck" && (_enableNeckMovement || _enableHeadRotation))
+    else if (strcmp(type, "neck") == 0 && (_enableNeckMovement || _enableHeadRotation))
     {
         // Assume UI sends values from -100 to 100, map to -90 to 90 degrees
         double inputRotate = doc["rotate"] | 0.0;
@@ -360,26 +650,22 @@ void WebServer::apiPostAction(AsyncWebServerRequest *request, uint8_t *data, siz
         double inputTiltSideways = doc["tiltSideways"] | 0.0;
 
         // Map incoming values (e.g., -100 to 100) to actual -90 to 90 degrees
-        neckRotate = map((long)inputRotate, -100, 100, -90, 90);
-        neckTiltForward = map((long)inputTiltForward, -100, 100, -90, 90);
-        neckTiltSideways = map((long)inputTiltSideways, -100, 100, -90, 90);
-
-        Serial.printf("apiPostAction: Neck command - Raw Input R:%.2f, TF:%.2f, TS:%.2f\n", inputRotate, inputTiltForward, inputTiltSideways);
-        Serial.printf("apiPostAction: Neck command - Mapped Degrees R:%.2f, TF:%.2f, TS:%.2f\n", neckRotate, neckTiltForward, neckTiltSideways);
-
-        // Call HuyangNeck methods (assuming they are public and handle the movement)
-        if (huyangNeck) {
-            huyangNeck->rotateHead(neckRotate);
-            huyangNeck->tiltNeckForward(neckTiltForward);
-            huyangNeck->tiltNeckSideways(neckTiltSideways);
-        } else {
-            Serial.println("HuyangNeck instance is null, cannot set neck movements.");
-        }
+        int16_t rotate = map((long)inputRotate, -100, 100, -90, 90);
+        int16_t tiltForward = map((long)inputTiltForward, -100, 100, -90, 90);
+        int16_t tiltSideways = map((long)inputTiltSideways, -100, 100, -90, 90);
+
+        LOG_DEBUG("apiPostAction: Neck command - Raw Input R:%.2f, TF:%.2f, TS:%.2f", inputRotate, inputTiltForward, inputTiltSideways);
+        LOG_DEBUG("apiPostAction: Neck command - Mapped Degrees R:%d, TF:%d, TS:%d", rotate, tiltForward, tiltSideways);
+
+        // Latest target for the servo task, which moves the neck on its next tick
+        motionCommands.setAxis(AXIS_NECK_ROTATE, rotate);
+        motionCommands.setAxis(AXIS_NECK_TILT_FORWARD, tiltForward);
+        motionCommands.setAxis(AXIS_NECK_TILT_SIDEWAYS, tiltSideways);
 
         request->send(200, "application/json", "{\"status\":\"success\", \"message\":\"Neck command received\"}");
     }
     // --- Handle BODY commands ---
-    else if (type == "body" && (_enableBodyMovement || _enableBodyRotation))
+    else if (strcmp(type, "body") == 0 && (_enableBodyMovement || _enableBodyRotation))
     {
         // Assume UI sends values from -100 to 100, map to -90 to 90 degrees
         int16_t inputRotate = doc["rotate"] | 0;
@@ -387,117 +673,92 @@ void WebServer::apiPostAction(AsyncWebServerRequest *request, uint8_t *data, siz
         int16_t inputTiltSideways = doc["tiltSideways"] | 0;
 
         // Map incoming values (e.g., -100 to 100) to actual -90 to 90 degrees
-        bodyRotate = map(inputRotate, -100, 100, -90, 90);
-        bodyTiltForward = map(inputTiltForward, -100, 100, -90, 90);
-        bodyTiltSideways = map(inputTiltSideways, -100, 100, -90, 90);
-
-        Serial.printf("apiPostAction: Body command - Raw Input R:%d, TF:%d, TS:%d\n", inputRotate, inputTiltForward, inputTiltSideways);
-        Serial.printf("apiPostAction: Body command - Mapped Degrees R:%d, TF:%d, TS:%d\n", bodyRotate, bodyTiltForward, bodyTiltSideways);
-
-        // Call HuyangBody methods (assuming they are public and handle the movement)
-        if (huyangBody) {
-            huyangBody->rotateBody(bodyRotate);
-            huyangBody->tiltBodyForward(bodyTiltForward);
-            huyangBody->tiltBodySideways(bodyTiltSideways);
-        } else {
-            Serial.println("HuyangBody instance is null, cannot set body movements.");
-        }
+        int16_t rotate = map(inputRotate, -100, 100, -90, 90);
+        int16_t tiltForward = map(inputTiltForward, -100, 100, -90, 90);
+        int16_t tiltSideways = map(inputTiltSideways, -100, 100, -90, 90);
+
+        LOG_DEBUG("apiPostAction: Body command - Raw Input R:%d, TF:%d, TS:%d", inputRotate, inputTiltForward, inputTiltSideways);
+        LOG_DEBUG("apiPostAction: Body command - Mapped Degrees R:%d, TF:%d, TS:%d", rotate, tiltForward, tiltSideways);
+
+        // Latest target for the servo task, which moves the body on its next tick
+        motionCommands.setAxis(AXIS_BODY_ROTATE, rotate);
+        motionCommands.setAxis(AXIS_BODY_TILT_FORWARD, tiltForward);
+        motionCommands.setAxis(AXIS_BODY_TILT_SIDEWAYS, tiltSideways);
 
         request->send(200, "application/json", "{\"status\":\"success\", \"message\":\"Body command received\"}");
     }
     // --- Handle MONOCLE commands ---
-    else if (type == "monocle" && _enableMonacle)
+    else if (strcmp(type, "monocle") == 0 && _enableMonacle)
     {
         // Monocle assumed to receive 0-180 directly or a specific mapped range
-        int16_t position = doc["position"] | monoclePosition;
-        monoclePosition = position; // No mapping applied here, assume UI sends correct range for monocle
+        int16_t position = doc["position"] | monoclePosition; // No mapping applied here, assume UI sends correct range for monocle
 
-        if (huyangNeck) {
-            Serial.printf("HuyangNeck: Calling setMonoclePosition(%d)\n", monoclePosition);
-            huyangNeck->setMonoclePosition(monoclePosition); // Call the specific monocle method
-        } else {
-            Serial.println("HuyangNeck instance is null, cannot set monocle position.");
-        }
-        Serial.printf("apiPostAction: Monocle command - Position: %d\n", monoclePosition);
+        // Latest target for the servo task, which moves the monocle on its next tick
+        motionCommands.setAxis(AXIS_MONOCLE, position);
+        LOG_DEBUG("apiPostAction: Monocle command - Position: %d", position);
         request->send(200, "application/json", "{\"status\":\"success\", \"message\":\"Monocle command received\"}");
     }
     // --- Handle AUTOMATIC command ---
-    else if (type == "automatic")
+    else if (strcmp(type, "automatic") == 0)
     {
         bool state = doc["state"];
-        automaticAnimations = state;
-        if (huyangFace) huyangFace->setAutomatic(automaticAnimations); // Update the HuyangFace instance
-        if (huyangBody) huyangBody->automatic = automaticAnimations; // Update HuyangBody instance
-        if (huyangNeck) huyangNeck->automatic = automaticAnimations; // Update HuyangNeck instance
-        Serial.printf("apiPostAction: Automatic mode set to: %s\n", automaticAnimations ? "true" : "false");
+        // The servo task switches neck and body, the face task follows automaticAnimations
+        motionCommands.setAutomatic(state);
+        LOG_INFO("apiPostAction: Automatic mode set to: %s", state ? "true" : "false");
         request->send(200, "application/json", "{\"status\":\"success\", \"message\":\"Automatic mode updated\"}");
     }
     else
     {
-        Serial.printf("apiPostAction: Unknown or disabled command type: %s\n", type.c_str());
+        LOG_WARN("apiPostAction: Unknown or disabled command type: %s", type);
         request->send(400, "application/json", "{\"status\":\"error\", \"message\":\"Unknown or disabled command type\"}");
     }
 }
 
 // Handles POST requests to /api/calibrate for calibration actions
-void WebServer::apiCalibratePostAction(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+void WebServer::apiCalibratePostAction(AsyncWebServerRequest *request, uint8_t *data, size_t len)
 {
     Serial.println("apiCalibratePostAction received.");
-    if (len == 0) {
-        Serial.println("apiCalibratePostAction: Empty request body.");
-        request->send(400, "text/plain", "Bad Request: Empty body.");
-        return;
-    }
-
-    DynamicJsonDocument doc(1024);
-    DeserializationError error = deserializeJson(doc, data, len);
-
-    if (error)
-    {
-        Serial.print(F("deserializeJson() failed: "));
-        Serial.println(error.f_str());
-        request->send(400, "application/json", "{\"status\":\"error\", \"message\":\"Invalid JSON\"}");
-        return;
-    }
+    if (!parseBody(request, data, len)) return;
+    JsonDocument &doc = _json;
 
-    String action = doc["action"];
-    Serial.printf("apiCalibratePostAction: Action received: %s\n", action.c_str());
+    const char *action = doc["action"] | "";
+    Serial.printf("apiCalibratePostAction: Action received: %s\n", action);
 
-    if (action == "update")
+    if (strcmp(action, "update") == 0)
     {
-        String type = doc["type"];
-        if (type == "neck")
+        const char *type = doc["type"] | "";
+        if (strcmp(type, "neck") == 0)
         {
             if (doc.containsKey("rotation")) calNeckRotation = doc["rotation"];
             if (doc.containsKey("tiltForward")) calNeckTiltForward = doc["tiltForward"];
             if (doc.containsKey("tiltSideways")) calNeckTiltSideways = doc["tiltSideways"];
             Serial.printf("Calibration Update: Neck - Rot:%d, TF:%d, TS:%d\n", calNeckRotation, calNeckTiltForward, calNeckTiltSideways);
         }
-        else if (type == "body")
+        else if (strcmp(type, "body") == 0)
         {
             if (doc.containsKey("rotation")) calBodyRotation = doc["rotation"];
             if (doc.containsKey("tiltForward")) calBodyTiltForward = doc["tiltForward"];
             if (doc.containsKey("tiltSideways")) calBodyTiltSideways = doc["tiltSideways"];
             Serial.printf("Calibration Update: Body - Rot:%d, TF:%d, TS:%d\n", calBodyRotation, calBodyTiltForward, calBodyTiltSideways);
         }
-        else if (type == "monocle")
+        else if (strcmp(type, "monocle") == 0)
         {
             if (doc.containsKey("position")) calMonoclePosition = doc["position"]; // Use calMonoclePosition
             Serial.printf("Calibration Update: Monocle - Pos:%d\n", calMonoclePosition);
         }
         request->send(200, "application/json", "{\"status\":\"success\", \"message\":\"Calibration update received\"}");
     }
-    else if (action == "save")
+    else if (strcmp(action, "save") == 0)
     {
         saveCalibration();
         request->send(200, "application/json", "{\"status\":\"success\", \"message\":\"Calibration saved\"}");
     }
-    else if (action == "reset")
+    else if (strcmp(action, "reset") == 0)
     {
         resetCalibrationToDefaults();
         request->send(200, "application/json", "{\"status\":\"success\", \"message\":\"Calibration reset\"}");
     }
-    else if (action == "set_middle_and_lock")
+    else if (strcmp(action, "set_middle_and_lock") == 0)
     {
         // This action would typically involve setting all servos to a middle position
         // and then disabling PWM output to "lock" them for horn attachment.
@@ -508,7 +769,7 @@ void WebServer::apiCalibratePostAction(AsyncWebServerRequest *request, uint8_t *
         // Example: if (huyangBody) huyangBody->setAllServosToMiddleAndLock();
         request->send(200, "application/json", "{\"status\":\"success\", \"message\":\"Set middle and lock command received\"}");
     }
-    else if (action == "unlock_servos")
+    else if (strcmp(action, "unlock_servos") == 0)
     {
         // This action would typically re-enable PWM output to servos.
         Serial.println("Command: Unlock servos (implementation needed in HuyangNeck/Body).");
@@ -518,42 +779,25 @@ void WebServer::apiCalibratePostAction(AsyncWebServerRequest *request, uint8_t *
     }
     else
     {
-        Serial.printf("apiCalibratePostAction: Unknown action: %s\n", action.c_str());
+        Serial.printf("apiCalibratePostAction: Unknown action: %s\n", action);
         request->send(400, "application/json", "{\"status\":\"error\", \"message\":\"Unknown calibration action\"}");
     }
 }
 
 // Handles POST requests to /api/lights for chest light control
-void WebServer::apiLightsPostAction(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+void WebServer::apiLightsPostAction(AsyncWebServerRequest *request, uint8_t *data, size_t len)
 {
     Serial.println("apiLightsPostAction received.");
-    if (len == 0) {
-        Serial.println("apiLightsPostAction: Empty request body.");
-        request->send(400, "text/plain", "Bad Request: Empty body.");
-        return;
-    }
-
-    DynamicJsonDocument doc(1024);
-    DeserializationError error = deserializeJson(doc, data, len);
-
-    if (error)
-    {
-        Serial.print(F("deserializeJson() failed: "));
-        Serial.println(error.f_str());
-        request->send(400, "application/json", "{\"status\":\"error\", \"message\":\"Invalid JSON\"}");
-        return;
-    }
+    if (!parseBody(request, data, len)) return;
+    JsonDocument &doc = _json;
 
     uint16_t mode = doc["mode"];
     Serial.printf("apiLightsPostAction: Light mode received: %d\n", mode);
 
     if (_enableTorsoLights) {
-        if (huyangBody) { // Null check added
-            huyangBody->currentLightMode = (LightMode)mode; // Corrected: Cast to global LightMode enum
-            Serial.printf("Chest light mode set to: %d\n", huyangBody->currentLightMode);
-        } else {
-            Serial.println("HuyangBody instance is null, cannot set light mode.");
-        }
+        // Picked up by the lights task on its next run
+        chestLightMode = (LightMode)mode;
+        Serial.printf("Chest light mode set to: %d\n", chestLightMode);
         request->send(200, "application/json", "{\"status\":\"success\", \"message\":\"Chest light mode updated\"}");
     } else {
         Serial.println("Chest lights are disabled in config.");
@@ -562,28 +806,15 @@ void WebServer::apiLightsPostAction(AsyncWebServerRequest *request, uint8_t *dat
 }
 
 // Handles POST requests to /api/settings for robot settings
-void WebServer::apiSettingsPostAction(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+void WebServer::apiSettingsPostAction(AsyncWebServerRequest *request, uint8_t *data, size_t len)
 {
     Serial.println("apiSettingsPostAction received.");
-    if (len == 0) {
-        Serial.println("apiSettingsPostAction: Empty request body.");
-        request->send(400, "text/plain", "Bad Request: Empty body.");
-        return;
-    }
-
-    DynamicJsonDocument doc(1024);
-    DeserializationError error = deserializeJson(doc, data, len);
-
-    if (error)
-    {
-        Serial.print(F("deserializeJson() failed: "));
-        Serial.println(error.f_str());
-        request->send(400, "application/json", "{\"status\":\"error\", \"message\":\"Invalid JSON\"}");
-        return;
-    }
+    if (!parseBody(request, data, len)) return;
+    JsonDocument &doc = _json;
 
     if (doc.containsKey("robotName")) {
-        robotName = doc["robotName"].as<String>();
+        const char *name = doc["robotName"];
+        if (name) robotName = name;
         Serial.printf("Settings Update: Robot Name set to: %s\n", robotName.c_str());
     }
     if (doc.containsKey("masterMovementSpeed")) {
@@ -591,47 +822,35 @@ void WebServer::apiSettingsPostAction(AsyncWebServerRequest *request, uint8_t *d
         Serial.printf("Settings Update: Master Movement Speed set to: %d\n", masterMovementSpeed);
     }
 
-    saveCalibration(); // Save settings (assuming they are stored in the same calibration file)
+    saveCalibration(); // Written to flash once the values stop changing, see ConfigStore
     request->send(200, "application/json", "{\"status\":\"success\", \"message\":\"Settings updated\"}");
 }
 
 // Handles POST requests to /api/system for system commands
-void WebServer::apiSystemPostAction(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)
+void WebServer::apiSystemPostAction(AsyncWebServerRequest *request, uint8_t *data, size_t len)
 {
     Serial.println("apiSystemPostAction received.");
-    if (len == 0) {
-        Serial.println("apiSystemPostAction: Empty request body.");
-        request->send(400, "text/plain", "Bad Request: Empty body.");
-        return;
-    }
+    if (!parseBody(request, data, len)) return;
+    JsonDocument &doc = _json;
 
-    DynamicJsonDocument doc(1024);
-    DeserializationError error = deserializeJson(doc, data, len);
+    const char *command = doc["command"] | "";
+    Serial.printf("apiSystemPostAction: Command received: %s\n", command);
 
-    if (error)
-    {
-        Serial.print(F("deserializeJson() failed: "));
-        Serial.println(error.f_str());
-        request->send(400, "application/json", "{\"status\":\"error\", \"message\":\"Invalid JSON\"}");
-        return;;
-    }
-
-    String command = doc["command"];
-    Serial.printf("apiSystemPostAction: Command received: %s\n", command.c_str());
-
-    if (command == "reboot") {
+    if (strcmp(command, "reboot") == 0) {
         Serial.println("System command: Rebooting ESP.");
+        _config.flush(); // Pending calibration changes would be lost otherwise
         request->send(200, "application/json", "{\"status\":\"success\", \"message\":\"Rebooting...\"}");
         delay(100); // Give time for response to send
         ESP.restart();
-    } else if (command == "factory_reset") {
+    } else if (strcmp(command, "factory_reset") == 0) {
         Serial.println("System command: Performing factory reset.");
-        resetCalibrationToDefaults(); // This also saves
+        resetCalibrationToDefaults();
+        _config.flush();
         request->send(200, "application/json", "{\"status\":\"success\", \"message\":\"Factory reset and rebooting...\"}");
         delay(100); // Give time for response to send
         ESP.restart();
     } else {
-        Serial.printf("apiSystemPostAction: Unknown system command: %s\n", command.c_str());
+        Serial.printf("apiSystemPostAction: Unknown system command: %s\n", command);
         request->send(400, "application/json", "{\"status\":\"error\", \"message\":\"Unknown system command\"}");
     }
 }
@@ -639,49 +858,225 @@ void WebServer::apiSystemPostAction(AsyncWebServerRequest *request, uint8_t *dat
 // NEW: Implementation for apiGetCalibration
 void WebServer::apiGetCalibration(AsyncWebServerRequest *request)
 {
-    Serial.println("GET /api/calibration received.");
-    DynamicJsonDocument r(1024); // Adjust size as needed
+    refreshStatus();
+
+    // Browsers revalidate with the ETag of their cached copy, unchanged state costs a 304 only
+    AsyncWebServerResponse *response;
+    if (request->hasHeader("If-None-Match") && request->getHeader("If-None-Match")->value() == _statusETag)
+    {
+        response = request->beginResponse(304);
+        statusNotModified++;
+    }
+    else
+    {
+        response = request->beginResponse(200, "application/json", _status);
+    }
+    response->addHeader("ETag", _statusETag);
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
+}
+
+// Rebuilds the cached /api/calibration response if one of its fields changed since the last request.
+// The fields are written from many places, so they are compared against a snapshot instead of
+// tracking every write. Returns true if the response was rebuilt.
+bool WebServer::refreshStatus()
+{
+    StatusSnapshot snapshot;
+    memset(&snapshot, 0, sizeof(snapshot)); // Unused bytes of robotName take part in the comparison
+    snapshot.neck[0] = neckRotate;
+    snapshot.neck[1] = neckTiltForward;
+    snapshot.neck[2] = neckTiltSideways;
+    snapshot.body[0] = bodyRotate;
+    snapshot.body[1] = bodyTiltForward;
+    snapshot.body[2] = bodyTiltSideways;
+    snapshot.monoclePosition = monoclePosition;
+    snapshot.calibration[0] = calNeckRotation;
+    snapshot.calibration[1] = calNeckTiltForward;
+    snapshot.calibration[2] = calNeckTiltSideways;
+    snapshot.calibration[3] = calBodyRotation;
+    snapshot.calibration[4] = calBodyTiltForward;
+    snapshot.calibration[5] = calBodyTiltSideways;
+    snapshot.calibration[6] = calMonoclePosition;
+    snapshot.masterMovementSpeed = masterMovementSpeed;
+    snapshot.leftEye = faceLeftEyeState;
+    snapshot.rightEye = faceRightEyeState;
+    snapshot.chestLightMode = huyangBody ? (uint16_t)huyangBody->currentLightMode : 0; // Cast LightMode enum to uint16_t for JSON
+    snapshot.automatic = automaticAnimations;
+    strlcpy(snapshot.robotName, robotName.c_str(), sizeof(snapshot.robotName));
+
+    if (_statusGeneration > 0 && memcmp(&snapshot, &_statusSnapshot, sizeof(snapshot)) == 0) return false;
+    memcpy(&_statusSnapshot, &snapshot, sizeof(snapshot)); // Including the padding, unlike an assignment
+    _statusGeneration++;
+
+    JsonDocument &r = json();
 
     // Include current control values (now in -90 to +90 degree range)
-    r["automatic"] = automaticAnimations;
-    r["face"]["leftEye"] = faceLeftEyeState;
-    r["face"]["rightEye"] = faceRightEyeState;
-    r["neck"]["rotate"] = neckRotate;
-    r["neck"]["tiltForward"] = neckTiltForward;
-    r["neck"]["tiltSideways"] = neckTiltSideways;
-    r["body"]["rotate"] = bodyRotate;
-    r["body"]["tiltForward"] = bodyTiltForward;
-    r["body"]["tiltSideways"] = bodyTiltSideways;
-    r["monoclePosition"] = monoclePosition; // Monocle position is 0-180
+    r["automatic"] = snapshot.automatic;
+    r["face"]["leftEye"] = snapshot.leftEye;
+    r["face"]["rightEye"] = snapshot.rightEye;
+    r["neck"]["rotate"] = snapshot.neck[0];
+    r["neck"]["tiltForward"] = snapshot.neck[1];
+    r["neck"]["tiltSideways"] = snapshot.neck[2];
+    r["body"]["rotate"] = snapshot.body[0];
+    r["body"]["tiltForward"] = snapshot.body[1];
+    r["body"]["tiltSideways"] = snapshot.body[2];
+    r["monoclePosition"] = snapshot.monoclePosition; // Monocle position is 0-180
 
     // Include calibration values
-    r["calibration"]["neckRotation"] = calNeckRotation;
-    r["calibration"]["neckTiltForward"] = calNeckTiltForward;
-    r["calibration"]["neckTiltSideways"] = calNeckTiltSideways;
-    r["calibration"]["bodyRotation"] = calBodyRotation;
-    r["calibration"]["bodyTiltForward"] = calBodyTiltForward;
-    r["calibration"]["bodyTiltSideways"] = calBodyTiltSideways;
-    r["calibration"]["monocle"] = calMonoclePosition; // Include monocle calibration
+    r["calibration"]["neckRotation"] = snapshot.calibration[0];
+    r["calibration"]["neckTiltForward"] = snapshot.calibration[1];
+    r["calibration"]["neckTiltSideways"] = snapshot.calibration[2];
+    r["calibration"]["bodyRotation"] = snapshot.calibration[3];
+    r["calibration"]["bodyTiltForward"] = snapshot.calibration[4];
+    r["calibration"]["bodyTiltSideways"] = snapshot.calibration[5];
+    r["calibration"]["monocle"] = snapshot.calibration[6]; // Include monocle calibration
 
     // Include chest light mode
-    // Ensure huyangBody is not null before accessing its member
-    if (huyangBody) {
-        r["chestLightMode"] = (uint16_t)huyangBody->currentLightMode; // Cast LightMode enum to uint16_t for JSON
-    } else {
-        r["chestLightMode"] = 0; // Default or error state if huyangBody not initialized
-    }
+    r["chestLightMode"] = snapshot.chestLightMode;
 
     // Include settings
-    r["robotName"] = robotName;
-    r["masterMovementSpeed"] = masterMovementSpeed;
-    r["firmwareVersion"] = firmwareVersion;
+    r["robotName"] = (const char *)snapshot.robotName; // Copied, the snapshot is a local
+    r["masterMovementSpeed"] = snapshot.masterMovementSpeed;
+    r["firmwareVersion"] = firmwareVersion.c_str();
+
+    if (measureJson(r) >= sizeof(_status))
+    {
+        Serial.println("refreshStatus: Response exceeds WebServer_STATUS_CAPACITY.");
+    }
+    serializeJson(r, _status, sizeof(_status));
+
+    // The boot id keeps an ETag of the previous run from matching after a restart
+    snprintf(_statusETag, sizeof(_statusETag), "\"%08lx-%lu\"", (unsigned long)_bootId, (unsigned long)_statusGeneration);
+    statusBuilds++;
+    return true;
+}
 
-    String result;
-    serializeJson(r, result);
-    request->send(200, "application/json", result);
-    Serial.println("GET /api/calibration response sent.");
+
+// Servo write statistics of the ServoFrame
+void WebServer::apiGetServoStats(AsyncWebServerRequest *request)
+{
+    JsonDocument &r = json();
+    if (servoFrame) {
+        r["issuedWrites"] = servoFrame->issuedWrites;
+        r["suppressedWrites"] = servoFrame->suppressedWrites;
+        r["transactions"] = servoFrame->transactions;
+    }
+    r["commandsReceived"] = motionCommands.received;
+    r["commandsApplied"] = motionCommands.applied;
+    r["commandsSuperseded"] = motionCommands.superseded;
+    r["socketFrames"] = socketFrames;
+    r["socketRejected"] = socketRejected;
+    r["socketStale"] = socketStale;
+
+    sendJson(request, r);
 }
 
+// Timing statistics of the scheduler tasks
+void WebServer::apiGetSchedulerStats(AsyncWebServerRequest *request)
+{
+    JsonDocument &r = json();
+    JsonArray tasks = r.createNestedArray("tasks");
+    if (scheduler) {
+        for (uint8_t i = 0; i < scheduler->taskCount(); i++) {
+            const SchedulerTask &task = scheduler->task(i);
+            JsonObject t = tasks.createNestedObject();
+            t["name"] = task.name;
+            t["period"] = task.period;
+            t["deadline"] = task.deadline;
+            t["runs"] = task.runs;
+            t["overruns"] = task.overruns;
+            t["skipped"] = task.skipped;
+            t["lastRuntime"] = task.lastRuntime;
+            t["maxRuntime"] = task.maxRuntime;
+            t["avgRuntime"] = task.runs > 0 ? (uint32_t)(task.totalRuntime / task.runs) : 0;
+            t["maxLateness"] = task.maxLateness;
+        }
+    }
+
+    sendJson(request, r);
+}
+
+// Duration statistics of loop() and the subsystem loops, all times in microseconds.
+// histogram[0] counts durations below 64 us, every further bucket twice the range of the one before.
+void WebServer::apiGetMetrics(AsyncWebServerRequest *request)
+{
+    JsonDocument &r = json();
+    JsonArray sections = r.createNestedArray("sections");
+    if (loopMetrics) {
+        for (uint8_t i = 0; i < METRICS_SECTIONS; i++) {
+            MetricsSummary summary = loopMetrics->summary((MetricsSection)i);
+            JsonObject s = sections.createNestedObject();
+            s["name"] = summary.name;
+            s["count"] = summary.count;
+            s["min"] = summary.min;
+            s["avg"] = summary.avg;
+            s["p99"] = summary.p99;
+            s["max"] = summary.max;
+            s["totalMs"] = summary.totalMillis;
+            s["share"] = summary.share; // Percent of the time since boot
+            JsonArray histogram = s.createNestedArray("histogram");
+            for (uint8_t bucket = 0; bucket < LoopMetrics_BUCKETS; bucket++) histogram.add(summary.histogram[bucket]);
+        }
+    }
+
+    sendJson(request, r);
+}
+
+// Export of the stored calibration and settings, in the layout of the former calibrations.json
+void WebServer::apiGetConfig(AsyncWebServerRequest *request)
+{
+    ConfigData data;
+    _config.snapshot(data);
+
+    JsonDocument &r = json();
+    r["version"] = ConfigStore_VERSION;
+    r["dirty"] = _config.dirty(); // Not yet written to flash
+    r["updates"] = _config.updates;
+    r["writes"] = _config.writes;
+    r["neck"]["rotation"] = data.neckRotation;
+    r["neck"]["tiltForward"] = data.neckTiltForward;
+    r["neck"]["tiltSideways"] = data.neckTiltSideways;
+    r["body"]["rotation"] = data.bodyRotation;
+    r["body"]["tiltForward"] = data.bodyTiltForward;
+    r["body"]["tiltSideways"] = data.bodyTiltSideways;
+    r["monocle"]["position"] = data.monoclePosition;
+    r["settings"]["robotName"] = (const char *)data.robotName; // Copied, data is gone before the response is sent
+    r["settings"]["masterMovementSpeed"] = data.masterMovementSpeed;
+    sendJson(request, r);
+}
+
+// Heap statistics, to spot fragmentation building up over a long session
+void WebServer::apiGetSystem(AsyncWebServerRequest *request)
+{
+    updateHeapStats();
+
+    JsonDocument &r = json();
+    r["freeHeap"] = freeHeap;
+    r["minFreeHeap"] = minFreeHeap;
+    r["maxFreeBlock"] = maxFreeBlock;
+    r["heapFragmentation"] = heapFragmentation;
+    r["uptime"] = millis() / 1000;
+    r["firmwareVersion"] = firmwareVersion.c_str();
+    r["statusBuilds"] = statusBuilds;
+    r["statusNotModified"] = statusNotModified;
+    r["assetsServed"] = _assets.served;
+    r["assetsNotModified"] = _assets.notModified;
+    sendJson(request, r);
+}
+
+void WebServer::updateHeapStats()
+{
+    freeHeap = ESP.getFreeHeap();
+#if defined(ESP32)
+    maxFreeBlock = ESP.getMaxAllocHeap();
+    // Same definition as the ESP8266 core: 100 - largest block in percent of the free heap
+    heapFragmentation = freeHeap > 0 ? 100 - (uint8_t)((uint64_t)maxFreeBlock * 100 / freeHeap) : 0;
+#else
+    maxFreeBlock = ESP.getMaxFreeBlockSize();
+    heapFragmentation = ESP.getHeapFragmentation();
+#endif
+    if (freeHeap < minFreeHeap) minFreeHeap = freeHeap;
+}
 
 // HTML page serving function (not currently used directly, but declared)
 String WebServer::getPage(Page page, AsyncWebServerRequest *request)
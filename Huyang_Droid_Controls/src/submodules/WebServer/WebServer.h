@@ -5,6 +5,29 @@
 #include <ArduinoJson.h>
 #include "FS.h" // For File System
 #include "LittleFS.h" // For LittleFS
+#include <atomic>
+#include "../SpscRing/SpscRing.h" // Commands are handed to the control tasks through lock-free rings
+#include "../MotionCommands/MotionCommands.h" // Servo commands for the motion task
+#include "../AssetHandler/AssetHandler.h" // Compressed, cached web interface files
+#include "../ConfigStore/ConfigStore.h" // Debounced storage of calibration and settings
+
+// WebSocket control channel for the joysticks.
+// Binary frames, little endian: uint16 sequence, uint8 first axis, uint8 axis count, then one int16
+// per axis (neck and body -100..100 like /api/action, monocle 0..180). Axis ids are MotionAxis.
+#define WebServer_SOCKET_PATH "/ws"
+#define WebServer_SOCKET_HEADER 4
+#define WebServer_SOCKET_CLIENTS 4 // Further connections close the oldest one
+
+// Capacity of the JSON document shared by the API handlers. Sized for /api/metrics with its
+// 6 sections of 8 values and a 16 bucket histogram each (about 2.5 KB), the largest document the server builds.
+#define WebServer_JSON_CAPACITY 3072
+
+// POST bodies that arrive in several chunks are assembled in a small pool of buffers
+#define WebServer_BODY_SLOTS 2        // Bodies being assembled at the same time
+#define WebServer_BODY_CAPACITY 1024  // Larger bodies are answered with 413
+
+// Capacity of the cached /api/calibration response
+#define WebServer_STATUS_CAPACITY 768
 
 // Forward declarations of classes used by WebServer
 // These are needed so WebServer.h knows about these types before their full definitions.
@@ -24,12 +47,24 @@ enum LightMode {
     LIGHT_DROID_MODE_2 = 5          // Star Wars Droid indicator lights - Mode 2
 };
 
+// Eye command, queued by the network handlers and applied by the face task
+enum FaceTarget : uint8_t {
+    FACE_ALL = 0,
+    FACE_LEFT = 1,
+    FACE_RIGHT = 2
+};
+
+struct FaceCommand {
+    FaceTarget target;
+    uint16_t state; // Same numbers as HuyangFace::getStateFrom()
+};
+
 // --- GLOBAL VARIABLES DECLARATIONS (Accessible throughout your project) ---
 // These variables hold the current state of the robot.
 // They are updated by the WebServer and read by the HuyangRobot class (or similar).
 // These declarations must match those in definitions.h exactly.
 
-extern bool automaticAnimations;
+extern std::atomic<bool> automaticAnimations; // Written by the servo task, read by the face task and the handlers
 extern uint16_t allEyes;
 extern uint16_t faceLeftEyeState;
 extern uint16_t faceRightEyeState;
@@ -58,6 +93,9 @@ extern String firmwareVersion;
 
 extern LightMode chestLightMode; // Consistent with definitions.h
 
+extern SpscRing<FaceCommand, 8> faceCommands; // Network handlers -> face task
+extern MotionCommands motionCommands;         // Network handlers -> motion task
+
 // --- WebServer Class Declaration ---
 class WebServer
 {
@@ -85,8 +123,36 @@ public:
                bool enableTorsoLights);
     void start();
 
+    // Housekeeping of the WebSocket connections, called periodically from the sketch
+    void loop();
+
+    // WebSocket statistics for tuning
+    uint32_t socketFrames = 0;   // Control frames accepted
+    uint32_t socketRejected = 0; // Frames that were malformed, fragmented or not binary
+    uint32_t socketStale = 0;    // Frames older than one already applied for the same client
+
+    // /api/calibration cache statistics
+    uint32_t statusBuilds = 0;      // Times the response was serialized
+    uint32_t statusNotModified = 0; // Polls answered with 304
+
+    // Heap statistics, updated by loop() and GET /api/system
+    uint32_t freeHeap = 0;
+    uint32_t minFreeHeap = UINT32_MAX; // Lowest free heap seen since boot
+    uint32_t maxFreeBlock = 0;         // Largest block that can be allocated
+    uint8_t heapFragmentation = 0;     // Percent
+
 private:
     AsyncWebServer *_server;
+    AsyncWebSocket *_socket;
+    AssetHandler _assets;
+    ConfigStore _config;
+
+    // Last sequence number per connected WebSocket client
+    struct SocketClient {
+        uint32_t id;     // 0 = free slot
+        uint16_t sequence;
+    };
+    SocketClient _socketClients[WebServer_SOCKET_CLIENTS];
 
     // Feature enable flags (from config.h)
     bool _enableEyes;
@@ -97,22 +163,76 @@ private:
     bool _enableBodyRotation;
     bool _enableTorsoLights;
 
+    // Buffer assembling a chunked request body
+    struct BodySlot {
+        AsyncWebServerRequest *request; // nullptr = free slot
+        size_t length;                  // Bytes received so far
+        uint8_t data[WebServer_BODY_CAPACITY];
+    };
+    BodySlot _bodySlots[WebServer_BODY_SLOTS] = {};
+
+    // Fields of the /api/calibration response, compared to find out if the cached response is stale
+    struct StatusSnapshot {
+        double neck[3];
+        int16_t body[3];
+        int16_t monoclePosition;
+        int16_t calibration[7];
+        int16_t masterMovementSpeed;
+        uint16_t leftEye;
+        uint16_t rightEye;
+        uint16_t chestLightMode;
+        bool automatic;
+        char robotName[ConfigStore_NAME_LENGTH];
+    };
+    StatusSnapshot _statusSnapshot;
+    uint32_t _statusGeneration = 0; // Increased with every rebuild, part of the ETag
+    uint32_t _bootId = 0;
+    char _status[WebServer_STATUS_CAPACITY];
+    char _statusETag[24];
+    bool refreshStatus();
+
+    // One preallocated document for all JSON parsing and responses, see json()
+    StaticJsonDocument<WebServer_JSON_CAPACITY> _json;
+
     // Helper functions for file operations
     String readFile(const char *path);
-    void writeFile(const char *path, const char *message);
+
+    // JSON helpers
+    JsonDocument &json();
+    bool parseBody(AsyncWebServerRequest *request, uint8_t *data, size_t len);
+    void sendJson(AsyncWebServerRequest *request, JsonDocument &doc);
+    void updateHeapStats();
 
     // Calibration management functions
+    void fillConfig(ConfigData &data);
     void loadCalibration();
     void saveCalibration();
     void resetCalibrationToDefaults();
 
+    // Request bodies, handed to the API handlers once complete
+    typedef void (WebServer::*BodyHandler)(AsyncWebServerRequest *request, uint8_t *data, size_t len);
+    void onBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total, BodyHandler handler);
+    BodySlot *bodySlot(AsyncWebServerRequest *request);
+    void releaseBody(AsyncWebServerRequest *request);
+
     // API action handlers
-    void apiPostAction(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total);
-    void apiCalibratePostAction(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total);
-    void apiLightsPostAction(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total);
-    void apiSettingsPostAction(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total);
-    void apiSystemPostAction(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total);
+    void apiPostAction(AsyncWebServerRequest *request, uint8_t *data, size_t len);
+    void apiCalibratePostAction(AsyncWebServerRequest *request, uint8_t *data, size_t len);
+    void apiLightsPostAction(AsyncWebServerRequest *request, uint8_t *data, size_t len);
+    void apiSettingsPostAction(AsyncWebServerRequest *request, uint8_t *data, size_t len);
+    void apiSystemPostAction(AsyncWebServerRequest *request, uint8_t *data, size_t len);
     void apiGetCalibration(AsyncWebServerRequest *request);
+    void apiGetServoStats(AsyncWebServerRequest *request);
+    void apiGetSchedulerStats(AsyncWebServerRequest *request);
+    void apiGetMetrics(AsyncWebServerRequest *request);
+    void apiGetSystem(AsyncWebServerRequest *request);
+    void apiGetConfig(AsyncWebServerRequest *request);
+
+    // WebSocket control channel
+    void onSocketEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len);
+    void handleSocketFrame(AsyncWebSocketClient *client, const uint8_t *data, size_t len);
+    SocketClient *socketClient(uint32_t id);
+    bool axisEnabled(uint8_t axis);
 
     // HTML page serving function
     String getPage(Page page, AsyncWebServerRequest *request);
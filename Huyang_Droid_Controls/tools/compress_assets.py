@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+# Prepares the web interface in data/ for upload to LittleFS.
+#
+# For every asset it writes a gzip compressed copy next to it (javascript.js -> javascript.js.gz)
+# and lists all assets with a hash of their content in data/assets.manifest. The AssetHandler
+# of the sketch serves the compressed copies, uses the hashes as ETags and answers repeated
+# requests with 304 Not Modified without reading the flash.
+#
+# In the compressed copies of the HTML pages, links to the other assets get the hash appended
+# (/javascript.js?v=1a2b...), so browsers may keep those assets cached until their content changes.
+#
+# Run it again after every change in data/, before "Upload LittleFS":
+#   python3 tools/compress_assets.py
+
+import argparse
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+MANIFEST = "assets.manifest"
+HASH_LENGTH = 16           # Hex digits of the SHA-256 used as ETag
+MAX_PATH = 47              # Must fit AssetHandler_MAX_PATH
+MAX_ASSETS = 24            # Must match AssetHandler_MAX_ASSETS
+COMPRESSED_TYPES = (".html", ".js", ".css", ".svg", ".json", ".txt", ".ico")
+
+
+def content_hash(data):
+    return hashlib.sha256(data).hexdigest()[:HASH_LENGTH]
+
+
+def find_assets(root):
+    assets = []
+    for directory, folders, files in os.walk(root):
+        folders[:] = sorted(f for f in folders if not f.startswith("."))
+        for name in sorted(files):
+            if name.startswith(".") or name.endswith(".gz") or name == MANIFEST:
+                continue
+            path = "/" + os.path.relpath(os.path.join(directory, name), root).replace(os.sep, "/")
+            assets.append(path)
+    return assets
+
+
+def version_links(html, hashes):
+    # src="/javascript.js" -> src="/javascript.js?v=<hash>", only for assets listed in the manifest
+    def replace(match):
+        path = match.group(2)
+        if path not in hashes or path.endswith(".html"):
+            return match.group(0)
+        return '%s="%s?v=%s"' % (match.group(1), path, hashes[path])
+
+    return re.sub(r'\b(src|href)="(/[^"?#]+)"', replace, html)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compresses data/ for LittleFS and writes the asset manifest")
+    default_root = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "data")
+    parser.add_argument("data", nargs="?", default=default_root, help="folder uploaded to LittleFS")
+    args = parser.parse_args()
+    root = os.path.normpath(args.data)
+
+    assets = find_assets(root)
+    if len(assets) > MAX_ASSETS:
+        sys.exit("%d assets, the sketch serves at most %d (AssetHandler_MAX_ASSETS)" % (len(assets), MAX_ASSETS))
+
+    contents = {}
+    for path in assets:
+        if len(path) > MAX_PATH:
+            sys.exit("%s is longer than %d characters (AssetHandler_MAX_PATH)" % (path, MAX_PATH))
+        with open(root + path, "rb") as f:
+            contents[path] = f.read()
+
+    # Pages last, their content depends on the hashes of the assets they link
+    hashes = {p: content_hash(contents[p]) for p in assets if not p.endswith(".html")}
+    served = dict(contents)
+    for path in assets:
+        if path.endswith(".html"):
+            served[path] = version_links(contents[path].decode("utf-8"), hashes).encode("utf-8")
+            hashes[path] = content_hash(served[path])
+
+    lines = []
+    total_plain = total_served = 0
+    for path in assets:
+        gz_path = root + path + ".gz"
+        compressed = None
+        if path.endswith(COMPRESSED_TYPES):
+            # mtime=0 keeps the output identical between runs
+            compressed = gzip.compress(served[path], compresslevel=9, mtime=0)
+            if len(compressed) >= len(contents[path]):
+                compressed = None
+        if compressed is None:
+            hashes[path] = content_hash(contents[path])  # Served as it is, without versioned links
+
+        if compressed is not None:
+            with open(gz_path, "wb") as f:
+                f.write(compressed)
+        elif os.path.exists(gz_path):
+            os.remove(gz_path)
+
+        # The size of the original lets the sketch notice a file changed without running this script
+        lines.append("%s %s %d %s\n" % (path, hashes[path], len(contents[path]), "gz" if compressed is not None else "-"))
+        total_plain += len(contents[path])
+        size = len(compressed) if compressed is not None else len(contents[path])
+        total_served += size
+        print("%-40s %7d -> %7d" % (path, len(contents[path]), size))
+
+    with open(os.path.join(root, MANIFEST), "w", newline="\n") as f:
+        f.writelines(lines)
+    print("%d assets, %d -> %d bytes, manifest written to %s" % (len(assets), total_plain, total_served, os.path.join(root, MANIFEST)))
+
+
+if __name__ == "__main__":
+    main()